@@ -6,6 +6,7 @@
 
 #include "devices/ide.h"
 #include "threads/malloc.h"
+#include "threads/thread.h"
 
 /* A block device. */
 struct block {
@@ -101,6 +102,7 @@ void block_read(struct block *block, block_sector_t sector, void *buffer) {
     check_sector(block, sector);
     block->ops->read(block->aux, sector, buffer);
     block->read_cnt++;
+    CHARGE_USAGE(sectors_read, 1);
 }
 
 /* Write sector SECTOR to BLOCK from BUFFER, which must contain
@@ -114,6 +116,7 @@ void block_write(struct block *block, block_sector_t sector,
     ASSERT(block->type != BLOCK_FOREIGN);
     block->ops->write(block->aux, sector, buffer);
     block->write_cnt++;
+    CHARGE_USAGE(sectors_written, 1);
 }
 
 /* Returns the number of sectors in BLOCK. */
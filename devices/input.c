@@ -37,6 +37,41 @@ uint8_t input_getc(void) {
     return key;
 }
 
+/* Retrieves a key from the input buffer into *KEY without
+   waiting.  Returns true if successful, false if the buffer is
+   empty. */
+bool input_trygetc(uint8_t *key) {
+    enum intr_level old_level;
+    bool got_key;
+
+    old_level = intr_disable();
+    got_key = !intq_empty(&buffer);
+    if (got_key) {
+        *key = intq_getc(&buffer);
+        serial_notify();
+    }
+    intr_set_level(old_level);
+
+    return got_key;
+}
+
+/* Returns true if a key is waiting in the input buffer, false
+   otherwise.  If P is non-null, first adds P to the buffer's
+   pollers, using entry E, so that P is woken when a key
+   arrives. */
+bool input_poll(struct poller *p, struct waitq_entry *e) {
+    enum intr_level old_level;
+    bool ready;
+
+    old_level = intr_disable();
+    if (p != NULL)
+        intq_poll(&buffer, p, e);
+    ready = !intq_empty(&buffer);
+    intr_set_level(old_level);
+
+    return ready;
+}
+
 /* Returns true if the input buffer is full,
    false otherwise.
    Interrupts must be off. */
@@ -4,9 +4,14 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+struct poller;
+struct waitq_entry;
+
 void input_init(void);
 void input_putc(uint8_t);
 uint8_t input_getc(void);
+bool input_trygetc(uint8_t *);
+bool input_poll(struct poller *, struct waitq_entry *);
 bool input_full(void);
 
 #endif /* devices/input.h */
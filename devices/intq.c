@@ -10,8 +10,9 @@ static void signal(struct intq *q, struct thread **waiter);
 
 /* Initializes interrupt queue Q. */
 void intq_init(struct intq *q) {
-    lock_init(&q->lock);
+    lock_init_named(&q->lock, "intq");
     q->not_full = q->not_empty = NULL;
+    waitq_init(&q->pollers);
     q->head = q->tail = 0;
 }
 
@@ -44,6 +45,7 @@ uint8_t intq_getc(struct intq *q) {
     byte = q->buf[q->tail];
     q->tail = next(q->tail);
     signal(q, &q->not_full);
+    waitq_wake(&q->pollers);
     return byte;
 }
 
@@ -62,6 +64,15 @@ void intq_putc(struct intq *q, uint8_t byte) {
     q->buf[q->head] = byte;
     q->head = next(q->head);
     signal(q, &q->not_empty);
+    waitq_wake(&q->pollers);
+}
+
+/* Adds poller P to the pollers of Q, using entry E, so that it is
+   woken whenever Q stops being empty or full.  The caller checks
+   for itself, with intq_empty() and intq_full(), whether Q is
+   ready already. */
+void intq_poll(struct intq *q, struct poller *p, struct waitq_entry *e) {
+    poller_add(p, &q->pollers, e);
 }
 
 /* Returns the position after POS within an intq. */
@@ -3,6 +3,7 @@
 
 #include "threads/interrupt.h"
 #include "threads/synch.h"
+#include "threads/waitq.h"
 
 /* An "interrupt queue", a circular buffer shared between
    kernel threads and external interrupt handlers.
@@ -26,6 +27,7 @@ struct intq {
     struct lock lock; /* Only one thread may wait at once. */
     struct thread *not_full; /* Thread waiting for not-full condition. */
     struct thread *not_empty; /* Thread waiting for not-empty condition. */
+    struct waitq pollers; /* Woken whenever a byte is added or removed. */
 
     /* Queue. */
     uint8_t buf[INTQ_BUFSIZE]; /* Buffer. */
@@ -38,5 +40,6 @@ bool intq_empty(const struct intq *);
 bool intq_full(const struct intq *);
 uint8_t intq_getc(struct intq *);
 void intq_putc(struct intq *, uint8_t);
+void intq_poll(struct intq *, struct poller *, struct waitq_entry *);
 
 #endif /* devices/intq.h */
@@ -7,9 +7,12 @@
 #include "devices/serial.h"
 #include "devices/timer.h"
 #include "threads/io.h"
+#include "threads/lockstat.h"
+#include "threads/schedtrace.h"
 #include "threads/thread.h"
 #ifdef USERPROG
 #include "userprog/exception.h"
+#include "userprog/pagedir.h"
 #endif
 #ifdef FILESYS
 #include "devices/block.h"
@@ -120,6 +123,8 @@ void shutdown_power_off(void) {
 static void print_stats(void) {
     timer_print_stats();
     thread_print_stats();
+    schedtrace_print_stats();
+    lockstat_print_stats();
 #ifdef FILESYS
     block_print_stats();
 #endif
@@ -127,5 +132,6 @@ static void print_stats(void) {
     kbd_print_stats();
 #ifdef USERPROG
     exception_print_stats();
+    pagedir_print_stats();
 #endif
 }
@@ -9,6 +9,7 @@
 #include "threads/interrupt.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
+#include "threads/workqueue.h"
 
 /* See [8254] for hardware details of the 8254 timer chip. */
 
@@ -19,14 +20,23 @@
 #error TIMER_FREQ <= 1000 recommended
 #endif
 
-/* Number of timer ticks since OS booted. */
+/* Number of timer ticks since OS booted, and the sequence lock
+   that lets timer_ticks() read it without disabling
+   interrupts. */
 static int64_t ticks;
+static struct seqlock ticks_seqlock;
+
+/* Alarms that have not yet gone off, soonest first.  Accessed
+   only with interrupts off. */
+static struct list alarm_list = LIST_INITIALIZER(alarm_list);
 
 /* Number of loops per timer tick.
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
 static intr_handler_func timer_interrupt;
+static bool alarm_less(const struct list_elem *, const struct list_elem *,
+                       void *aux);
 static bool too_many_loops(unsigned loops);
 static void busy_wait(int64_t loops);
 static void real_time_sleep(int64_t num, int32_t denom);
@@ -35,6 +45,7 @@ static void real_time_delay(int64_t num, int32_t denom);
 /* Sets up the timer to interrupt TIMER_FREQ times per second,
    and registers the corresponding interrupt. */
 void timer_init(void) {
+    seqlock_init(&ticks_seqlock);
     pit_configure_channel(0, 2, TIMER_FREQ);
     intr_register_ext(0x20, timer_interrupt, "8254 Timer");
 }
@@ -65,9 +76,13 @@ void timer_calibrate(void) {
 
 /* Returns the number of timer ticks since the OS booted. */
 int64_t timer_ticks(void) {
-    enum intr_level old_level = intr_disable();
-    int64_t t = ticks;
-    intr_set_level(old_level);
+    unsigned seq;
+    int64_t t;
+
+    do {
+        seq = seqlock_read_begin(&ticks_seqlock);
+        t = ticks;
+    } while (seqlock_read_retry(&ticks_seqlock, seq));
     return t;
 }
 
@@ -105,6 +120,43 @@ void timer_nsleep(int64_t ns) {
     real_time_sleep(ns, 1000 * 1000 * 1000);
 }
 
+/* Initializes ALARM to call FUNCTION with argument AUX when it
+   goes off. */
+void timer_alarm_init(struct timer_alarm *alarm, timer_alarm_func *function,
+                      void *aux) {
+    alarm->function = function;
+    alarm->aux = aux;
+    alarm->set = false;
+}
+
+/* Sets ALARM, which must not already be set, to go off once
+   TICKS timer ticks have passed, or at the next tick if TICKS is
+   not positive. */
+void timer_alarm_set(struct timer_alarm *alarm, int64_t ticks) {
+    enum intr_level old_level = intr_disable();
+
+    ASSERT(!alarm->set);
+    alarm->due = timer_ticks() + (ticks > 0 ? ticks : 1);
+    alarm->set = true;
+    list_insert_ordered(&alarm_list, &alarm->elem, alarm_less, NULL);
+    intr_set_level(old_level);
+}
+
+/* Cancels ALARM.  Returns true if it was set, false if it had
+   already gone off or was never set.  Either way, its function
+   will not be called after this returns. */
+bool timer_alarm_cancel(struct timer_alarm *alarm) {
+    enum intr_level old_level = intr_disable();
+    bool was_set = alarm->set;
+
+    if (was_set) {
+        list_remove(&alarm->elem);
+        alarm->set = false;
+    }
+    intr_set_level(old_level);
+    return was_set;
+}
+
 /* Busy-waits for approximately MS milliseconds.  Interrupts need
    not be turned on.
 
@@ -144,9 +196,32 @@ void timer_print_stats(void) {
 }
 
 /* Timer interrupt handler. */
-static void timer_interrupt(struct intr_frame *args UNUSED) {
+static void timer_interrupt(struct intr_frame *args) {
+    enum intr_level old_level = seqlock_write_begin(&ticks_seqlock);
     ticks++;
-    thread_tick();
+    seqlock_write_end(&ticks_seqlock, old_level);
+
+    while (!list_empty(&alarm_list)) {
+        struct timer_alarm *alarm =
+            list_entry(list_front(&alarm_list), struct timer_alarm, elem);
+        if (alarm->due > ticks)
+            break;
+        list_pop_front(&alarm_list);
+        alarm->set = false;
+        alarm->function(alarm->aux);
+    }
+    /* The low 2 bits of CS are the interrupted code's privilege
+       level, which is 3 for user code. */
+    thread_tick((args->cs & 3) == 3);
+    workqueue_tick(ticks);
+}
+
+/* Returns true if alarm A is due before alarm B. */
+static bool alarm_less(const struct list_elem *a_, const struct list_elem *b_,
+                       void *aux UNUSED) {
+    const struct timer_alarm *a = list_entry(a_, struct timer_alarm, elem);
+    const struct timer_alarm *b = list_entry(b_, struct timer_alarm, elem);
+    return a->due < b->due;
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -1,12 +1,30 @@
 #ifndef DEVICES_TIMER_H
 #define DEVICES_TIMER_H
 
+#include <list.h>
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* Number of timer interrupts per second. */
 #define TIMER_FREQ 100
 
+typedef void timer_alarm_func(void *aux);
+
+/* An alarm: a function that the timer interrupt handler calls
+   once a given tick arrives, for waking up a thread that sleeps
+   with a timeout.  The function runs in interrupt context, with
+   interrupts off, so it must not sleep.  An alarm is owned by
+   whoever sets it and must stay allocated until it goes off or
+   is cancelled. */
+struct timer_alarm {
+    struct list_elem elem; /* Element in the list of set alarms. */
+    int64_t due; /* Tick at which to go off. */
+    timer_alarm_func *function; /* Function to call. */
+    void *aux; /* Argument for FUNCTION. */
+    bool set; /* Set and not yet gone off or cancelled? */
+};
+
 void timer_init(void);
 void timer_calibrate(void);
 
@@ -19,6 +37,11 @@ void timer_msleep(int64_t milliseconds);
 void timer_usleep(int64_t microseconds);
 void timer_nsleep(int64_t nanoseconds);
 
+/* Alarms. */
+void timer_alarm_init(struct timer_alarm *, timer_alarm_func *, void *aux);
+void timer_alarm_set(struct timer_alarm *, int64_t ticks);
+bool timer_alarm_cancel(struct timer_alarm *);
+
 /* Busy waits. */
 void timer_mdelay(int64_t milliseconds);
 void timer_udelay(int64_t microseconds);
@@ -1,4 +1,4 @@
-/* cat.c
+/* cp.c
 
 Copies one file to another. */
 
@@ -31,14 +31,14 @@ int main(int argc, char *argv[]) {
         return EXIT_FAILURE;
     }
 
-    /* Copy data. */
+    /* Copy data, in the kernel, without passing it through our
+       memory. */
     for (;;) {
-        char buffer[1024];
-        int bytes_read = read(in_fd, buffer, sizeof buffer);
-        if (bytes_read == 0)
+        int bytes_copied = copy_file_range(in_fd, -1, out_fd, -1, 65536);
+        if (bytes_copied == 0)
             break;
-        if (write(out_fd, buffer, bytes_read) != bytes_read) {
-            printf("%s: write failed\n", argv[2]);
+        if (bytes_copied < 0) {
+            printf("%s: copy failed\n", argv[2]);
             return EXIT_FAILURE;
         }
     }
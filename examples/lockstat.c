@@ -0,0 +1,36 @@
+/* lockstat.c
+
+   Prints the kernel's lock contention statistics, most
+   waited-on lock class first.  An optional argument limits the
+   number of classes printed. */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+static struct lockstat stats[LOCKSTAT_CLASS_MAX];
+
+int main(int argc, char *argv[]) {
+    int max_cnt = argc > 1 ? atoi(argv[1]) : LOCKSTAT_CLASS_MAX;
+    int cnt, i;
+
+    if (max_cnt > LOCKSTAT_CLASS_MAX)
+        max_cnt = LOCKSTAT_CLASS_MAX;
+    cnt = lockstat(stats, max_cnt);
+    if (cnt < 0) {
+        printf("lockstat: failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%-24s %10s %10s %12s %12s %12s\n", "class", "acquired",
+           "contended", "wait cycles", "max wait", "hold cycles");
+    for (i = 0; i < cnt; i++) {
+        const struct lockstat *s = &stats[i];
+        printf("%-24s %10" PRIu64 " %10" PRIu64 " %12" PRIu64 " %12" PRIu64
+               " %12" PRIu64 "\n",
+               s->name, s->acquire_cnt, s->contended_cnt, s->wait_cycles,
+               s->max_wait_cycles, s->hold_cycles);
+    }
+    return EXIT_SUCCESS;
+}
@@ -6,9 +6,13 @@
 
    Ideally, we could read the matrices off of the file system,
    and store the result back to the file system!
+
+   An optional argument gives the number of threads to split the
+   multiplication among, by rows.
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <syscall.h>
 
 /* You should define DIM to be large enough that the arrays
@@ -32,9 +36,33 @@ int A[DIM][DIM];
 int B[DIM][DIM];
 int C[DIM][DIM];
 
-int main(void) {
+/* Most threads to use. */
+#define THREAD_MAX 16
+
+/* Number of threads multiplying. */
+static int thread_cnt = 1;
+
+/* Computes the rows of C that belong to thread number PART_. */
+static int multiply(void *part_) {
+    int part = (int) part_;
     int i, j, k;
 
+    for (i = part * DIM / thread_cnt; i < (part + 1) * DIM / thread_cnt; i++)
+        for (j = 0; j < DIM; j++)
+            for (k = 0; k < DIM; k++)
+                C[i][j] += A[i][k] * B[k][j];
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    tid_t tids[THREAD_MAX];
+    int i, j;
+
+    if (argc > 1)
+        thread_cnt = atoi(argv[1]);
+    if (thread_cnt < 1 || thread_cnt > THREAD_MAX)
+        thread_cnt = 1;
+
     /* Initialize the matrices. */
     for (i = 0; i < DIM; i++)
         for (j = 0; j < DIM; j++) {
@@ -43,11 +71,16 @@ int main(void) {
             C[i][j] = 0;
         }
 
-    /* Multiply matrices. */
-    for (i = 0; i < DIM; i++)
-        for (j = 0; j < DIM; j++)
-            for (k = 0; k < DIM; k++)
-                C[i][j] += A[i][k] * B[k][j];
+    /* Multiply matrices, in this thread and THREAD_CNT - 1
+       others. */
+    for (i = 1; i < thread_cnt; i++)
+        tids[i] = thread_create(multiply, (void *) i);
+    multiply(0);
+    for (i = 1; i < thread_cnt; i++)
+        if (tids[i] == TID_ERROR)
+            multiply((void *) i);
+        else
+            thread_join(tids[i]);
 
     /* Done. */
     exit(C[DIM - 1][DIM - 1]);
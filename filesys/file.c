@@ -10,6 +10,7 @@ struct file {
     struct inode *inode; /* File's inode. */
     off_t pos; /* Current position. */
     bool deny_write; /* Has file_deny_write() been called? */
+    int ref_cnt; /* Number of references to this file. */
 };
 
 /* Opens a file for the given INODE, of which it takes ownership,
@@ -21,6 +22,7 @@ struct file *file_open(struct inode *inode) {
         file->inode = inode;
         file->pos = 0;
         file->deny_write = false;
+        file->ref_cnt = 1;
         return file;
     } else {
         inode_close(inode);
@@ -35,9 +37,19 @@ struct file *file_reopen(struct file *file) {
     return file_open(inode_reopen(file->inode));
 }
 
+/* Returns FILE with its reference count incremented.  The
+   caller must close the returned file separately from FILE, but
+   the two share a position.  The file is not actually closed
+   until every reference to it has been. */
+struct file *file_dup(struct file *file) {
+    ASSERT(file->ref_cnt > 0);
+    file->ref_cnt++;
+    return file;
+}
+
 /* Closes FILE. */
 void file_close(struct file *file) {
-    if (file != NULL) {
+    if (file != NULL && --file->ref_cnt == 0) {
         file_allow_write(file);
         inode_close(file->inode);
         free(file);
@@ -0,0 +1,11 @@
+#ifndef __LIB_EXEC_H
+#define __LIB_EXEC_H
+
+/* Flags for the exec_flags and spawn_many system calls. */
+#define EXEC_INHERIT_FDS 0x1 /* Child gets copies of the parent's fds. */
+#define EXEC_ASYNC 0x2 /* Don't wait for the child to load. */
+
+/* Most programs spawn_many() starts at once. */
+#define SPAWN_MAX 32
+
+#endif /* lib/exec.h */
@@ -0,0 +1,11 @@
+#ifndef __LIB_FCNTL_H
+#define __LIB_FCNTL_H
+
+/* Commands for the fcntl system call. */
+#define F_GETFL 1 /* Returns the fd's O_* flags. */
+#define F_SETFL 2 /* Sets the fd's O_* flags. */
+
+/* Flags for F_GETFL and F_SETFL. */
+#define O_NONBLOCK 0x1 /* Reads and writes fail instead of waiting. */
+
+#endif /* lib/fcntl.h */
@@ -0,0 +1,16 @@
+#ifndef __LIB_IOVEC_H
+#define __LIB_IOVEC_H
+
+#include <stddef.h>
+
+/* One buffer in a vectored read or write, as passed to the readv
+   and writev system calls. */
+struct iovec {
+    void *iov_base; /* Start of buffer. */
+    size_t iov_len; /* Size of buffer in bytes. */
+};
+
+/* Most buffers that readv or writev accept in one call. */
+#define IOV_MAX 32
+
+#endif /* lib/iovec.h */
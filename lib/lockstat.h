@@ -0,0 +1,33 @@
+#ifndef __LIB_LOCKSTAT_H
+#define __LIB_LOCKSTAT_H
+
+#include <stdint.h>
+
+/* Lock contention statistics, as reported by the lockstat system
+   call.
+
+   The kernel keeps statistics per lock class, not per lock.  A
+   class is all the locks initialized under the same name, which
+   by default is the source location of the lock_init() call, so
+   that, for example, all of malloc's per-size locks share one
+   class.  Times are in CPU time-stamp counter cycles. */
+
+/* Maximum length of a lock class name, not including the null
+   terminator.  Longer names are truncated. */
+#define LOCKSTAT_NAME_MAX 31
+
+/* Maximum number of lock classes the kernel keeps statistics
+   for, and thus the most that the lockstat system call can
+   report. */
+#define LOCKSTAT_CLASS_MAX 64
+
+struct lockstat {
+    char name[LOCKSTAT_NAME_MAX + 1]; /* Class name. */
+    uint64_t acquire_cnt; /* Number of acquisitions. */
+    uint64_t contended_cnt; /* Acquisitions that had to wait. */
+    uint64_t wait_cycles; /* Total time spent waiting. */
+    uint64_t max_wait_cycles; /* Longest wait. */
+    uint64_t hold_cycles; /* Total time held. */
+};
+
+#endif /* lib/lockstat.h */
@@ -0,0 +1,22 @@
+#ifndef __LIB_POLL_H
+#define __LIB_POLL_H
+
+/* One fd to watch, as passed to the poll system call. */
+struct pollfd {
+    int fd; /* File descriptor, or negative to skip this entry. */
+    short events; /* Events to watch for, POLL* bits. */
+    short revents; /* Events that occurred, set by poll. */
+};
+
+/* Events.  POLLERR, POLLHUP, and POLLNVAL are reported in REVENTS
+   whether or not they are asked for. */
+#define POLLIN 0x001 /* Data can be read without blocking. */
+#define POLLOUT 0x004 /* Data can be written without blocking. */
+#define POLLERR 0x008 /* Writing would fail: no one can read. */
+#define POLLHUP 0x010 /* End of file: no one can write. */
+#define POLLNVAL 0x020 /* FD is not open. */
+
+/* Most fds that poll accepts in one call. */
+#define POLL_MAX 64
+
+#endif /* lib/poll.h */
@@ -0,0 +1,29 @@
+#ifndef __LIB_RUSAGE_H
+#define __LIB_RUSAGE_H
+
+#include <stdint.h>
+
+/* Number of system call numbers counted separately in
+   struct rusage.  Calls with higher numbers are not counted. */
+#define RUSAGE_SYSCALL_CNT 64
+
+/* Resources used by a process, as reported by the getrusage
+   system call. */
+struct rusage {
+    int64_t user_ticks; /* Timer ticks spent running user code. */
+    int64_t kernel_ticks; /* Timer ticks spent in the kernel. */
+    uint32_t voluntary_switches; /* Times a thread blocked. */
+    uint32_t involuntary_switches; /* Times a thread was preempted. */
+    uint32_t page_faults; /* Page faults, including copy-on-write. */
+    uint64_t bytes_read; /* Bytes returned by read calls. */
+    uint64_t bytes_written; /* Bytes accepted by write calls. */
+    uint32_t sectors_read; /* Block device sectors read. */
+    uint32_t sectors_written; /* Block device sectors written. */
+    uint32_t syscalls[RUSAGE_SYSCALL_CNT]; /* Calls, by SYS_* number. */
+};
+
+/* Whose usage getrusage reports. */
+#define RUSAGE_SELF 0 /* The calling process. */
+#define RUSAGE_CHILDREN -1 /* Its children that have exited, and theirs. */
+
+#endif /* lib/rusage.h */
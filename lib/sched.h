@@ -0,0 +1,38 @@
+#ifndef __LIB_SCHED_H
+#define __LIB_SCHED_H
+
+/* Scheduling classes, as set by the sched_setattr system call.
+
+   Real-time threads always run ahead of normal ones.  Among
+   real-time threads, SCHED_EDF threads run ahead of SCHED_FIFO
+   threads; SCHED_EDF threads run in order of their current
+   deadline, and SCHED_FIFO threads in order of priority, first
+   come first served within a priority.  Real-time threads are
+   not time-sliced.
+
+   Each real-time thread has a period and a budget, both in
+   timer ticks.  It may run for at most its budget in each
+   period; once that is used up it does not run again until its
+   next period begins.  Each period ends at the thread's
+   deadline.  The kernel refuses a request that would make the
+   total budget of all real-time threads exceed 90% of the CPU. */
+
+enum {
+    SCHED_NORMAL, /* Round-robin time-sharing. */
+    SCHED_FIFO, /* Real-time, fixed priority. */
+    SCHED_EDF /* Real-time, earliest deadline first. */
+};
+
+/* Range of SCHED_FIFO priorities. */
+#define SCHED_PRI_MIN 0
+#define SCHED_PRI_MAX 99
+
+/* Scheduling attributes. */
+struct sched_attr {
+    int policy; /* SCHED_NORMAL, SCHED_FIFO, or SCHED_EDF. */
+    int priority; /* SCHED_FIFO only: priority. */
+    int period; /* Real-time only: period, in timer ticks. */
+    int budget; /* Real-time only: ticks per period. */
+};
+
+#endif /* lib/sched.h */
@@ -26,7 +26,38 @@ enum {
     SYS_MKDIR, /* Create a directory. */
     SYS_READDIR, /* Reads a directory entry. */
     SYS_ISDIR, /* Tests if a fd represents a directory. */
-    SYS_INUMBER /* Returns the inode number for a fd. */
+    SYS_INUMBER, /* Returns the inode number for a fd. */
+
+    /* Extensions. */
+    SYS_LOCKSTAT, /* Reports kernel lock contention. */
+    SYS_SCHED_SETATTR, /* Sets the scheduling class. */
+    SYS_SCHED_WAIT_PERIOD, /* Waits for the next real-time period. */
+    SYS_DUP, /* Duplicates a file descriptor. */
+    SYS_DUP2, /* Duplicates a file descriptor onto another. */
+    SYS_PREAD, /* Reads from a file at a given position. */
+    SYS_PWRITE, /* Writes to a file at a given position. */
+    SYS_READV, /* Reads from a file into several buffers. */
+    SYS_WRITEV, /* Writes to a file from several buffers. */
+    SYS_URING_SETUP, /* Maps a shared system call ring. */
+    SYS_URING_ENTER, /* Submits calls queued in the ring. */
+    SYS_COPY_FILE_RANGE, /* Copies data from one file to another. */
+    SYS_PIPE, /* Creates a pipe. */
+    SYS_EXEC_FLAGS, /* Starts another process, with options. */
+    SYS_SHM_CREATE, /* Creates or opens shared memory. */
+    SYS_SHM_MAP, /* Maps shared memory. */
+    SYS_SHM_UNMAP, /* Unmaps shared memory. */
+    SYS_FUTEX_WAIT, /* Sleeps on a user-space int. */
+    SYS_FUTEX_WAKE, /* Wakes threads sleeping on a user-space int. */
+    SYS_THREAD_CREATE, /* Starts a thread in the current process. */
+    SYS_THREAD_JOIN, /* Waits for a thread to exit. */
+    SYS_THREAD_EXIT, /* Exits the current thread. */
+    SYS_FORK, /* Copies the current process. */
+    SYS_FCNTL, /* Gets or sets a file descriptor's flags. */
+    SYS_POLL, /* Waits for file descriptors to become ready. */
+    SYS_EXEC_STATUS, /* Waits for a child to load and reports how it went. */
+    SYS_SPAWN_MANY, /* Starts several processes at once. */
+    SYS_WAIT_ANY, /* Waits for whichever child exits first. */
+    SYS_GETRUSAGE /* Reports resources used. */
 };
 
 #endif /* lib/syscall-nr.h */
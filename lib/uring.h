@@ -0,0 +1,76 @@
+#ifndef __LIB_URING_H
+#define __LIB_URING_H
+
+#include <stdint.h>
+
+/* Shared submission and completion rings, for making many file
+   system calls with one trap into the kernel, or none.
+
+   uring_setup() maps a page holding a `struct uring' into the
+   process.  To make a call, the process fills in the next
+   submission queue entry (SQE) at sq[sq_tail % URING_SQ_ENTRIES]
+   and then increments sq_tail.  The kernel carries out entries
+   from sq_head onward and posts the result of each one as a
+   completion queue entry (CQE) at cq[cq_tail % URING_CQ_ENTRIES],
+   advancing cq_tail, and only then advances sq_head past it.  The
+   process consumes completions by advancing cq_head.  Each side
+   writes only its own indexes.
+
+   Without URING_SETUP_POLL, the kernel carries out entries only
+   during uring_enter().  With it, a kernel thread watches the
+   submission queue and carries out entries as they appear.  Once
+   it has been idle for a while it sets URING_NEED_WAKEUP in
+   flags and goes to sleep, after which the process must call
+   uring_enter() to get it going again. */
+
+/* Operations. */
+enum {
+    URING_OP_NOP, /* Does nothing. */
+    URING_OP_READ, /* Like read(), or pread() if off >= 0. */
+    URING_OP_WRITE, /* Like write(), or pwrite() if off >= 0. */
+    URING_OP_OPEN, /* Like open(), with addr the file name. */
+    URING_OP_CLOSE, /* Like close(). */
+    URING_OP_SEEK /* Like seek(), to off. */
+};
+
+/* Submission queue entry. */
+struct uring_sqe {
+    uint32_t opcode; /* URING_OP_*. */
+    int32_t fd; /* File descriptor. */
+    void *addr; /* Buffer or file name. */
+    uint32_t len; /* Buffer size. */
+    int32_t off; /* File position, or -1 for the current one. */
+    uint32_t user_data; /* Copied to the completion. */
+};
+
+/* Completion queue entry. */
+struct uring_cqe {
+    uint32_t user_data; /* From the submission. */
+    int32_t res; /* Result, as returned by the system call. */
+};
+
+/* Ring sizes.  Both must be powers of 2.  The completion queue is
+   bigger so that a full submission queue can complete without the
+   process having to reap completions part way. */
+#define URING_SQ_ENTRIES 64
+#define URING_CQ_ENTRIES 128
+
+/* The shared page. */
+struct uring {
+    volatile uint32_t sq_head; /* Next SQE for the kernel. */
+    volatile uint32_t sq_tail; /* Next free SQE. */
+    volatile uint32_t cq_head; /* Next CQE for the process. */
+    volatile uint32_t cq_tail; /* Next free CQE. */
+    volatile uint32_t flags; /* URING_NEED_WAKEUP. */
+    uint32_t setup_flags; /* uring_setup() flags in effect. */
+    struct uring_sqe sq[URING_SQ_ENTRIES];
+    struct uring_cqe cq[URING_CQ_ENTRIES];
+};
+
+/* uring_setup() flags. */
+#define URING_SETUP_POLL 0x1 /* Start a polling kernel thread. */
+
+/* struct uring flags. */
+#define URING_NEED_WAKEUP 0x1 /* Polling thread is asleep. */
+
+#endif /* lib/uring.h */
@@ -4,5 +4,6 @@ int main(int, char *[]);
 void _start(int argc, char *argv[]);
 
 void _start(int argc, char *argv[]) {
+    syscall_probe();
     exit(main(argc, argv));
 }
@@ -0,0 +1,151 @@
+#include <limits.h>
+#include <synch.h>
+#include <syscall.h>
+
+/* Atomic operations.  Each is a locked instruction, which is
+   also a full memory barrier.  See [IA32-v2a] "CMPXCHG" and
+   [IA32-v2b] "XADD" and "XCHG". */
+
+/* If *P equals OLD, sets it to NEW.  Either way returns the value
+   *P had. */
+static inline int cmpxchg(int *p, int old, int new) {
+    int prev;
+    asm volatile("lock cmpxchgl %2, %1"
+                 : "=a"(prev), "+m"(*p)
+                 : "r"(new), "0"(old)
+                 : "memory");
+    return prev;
+}
+
+/* Sets *P to NEW and returns the value it had. */
+static inline int xchg(int *p, int new) {
+    asm volatile("xchgl %0, %1" : "+r"(new), "+m"(*p) : : "memory");
+    return new;
+}
+
+/* Adds DELTA to *P and returns the value it had. */
+static inline int xadd(int *p, int delta) {
+    asm volatile("lock xaddl %0, %1" : "+r"(delta), "+m"(*p) : : "memory");
+    return delta;
+}
+
+/* Returns *P, read from memory rather than from a register. */
+static inline int load(const int *p) {
+    return *(const volatile int *) p;
+}
+
+/* Initializes M as unlocked. */
+void mutex_init(struct mutex *m) {
+    m->state = 0;
+}
+
+/* Locks M, sleeping until it is free if necessary.
+
+   This is the three-state mutex from Drepper, "Futexes Are
+   Tricky."  A thread that finds M locked marks it 2 before going
+   to sleep, so that mutex_unlock() knows to enter the kernel only
+   when somebody might be asleep. */
+void mutex_lock(struct mutex *m) {
+    int c = cmpxchg(&m->state, 0, 1);
+
+    if (c == 0)
+        return;
+    if (c != 2)
+        c = xchg(&m->state, 2);
+    while (c != 0) {
+        futex_wait(&m->state, 2);
+        c = xchg(&m->state, 2);
+    }
+}
+
+/* Locks M if it is free, without sleeping.  Returns true if
+   successful, false if M was already locked. */
+bool mutex_trylock(struct mutex *m) {
+    return cmpxchg(&m->state, 0, 1) == 0;
+}
+
+/* Unlocks M, which the caller must have locked, and wakes a
+   thread waiting for it, if there might be one. */
+void mutex_unlock(struct mutex *m) {
+    if (xchg(&m->state, 0) == 2)
+        futex_wake(&m->state, 1);
+}
+
+/* Initializes C with no waiters. */
+void cond_init(struct condvar *c) {
+    c->seq = 0;
+    c->waiters = 0;
+}
+
+/* Atomically unlocks M, which the caller must have locked, and
+   waits for C to be signaled, then locks M again before
+   returning.  As with any condition variable, the caller must
+   recheck its condition afterward, because the wakeup may be
+   spurious or another thread may have gotten there first. */
+void cond_wait(struct condvar *c, struct mutex *m) {
+    int seq = load(&c->seq);
+
+    xadd(&c->waiters, 1);
+    mutex_unlock(m);
+
+    /* Fails at once if a signal came after we read SEQ. */
+    futex_wait(&c->seq, seq);
+
+    xadd(&c->waiters, -1);
+    mutex_lock(m);
+}
+
+/* Wakes one thread waiting on C, if there is one. */
+void cond_signal(struct condvar *c) {
+    xadd(&c->seq, 1);
+    if (load(&c->waiters) > 0)
+        futex_wake(&c->seq, 1);
+}
+
+/* Wakes every thread waiting on C. */
+void cond_broadcast(struct condvar *c) {
+    xadd(&c->seq, 1);
+    if (load(&c->waiters) > 0)
+        futex_wake(&c->seq, INT_MAX);
+}
+
+/* Initializes S to VALUE. */
+void sema_init(struct semaphore *s, int value) {
+    s->value = value;
+    s->waiters = 0;
+}
+
+/* Waits for S's value to become positive and then atomically
+   decrements it. */
+void sema_down(struct semaphore *s) {
+    while (!sema_try_down(s)) {
+        /* Announce ourselves before sleeping.  sema_up()
+           increments the value before checking for waiters, so
+           either it sees us or futex_wait() sees its increment. */
+        xadd(&s->waiters, 1);
+        futex_wait(&s->value, 0);
+        xadd(&s->waiters, -1);
+    }
+}
+
+/* Decrements S's value if it is positive.  Returns true if
+   successful, false if S's value was 0. */
+bool sema_try_down(struct semaphore *s) {
+    int v = load(&s->value);
+
+    while (v > 0) {
+        int prev = cmpxchg(&s->value, v, v - 1);
+        if (prev == v)
+            return true;
+        v = prev;
+    }
+    return false;
+}
+
+/* Increments S's value and wakes a thread waiting on S, if there
+   is one. */
+void sema_up(struct semaphore *s) {
+    xadd(&s->value, 1);
+    if (load(&s->waiters) > 0)
+        futex_wake(&s->value, 1);
+}
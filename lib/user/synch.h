@@ -0,0 +1,46 @@
+#ifndef __LIB_USER_SYNCH_H
+#define __LIB_USER_SYNCH_H
+
+#include <stdbool.h>
+
+/* Synchronization primitives for user programs, built on the
+   futex system calls.  Each primitive is a few ints that may live
+   in memory shared between processes, such as a shared memory
+   segment.  Locking a free mutex, signaling a condition variable
+   that nobody waits on, and the like take a single atomic
+   instruction and never enter the kernel; only a thread that has
+   to sleep, or has to wake a sleeper, makes a system call. */
+
+/* Mutual exclusion lock. */
+struct mutex {
+    int state; /* 0=free, 1=locked, 2=locked with possible waiters. */
+};
+
+/* Condition variable. */
+struct condvar {
+    int seq; /* Bumped on every signal or broadcast. */
+    int waiters; /* Number of threads in cond_wait(). */
+};
+
+/* Counting semaphore. */
+struct semaphore {
+    int value; /* Current value. */
+    int waiters; /* Number of threads sleeping in sema_down(). */
+};
+
+void mutex_init(struct mutex *);
+void mutex_lock(struct mutex *);
+bool mutex_trylock(struct mutex *);
+void mutex_unlock(struct mutex *);
+
+void cond_init(struct condvar *);
+void cond_wait(struct condvar *, struct mutex *);
+void cond_signal(struct condvar *);
+void cond_broadcast(struct condvar *);
+
+void sema_init(struct semaphore *, int value);
+void sema_down(struct semaphore *);
+bool sema_try_down(struct semaphore *);
+void sema_up(struct semaphore *);
+
+#endif /* lib/user/synch.h */
@@ -2,15 +2,32 @@
 
 #include "../syscall-nr.h"
 
+/* Nonzero if the CPU supports SYSENTER, which the kernel then
+   accepts as a faster alternative to "int $0x30".  Set by
+   syscall_probe(). */
+static char use_sysenter;
+
+/* Traps into the kernel to make the system call whose number
+   and arguments have just been pushed on the stack.  Uses
+   SYSENTER if available, passing the stack pointer in %ecx and
+   the address to resume at in %edx, as the kernel's
+   sysenter_entry expects.  Otherwise, falls back to
+   "int $0x30".  Either way, clobbers %ecx and %edx. */
+#define SYSCALL_TRAP                                                           \
+    "cmpb $0, %[fast]; je 1f; "                                                \
+    "movl %%esp, %%ecx; movl $2f, %%edx; sysenter; "                           \
+    "1: int $0x30; "                                                           \
+    "2: "
+
 /* Invokes syscall NUMBER, passing no arguments, and returns the
    return value as an `int'. */
 #define syscall0(NUMBER)                                                       \
     ({                                                                         \
         int retval;                                                            \
-        asm volatile("pushl %[number]; int $0x30; addl $4, %%esp"              \
+        asm volatile("pushl %[number]; " SYSCALL_TRAP "addl $4, %%esp"         \
                      : "=a"(retval)                                            \
-                     : [number] "i"(NUMBER)                                    \
-                     : "memory");                                              \
+                     : [number] "i"(NUMBER), [fast] "m"(use_sysenter)          \
+                     : "ecx", "edx", "memory");                                \
         retval;                                                                \
     })
 
@@ -19,11 +36,12 @@
 #define syscall1(NUMBER, ARG0)                                                 \
     ({                                                                         \
         int retval;                                                            \
-        asm volatile(                                                          \
-            "pushl %[arg0]; pushl %[number]; int $0x30; addl $8, %%esp"        \
-            : "=a"(retval)                                                     \
-            : [number] "i"(NUMBER), [arg0] "g"(ARG0)                           \
-            : "memory");                                                       \
+        asm volatile("pushl %[arg0]; pushl %[number]; " SYSCALL_TRAP           \
+                     "addl $8, %%esp"                                          \
+                     : "=a"(retval)                                            \
+                     : [number] "i"(NUMBER), [arg0] "g"(ARG0),                 \
+                       [fast] "m"(use_sysenter)                                \
+                     : "ecx", "edx", "memory");                                \
         retval;                                                                \
     })
 
@@ -32,12 +50,12 @@
 #define syscall2(NUMBER, ARG0, ARG1)                                           \
     ({                                                                         \
         int retval;                                                            \
-        asm volatile(                                                          \
-            "pushl %[arg1]; pushl %[arg0]; "                                   \
-            "pushl %[number]; int $0x30; addl $12, %%esp"                      \
-            : "=a"(retval)                                                     \
-            : [number] "i"(NUMBER), [arg0] "r"(ARG0), [arg1] "r"(ARG1)         \
-            : "memory");                                                       \
+        asm volatile("pushl %[arg1]; pushl %[arg0]; "                          \
+                     "pushl %[number]; " SYSCALL_TRAP "addl $12, %%esp"        \
+                     : "=a"(retval)                                            \
+                     : [number] "i"(NUMBER), [arg0] "r"(ARG0),                 \
+                       [arg1] "r"(ARG1), [fast] "m"(use_sysenter)              \
+                     : "ecx", "edx", "memory");                                \
         retval;                                                                \
     })
 
@@ -47,14 +65,65 @@
     ({                                                                         \
         int retval;                                                            \
         asm volatile("pushl %[arg2]; pushl %[arg1]; pushl %[arg0]; "           \
-                     "pushl %[number]; int $0x30; addl $16, %%esp"             \
+                     "pushl %[number]; " SYSCALL_TRAP "addl $16, %%esp"        \
+                     : "=a"(retval)                                            \
+                     : [number] "i"(NUMBER), [arg0] "r"(ARG0),                 \
+                       [arg1] "r"(ARG1), [arg2] "r"(ARG2),                     \
+                       [fast] "m"(use_sysenter)                                \
+                     : "ecx", "edx", "memory");                                \
+        retval;                                                                \
+    })
+
+/* Invokes syscall NUMBER, passing arguments ARG0, ARG1, ARG2,
+   and ARG3, and returns the return value as an `int'.  ARG3 may
+   be in memory, because it is pushed before the stack pointer
+   moves, which leaves enough registers for the rest. */
+#define syscall4(NUMBER, ARG0, ARG1, ARG2, ARG3)                               \
+    ({                                                                         \
+        int retval;                                                            \
+        asm volatile("pushl %[arg3]; pushl %[arg2]; pushl %[arg1]; "           \
+                     "pushl %[arg0]; pushl %[number]; " SYSCALL_TRAP           \
+                     "addl $20, %%esp"                                         \
                      : "=a"(retval)                                            \
                      : [number] "i"(NUMBER), [arg0] "r"(ARG0),                 \
-                       [arg1] "r"(ARG1), [arg2] "r"(ARG2)                      \
-                     : "memory");                                              \
+                       [arg1] "r"(ARG1), [arg2] "r"(ARG2), [arg3] "g"(ARG3),   \
+                       [fast] "m"(use_sysenter)                                \
+                     : "ecx", "edx", "memory");                                \
         retval;                                                                \
     })
 
+/* Invokes syscall NUMBER, passing arguments ARG0 through ARG4,
+   and returns the return value as an `int'.  ARG4 may be in
+   memory, as ARG3 may in syscall4(). */
+#define syscall5(NUMBER, ARG0, ARG1, ARG2, ARG3, ARG4)                         \
+    ({                                                                         \
+        int retval;                                                            \
+        asm volatile("pushl %[arg4]; pushl %[arg3]; pushl %[arg2]; "           \
+                     "pushl %[arg1]; pushl %[arg0]; pushl %[number]; "         \
+                     SYSCALL_TRAP "addl $24, %%esp"                            \
+                     : "=a"(retval)                                            \
+                     : [number] "i"(NUMBER), [arg0] "r"(ARG0),                 \
+                       [arg1] "r"(ARG1), [arg2] "r"(ARG2), [arg3] "r"(ARG3),   \
+                       [arg4] "g"(ARG4), [fast] "m"(use_sysenter)              \
+                     : "ecx", "edx", "memory");                                \
+        retval;                                                                \
+    })
+
+/* Decides whether system calls should use SYSENTER.  Early
+   Pentium Pro processors report the feature without supporting
+   it, so the kernel and we both skip them.  Called once, at
+   startup, by _start(). */
+void syscall_probe(void) {
+    unsigned eax, ebx, ecx, edx;
+
+    asm volatile("cpuid"
+                 : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
+                 : "a"(1), "c"(0));
+    use_sysenter = (edx & (1u << 11)) != 0 &&
+                   !(((eax >> 8) & 0xf) == 6 && ((eax >> 4) & 0xf) < 3 &&
+                     (eax & 0xf) < 3);
+}
+
 int increment(int i) {
     return syscall1(SYS_INCREMENT, i);
 }
@@ -140,3 +209,131 @@ bool isdir(int fd) {
 int inumber(int fd) {
     return syscall1(SYS_INUMBER, fd);
 }
+
+int lockstat(struct lockstat *stats, int max_cnt) {
+    return syscall2(SYS_LOCKSTAT, stats, max_cnt);
+}
+
+bool sched_setattr(const struct sched_attr *attr) {
+    return syscall1(SYS_SCHED_SETATTR, attr);
+}
+
+void sched_wait_period(void) {
+    syscall0(SYS_SCHED_WAIT_PERIOD);
+}
+
+int dup(int fd) {
+    return syscall1(SYS_DUP, fd);
+}
+
+int dup2(int old_fd, int new_fd) {
+    return syscall2(SYS_DUP2, old_fd, new_fd);
+}
+
+int pread(int fd, void *buffer, unsigned size, unsigned position) {
+    return syscall4(SYS_PREAD, fd, buffer, size, position);
+}
+
+int pwrite(int fd, const void *buffer, unsigned size, unsigned position) {
+    return syscall4(SYS_PWRITE, fd, buffer, size, position);
+}
+
+int readv(int fd, const struct iovec *iov, int iov_cnt) {
+    return syscall3(SYS_READV, fd, iov, iov_cnt);
+}
+
+int writev(int fd, const struct iovec *iov, int iov_cnt) {
+    return syscall3(SYS_WRITEV, fd, iov, iov_cnt);
+}
+
+int copy_file_range(int in_fd, int in_pos, int out_fd, int out_pos,
+                    unsigned size) {
+    return syscall5(SYS_COPY_FILE_RANGE, in_fd, in_pos, out_fd, out_pos, size);
+}
+
+bool pipe(int fds[2]) {
+    return syscall1(SYS_PIPE, fds);
+}
+
+pid_t exec_flags(const char *file, int flags) {
+    return (pid_t) syscall2(SYS_EXEC_FLAGS, file, flags);
+}
+
+int shm_create(const char *name, unsigned page_cnt) {
+    return syscall2(SYS_SHM_CREATE, name, page_cnt);
+}
+
+void *shm_map(int fd, void *addr) {
+    return (void *) syscall2(SYS_SHM_MAP, fd, addr);
+}
+
+bool shm_unmap(void *addr) {
+    return syscall1(SYS_SHM_UNMAP, addr);
+}
+
+int futex_wait(int *addr, int expected) {
+    return syscall2(SYS_FUTEX_WAIT, addr, expected);
+}
+
+int futex_wake(int *addr, int n) {
+    return syscall2(SYS_FUTEX_WAKE, addr, n);
+}
+
+/* Where a thread started by thread_create() begins: runs FUNC
+   with AUX and exits with what it returns. */
+static void NO_RETURN thread_start(thread_func *func, void *aux) {
+    thread_exit(func(aux));
+}
+
+tid_t thread_create(thread_func *func, void *aux) {
+    return (tid_t) syscall3(SYS_THREAD_CREATE, thread_start, func, aux);
+}
+
+int thread_join(tid_t tid) {
+    return syscall1(SYS_THREAD_JOIN, tid);
+}
+
+void thread_exit(int value) {
+    syscall1(SYS_THREAD_EXIT, value);
+    NOT_REACHED();
+}
+
+pid_t fork(void) {
+    return (pid_t) syscall0(SYS_FORK);
+}
+
+int fcntl(int fd, int cmd, int arg) {
+    return syscall3(SYS_FCNTL, fd, cmd, arg);
+}
+
+int poll(struct pollfd *fds, unsigned nfds, int timeout) {
+    return syscall3(SYS_POLL, fds, nfds, timeout);
+}
+
+int exec_status(pid_t pid) {
+    return syscall1(SYS_EXEC_STATUS, pid);
+}
+
+int spawn_many(const char *cmd_lines[], int cnt, int flags, pid_t pids[]) {
+    return syscall4(SYS_SPAWN_MANY, cmd_lines, cnt, flags, pids);
+}
+
+pid_t wait_any(int *status) {
+    return (pid_t) syscall2(SYS_WAIT_ANY, status, -1);
+}
+
+pid_t wait_any_timeout(int *status, int timeout) {
+    return (pid_t) syscall2(SYS_WAIT_ANY, status, timeout);
+}
+
+bool getrusage(int who, struct rusage *usage) {
+    return syscall2(SYS_GETRUSAGE, who, usage);
+}
+
+struct uring *uring_setup(unsigned flags) {
+    return (struct uring *) syscall1(SYS_URING_SETUP, flags);
+}
+
+int uring_enter(unsigned to_submit, unsigned min_complete) {
+    return syscall2(SYS_URING_ENTER, to_submit, min_complete);
+}
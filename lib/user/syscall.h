@@ -2,12 +2,28 @@
 #define __LIB_USER_SYSCALL_H
 
 #include <debug.h>
+#include <exec.h>
+#include <fcntl.h>
+#include <iovec.h>
+#include <lockstat.h>
+#include <poll.h>
+#include <rusage.h>
+#include <sched.h>
 #include <stdbool.h>
+#include <uring.h>
 
 /* Process identifier. */
 typedef int pid_t;
 #define PID_ERROR ((pid_t) - 1)
 
+/* Thread identifier. */
+typedef int tid_t;
+#define TID_ERROR ((tid_t) - 1)
+
+/* A function run by a thread started with thread_create().  Its
+   return value goes to thread_join(). */
+typedef int thread_func(void *aux);
+
 /* Map region identifier. */
 typedef int mapid_t;
 #define MAP_FAILED ((mapid_t) - 1)
@@ -46,4 +62,46 @@ bool readdir(int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir(int fd);
 int inumber(int fd);
 
+/* Extensions. */
+int lockstat(struct lockstat *, int max_cnt);
+bool sched_setattr(const struct sched_attr *);
+void sched_wait_period(void);
+int dup(int fd);
+int dup2(int old_fd, int new_fd);
+int pread(int fd, void *buffer, unsigned length, unsigned position);
+int pwrite(int fd, const void *buffer, unsigned length, unsigned position);
+int readv(int fd, const struct iovec *, int iov_cnt);
+int writev(int fd, const struct iovec *, int iov_cnt);
+int copy_file_range(int in_fd, int in_pos, int out_fd, int out_pos,
+                    unsigned length);
+bool pipe(int fds[2]);
+pid_t exec_flags(const char *file, int flags);
+int shm_create(const char *name, unsigned page_cnt);
+void *shm_map(int fd, void *addr);
+bool shm_unmap(void *addr);
+int futex_wait(int *addr, int expected);
+int futex_wake(int *addr, int n);
+tid_t thread_create(thread_func *, void *aux);
+int thread_join(tid_t);
+void thread_exit(int value) NO_RETURN;
+pid_t fork(void);
+int fcntl(int fd, int cmd, int arg);
+int poll(struct pollfd *, unsigned nfds, int timeout);
+int exec_status(pid_t);
+int spawn_many(const char *cmd_lines[], int cnt, int flags, pid_t pids[]);
+pid_t wait_any(int *status);
+pid_t wait_any_timeout(int *status, int timeout);
+bool getrusage(int who, struct rusage *);
+struct uring *uring_setup(unsigned flags);
+int uring_enter(unsigned to_submit, unsigned min_complete);
+
+/* Shared system call ring helpers, in uring.c. */
+bool uring_prep(struct uring *, unsigned opcode, int fd, void *addr,
+                unsigned len, int off, unsigned user_data);
+int uring_submit(struct uring *, unsigned min_complete);
+bool uring_reap(struct uring *, struct uring_cqe *);
+
+/* Called by _start() before main(). */
+void syscall_probe(void);
+
 #endif /* lib/user/syscall.h */
@@ -0,0 +1,62 @@
+#include <syscall.h>
+#include <uring.h>
+
+/* Compiler memory barrier.  See the kernel's userprog/uring.c. */
+#define barrier() asm volatile("" : : : "memory")
+
+/* Queues an operation on RING, with the given OPCODE, FD, ADDR,
+   LEN, and OFF, as described in <uring.h>.  Its completion will
+   carry USER_DATA.  Returns true if successful, false if the
+   submission queue is full.  The operation is not carried out
+   until it is submitted with uring_submit(), unless RING has a
+   polling thread that happens to be awake. */
+bool uring_prep(struct uring *ring, unsigned opcode, int fd, void *addr,
+                unsigned len, int off, unsigned user_data) {
+    uint32_t tail = ring->sq_tail;
+    struct uring_sqe *sqe;
+
+    if (tail - ring->sq_head >= URING_SQ_ENTRIES)
+        return false;
+
+    sqe = &ring->sq[tail % URING_SQ_ENTRIES];
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = addr;
+    sqe->len = len;
+    sqe->off = off;
+    sqe->user_data = user_data;
+    barrier();
+    ring->sq_tail = tail + 1;
+    return true;
+}
+
+/* Submits all of the operations queued on RING, then waits until
+   at least MIN_COMPLETE completions are ready to reap.  Enters
+   the kernel only when there is something for it to do: always
+   without a polling thread, but with one only to wake it up or
+   to wait.  Returns the number of operations submitted. */
+int uring_submit(struct uring *ring, unsigned min_complete) {
+    unsigned pending = ring->sq_tail - ring->sq_head;
+
+    if (!(ring->setup_flags & URING_SETUP_POLL))
+        return uring_enter(pending, min_complete);
+
+    if ((ring->flags & URING_NEED_WAKEUP) || min_complete > 0)
+        uring_enter(0, min_complete);
+    return pending;
+}
+
+/* Removes the oldest completion from RING and stores it in
+   *CQE.  Returns true if successful, false if there are no
+   completions. */
+bool uring_reap(struct uring *ring, struct uring_cqe *cqe) {
+    uint32_t head = ring->cq_head;
+
+    if (head == ring->cq_tail)
+        return false;
+    barrier();
+    *cqe = ring->cq[head % URING_CQ_ENTRIES];
+    barrier();
+    ring->cq_head = head + 1;
+    return true;
+}
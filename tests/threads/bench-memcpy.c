@@ -0,0 +1,61 @@
+/* Measures how quickly the kernel can touch and copy memory
+   through its direct map of physical memory.  The stride pass
+   reads one byte per page, so it is dominated by TLB misses;
+   the copy pass is closer to a real workload.
+
+   Run it once normally and once with the -nopse kernel option
+   to compare 4 MB against 4 kB kernel mappings. */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+/* Pages in each of the source and destination buffers. */
+#define BUF_PAGES 1024
+
+/* Number of passes over the buffers. */
+#define STRIDE_PASSES 64
+#define COPY_PASSES 2
+
+void test_bench_memcpy(void) {
+    uint8_t *src, *dst;
+    uint64_t start, cycles;
+    unsigned sum = 0;
+    int pass, page;
+
+    if (!cpu_has_features(CPUID_TSC)) {
+        msg("CPU has no time-stamp counter, skipping.");
+        return;
+    }
+
+    src = palloc_get_multiple(PAL_ZERO, BUF_PAGES);
+    dst = palloc_get_multiple(0, BUF_PAGES);
+    if (src == NULL || dst == NULL)
+        fail("couldn't allocate %d-page buffers (try --mem=32)", BUF_PAGES);
+
+    start = rdtsc();
+    for (pass = 0; pass < STRIDE_PASSES; pass++)
+        for (page = 0; page < BUF_PAGES; page++)
+            sum += ((volatile uint8_t *) src)[page * PGSIZE];
+    cycles = rdtsc() - start;
+    msg("stride: %" PRIu64 " cycles per access",
+        cycles / (STRIDE_PASSES * BUF_PAGES));
+
+    start = rdtsc();
+    for (pass = 0; pass < COPY_PASSES; pass++)
+        memcpy(dst, src, BUF_PAGES * PGSIZE);
+    cycles = rdtsc() - start;
+    msg("copy: %" PRIu64 " cycles per kB",
+        cycles / (COPY_PASSES * BUF_PAGES * PGSIZE / 1024));
+
+    if (sum != 0 || dst[BUF_PAGES * PGSIZE - 1] != 0)
+        fail("zeroed buffer read back nonzero");
+
+    palloc_free_multiple(src, BUF_PAGES);
+    palloc_free_multiple(dst, BUF_PAGES);
+}
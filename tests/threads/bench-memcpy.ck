@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# Timings vary from run to run, so only check that both were
+# reported.
+fail "missing stride timing\n"
+  if !grep (/^\(bench-memcpy\) stride: \d+ cycles per access$/, @output);
+fail "missing copy timing\n"
+  if !grep (/^\(bench-memcpy\) copy: \d+ cycles per kB$/, @output);
+pass;
@@ -0,0 +1,170 @@
+/* Compares a plain lock, a readers-writer lock, and a sequence
+   lock protecting the same read-mostly table.  Several threads
+   each read the table many times and write it occasionally.
+
+   In the "short" runs, readers only sum the table, so threads
+   contend only when preempted inside a critical section.  In the
+   "yielding" runs, readers yield the CPU while holding the lock,
+   standing in for a reader that sleeps on I/O; this is where a
+   readers-writer lock should help most.  A sequence lock reader
+   cannot sleep, so it is only measured in the short run. */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Number of threads and operations per thread. */
+#define THREAD_CNT 8
+#define OP_CNT 2000
+
+/* Every WRITE_EVERY'th operation is a write. */
+#define WRITE_EVERY 16
+
+/* Number of values in the table. */
+#define VALUE_CNT 32
+
+/* Kind of synchronization to use. */
+enum kind { USE_LOCK, USE_RWLOCK, USE_SEQLOCK };
+
+/* Shared state for one run. */
+struct bench {
+    enum kind kind; /* Synchronization in use. */
+    bool yield; /* Yield while holding the lock for reading? */
+    struct lock lock;
+    struct rwlock rwlock;
+    struct seqlock seqlock;
+    int values[VALUE_CNT]; /* Table, all elements equal. */
+    struct semaphore done; /* Upped by each thread when done. */
+};
+
+static struct bench bench;
+
+static thread_func bench_thread;
+static void run(enum kind, bool yield, const char *name);
+
+void test_bench_rwlock(void) {
+    if (!cpu_has_features(CPUID_TSC)) {
+        msg("CPU has no time-stamp counter, skipping.");
+        return;
+    }
+
+    run(USE_LOCK, false, "lock, short reads");
+    run(USE_RWLOCK, false, "rwlock, short reads");
+    run(USE_SEQLOCK, false, "seqlock, short reads");
+    run(USE_LOCK, true, "lock, yielding reads");
+    run(USE_RWLOCK, true, "rwlock, yielding reads");
+}
+
+/* Runs THREAD_CNT threads against a table protected as
+   specified by KIND and YIELD, and reports the average time per
+   operation under NAME. */
+static void run(enum kind kind, bool yield, const char *name) {
+    uint64_t start;
+    int i;
+
+    bench.kind = kind;
+    bench.yield = yield;
+    lock_init(&bench.lock);
+    rwlock_init(&bench.rwlock);
+    seqlock_init(&bench.seqlock);
+    for (i = 0; i < VALUE_CNT; i++)
+        bench.values[i] = 0;
+    sema_init(&bench.done, 0);
+
+    start = rdtsc();
+    for (i = 0; i < THREAD_CNT; i++) {
+        char thread_name[16];
+        snprintf(thread_name, sizeof thread_name, "bench %d", i);
+        thread_create(thread_name, PRI_DEFAULT, bench_thread, NULL);
+    }
+    for (i = 0; i < THREAD_CNT; i++)
+        sema_down(&bench.done);
+    msg("%s: %" PRIu64 " cycles per operation", name,
+        (rdtsc() - start) / (THREAD_CNT * OP_CNT));
+
+    if (bench.values[0] != THREAD_CNT * (OP_CNT / WRITE_EVERY))
+        fail("%s: table has %d writes, expected %d", name, bench.values[0],
+             THREAD_CNT * (OP_CNT / WRITE_EVERY));
+}
+
+/* Returns the sum of the table.  If the read was consistent,
+   the sum is a multiple of VALUE_CNT. */
+static int sum_values(void) {
+    int sum = 0;
+    int i;
+
+    for (i = 0; i < VALUE_CNT; i++)
+        sum += bench.values[i];
+    return sum;
+}
+
+/* Adds 1 to every value in the table. */
+static void update_values(void) {
+    int i;
+
+    for (i = 0; i < VALUE_CNT; i++)
+        bench.values[i]++;
+}
+
+static void bench_thread(void *aux UNUSED) {
+    int op;
+
+    for (op = 0; op < OP_CNT; op++) {
+        bool write = op % WRITE_EVERY == 0;
+        enum intr_level old_level;
+        unsigned seq;
+        int sum;
+
+        switch (bench.kind) {
+        case USE_LOCK:
+            lock_acquire(&bench.lock);
+            if (write)
+                update_values();
+            else {
+                sum = sum_values();
+                if (bench.yield)
+                    thread_yield();
+                if (sum % VALUE_CNT != 0)
+                    fail("inconsistent read under lock");
+            }
+            lock_release(&bench.lock);
+            break;
+
+        case USE_RWLOCK:
+            if (write) {
+                rwlock_acquire_write(&bench.rwlock);
+                update_values();
+                rwlock_release_write(&bench.rwlock);
+            } else {
+                rwlock_acquire_read(&bench.rwlock);
+                sum = sum_values();
+                if (bench.yield)
+                    thread_yield();
+                if (sum % VALUE_CNT != 0)
+                    fail("inconsistent read under rwlock");
+                rwlock_release_read(&bench.rwlock);
+            }
+            break;
+
+        case USE_SEQLOCK:
+            if (write) {
+                old_level = seqlock_write_begin(&bench.seqlock);
+                update_values();
+                seqlock_write_end(&bench.seqlock, old_level);
+            } else {
+                do {
+                    seq = seqlock_read_begin(&bench.seqlock);
+                    sum = sum_values();
+                } while (seqlock_read_retry(&bench.seqlock, seq));
+                if (sum % VALUE_CNT != 0)
+                    fail("inconsistent read under seqlock");
+            }
+            break;
+        }
+    }
+    sema_up(&bench.done);
+}
@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# Timings vary from run to run, so only check that each
+# configuration was reported.
+foreach my $run ("lock, short reads", "rwlock, short reads",
+                 "seqlock, short reads", "lock, yielding reads",
+                 "rwlock, yielding reads") {
+    fail "missing timing for $run\n"
+      if !grep (/^\(bench-rwlock\) \Q$run\E: \d+ cycles per operation$/,
+                @output);
+}
+pass;
@@ -0,0 +1,50 @@
+/* Checks admission control for real-time threads: the total
+   budget of all real-time threads may not exceed 90% of the
+   CPU, and leaving the real-time class gives back a thread's
+   share. */
+
+#include <stdio.h>
+
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func rt_thread;
+static struct semaphore done;
+
+/* Sets the current thread's class and reports the result. */
+static void set_sched(const char *who, int policy, int budget, int period) {
+    struct sched_attr attr = {policy, SCHED_PRI_MIN, period, budget};
+    bool ok = thread_set_sched(&attr);
+
+    if (policy == SCHED_NORMAL)
+        msg("%s: normal: %s", who, ok ? "admitted" : "refused");
+    else
+        msg("%s: %s %d/%d: %s", who, policy == SCHED_EDF ? "edf" : "fifo",
+            budget, period, ok ? "admitted" : "refused");
+}
+
+void test_rt_admit(void) {
+    sema_init(&done, 0);
+
+    set_sched("main", SCHED_EDF, 0, 10);
+    set_sched("main", SCHED_EDF, 11, 10);
+    set_sched("main", SCHED_EDF, 5, 10);
+
+    thread_create("rt", PRI_DEFAULT, rt_thread, NULL);
+    sema_down(&done);
+
+    set_sched("main", SCHED_FIFO, 6, 10);
+    set_sched("main", SCHED_NORMAL, 0, 0);
+
+    thread_create("rt", PRI_DEFAULT, rt_thread, NULL);
+    sema_down(&done);
+}
+
+static void rt_thread(void *aux UNUSED) {
+    set_sched("rt", SCHED_FIFO, 5, 10);
+    set_sched("rt", SCHED_FIFO, 4, 10);
+    set_sched("rt", SCHED_NORMAL, 0, 0);
+    sema_up(&done);
+}
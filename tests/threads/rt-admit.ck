@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rt-admit) begin
+(rt-admit) main: edf 0/10: refused
+(rt-admit) main: edf 11/10: refused
+(rt-admit) main: edf 5/10: admitted
+(rt-admit) rt: fifo 5/10: refused
+(rt-admit) rt: fifo 4/10: admitted
+(rt-admit) rt: normal: admitted
+(rt-admit) main: fifo 6/10: admitted
+(rt-admit) main: normal: admitted
+(rt-admit) rt: fifo 5/10: admitted
+(rt-admit) rt: fifo 4/10: admitted
+(rt-admit) rt: normal: admitted
+(rt-admit) end
+EOF
+pass;
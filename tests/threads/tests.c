@@ -37,6 +37,10 @@ static const struct test tests[] = {
     {"mlfqs-nice-2", test_mlfqs_nice_2},
     {"mlfqs-nice-10", test_mlfqs_nice_10},
     {"mlfqs-block", test_mlfqs_block},
+    {"bench-memcpy", test_bench_memcpy},
+    {"workqueue", test_workqueue},
+    {"bench-rwlock", test_bench_rwlock},
+    {"rt-admit", test_rt_admit},
 };
 
 static const char *test_name;
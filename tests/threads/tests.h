@@ -32,6 +32,10 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_bench_memcpy;
+extern test_func test_workqueue;
+extern test_func test_bench_rwlock;
+extern test_func test_rt_admit;
 
 void msg(const char *, ...);
 void fail(const char *, ...);
@@ -0,0 +1,71 @@
+/* Queues immediate and delayed work items and checks that each
+   one runs exactly once, that delayed items do not run early,
+   and that an item cannot be queued twice while pending. */
+
+#include <stdio.h>
+
+#include "devices/timer.h"
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+
+#define ITEM_CNT 8
+#define DELAY 10
+
+struct item {
+    struct work work;
+    int run_cnt; /* Number of times the work function ran. */
+    int64_t ran_at; /* Tick at which it last ran. */
+};
+
+static struct item items[ITEM_CNT];
+static struct semaphore done;
+
+static work_func item_func;
+
+void test_workqueue(void) {
+    struct item delayed;
+    int64_t start;
+    int i;
+
+    sema_init(&done, 0);
+
+    msg("Queueing %d work items.", ITEM_CNT);
+    for (i = 0; i < ITEM_CNT; i++) {
+        work_init(&items[i].work, item_func, &items[i]);
+        if (!work_schedule(&items[i].work))
+            fail("item %d was reported as already pending", i);
+    }
+    for (i = 0; i < ITEM_CNT; i++)
+        sema_down(&done);
+    for (i = 0; i < ITEM_CNT; i++)
+        if (items[i].run_cnt != 1)
+            fail("item %d ran %d times", i, items[i].run_cnt);
+    msg("All %d work items ran once.", ITEM_CNT);
+
+    msg("Queueing delayed work item.");
+    work_init(&delayed.work, item_func, &delayed);
+    delayed.run_cnt = 0;
+    start = timer_ticks();
+    if (!work_schedule_delayed(&delayed.work, DELAY))
+        fail("delayed item was reported as already pending");
+    if (work_schedule_delayed(&delayed.work, DELAY))
+        fail("delayed item was queued twice");
+    sema_down(&done);
+    if (delayed.run_cnt != 1)
+        fail("delayed item ran %d times", delayed.run_cnt);
+    if (delayed.ran_at - start < DELAY)
+        fail("delayed item ran after %lld ticks, expected at least %d",
+             delayed.ran_at - start, DELAY);
+    msg("Delayed work item ran once, not early.");
+}
+
+static void item_func(void *item_) {
+    struct item *item = item_;
+
+    item->run_cnt++;
+    item->ran_at = timer_ticks();
+    sema_up(&done);
+}
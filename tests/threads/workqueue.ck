@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(workqueue) begin
+(workqueue) Queueing 8 work items.
+(workqueue) All 8 work items ran once.
+(workqueue) Queueing delayed work item.
+(workqueue) Delayed work item ran once, not early.
+(workqueue) end
+EOF
+pass;
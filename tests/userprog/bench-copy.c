@@ -0,0 +1,74 @@
+/* Measures copying a large file through a user buffer against
+   copying it in the kernel with copy_file_range(), and checks
+   that the in-kernel copy is right. */
+
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Size of the file copied. */
+#define FILE_SIZE (128 * 1024)
+
+/* Size of the buffer a user-space copy goes through. */
+#define BUF_SIZE 4096
+
+static char buf[BUF_SIZE], buf2[BUF_SIZE];
+
+/* Creates and opens a FILE_SIZE-byte file named NAME. */
+static int make_file(const char *name) {
+    int fd;
+
+    CHECK(create(name, FILE_SIZE), "create \"%s\"", name);
+    CHECK((fd = open(name)) > 1, "open \"%s\"", name);
+    return fd;
+}
+
+void test_main(void) {
+    uint64_t start, cycles;
+    int src, dst1, dst2, ofs, i;
+
+    src = make_file("src");
+    dst1 = make_file("dst1");
+    dst2 = make_file("dst2");
+    for (ofs = 0; ofs < FILE_SIZE; ofs += BUF_SIZE) {
+        for (i = 0; i < BUF_SIZE; i++)
+            buf[i] = ofs / BUF_SIZE + i;
+        if (write(src, buf, BUF_SIZE) != BUF_SIZE)
+            fail("write \"src\" failed");
+    }
+
+    start = rdtsc();
+    for (ofs = 0; ofs < FILE_SIZE; ofs += BUF_SIZE)
+        if (pread(src, buf, BUF_SIZE, ofs) != BUF_SIZE ||
+            pwrite(dst1, buf, BUF_SIZE, ofs) != BUF_SIZE)
+            fail("copy through user memory failed");
+    cycles = rdtsc() - start;
+    msg("read/write: %d cycles per kB", (int) (cycles / (FILE_SIZE / 1024)));
+
+    start = rdtsc();
+    if (copy_file_range(src, 0, dst2, 0, FILE_SIZE) != FILE_SIZE)
+        fail("copy_file_range failed");
+    cycles = rdtsc() - start;
+    msg("copy_file_range: %d cycles per kB",
+        (int) (cycles / (FILE_SIZE / 1024)));
+
+    for (ofs = 0; ofs < FILE_SIZE; ofs += BUF_SIZE)
+        if (pread(src, buf, BUF_SIZE, ofs) != BUF_SIZE ||
+            pread(dst2, buf2, BUF_SIZE, ofs) != BUF_SIZE ||
+            memcmp(buf, buf2, BUF_SIZE))
+            fail("copy differs at offset %d", ofs);
+    msg("copy matches");
+
+    CHECK(tell(src) == FILE_SIZE && tell(dst2) == 0,
+          "positions unchanged by explicit offsets");
+    seek(src, 100);
+    CHECK(copy_file_range(src, -1, dst2, -1, 1000) == 1000,
+          "copy from current positions");
+    CHECK(tell(src) == 1100 && tell(dst2) == 1000, "positions advanced");
+    CHECK(copy_file_range(src, FILE_SIZE, dst2, 0, 1) == 0,
+          "copy at end of file");
+    CHECK(copy_file_range(src, 0, 1, 0, 1) == -1, "copy to console fails");
+}
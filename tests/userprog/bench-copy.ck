@@ -0,0 +1,36 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# Timings vary from run to run, so only check that both were
+# reported, and that everything else went as expected.
+fail "missing read/write timing\n"
+  if !grep (/^\(bench-copy\) read\/write: \d+ cycles per kB$/, @output);
+fail "missing copy_file_range timing\n"
+  if !grep (/^\(bench-copy\) copy_file_range: \d+ cycles per kB$/, @output);
+@output = grep (!/cycles per kB$/, @output);
+check_expected (\@output, [<<'EOF']);
+(bench-copy) begin
+(bench-copy) create "src"
+(bench-copy) open "src"
+(bench-copy) create "dst1"
+(bench-copy) open "dst1"
+(bench-copy) create "dst2"
+(bench-copy) open "dst2"
+(bench-copy) copy matches
+(bench-copy) positions unchanged by explicit offsets
+(bench-copy) copy from current positions
+(bench-copy) positions advanced
+(bench-copy) copy at end of file
+(bench-copy) copy to console fails
+(bench-copy) end
+bench-copy: exit(0)
+EOF
+pass;
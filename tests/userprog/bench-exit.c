@@ -0,0 +1,44 @@
+/* Measures forking a child that writes to all of a 1 MB
+   footprint and waiting for it to exit.  Each child ends up with
+   its own copy of every page, which the kernel must free when it
+   exits, but a reaper thread does that after the parent's wait
+   returns, so the cost should be mostly that of the copies. */
+
+#include <stdint.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Size of the footprint each child writes. */
+#define FOOTPRINT (1024 * 1024)
+
+/* Number of children timed. */
+#define CHILD_CNT 10
+
+static char footprint[FOOTPRINT];
+
+void test_main(void) {
+    uint64_t start, cycles;
+    size_t ofs;
+    int i;
+
+    for (ofs = 0; ofs < FOOTPRINT; ofs += 4096)
+        footprint[ofs] = 1;
+
+    start = rdtsc();
+    for (i = 0; i < CHILD_CNT; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            for (ofs = 0; ofs < FOOTPRINT; ofs += 4096)
+                footprint[ofs]++;
+            exit(footprint[0]);
+        }
+        if (pid == PID_ERROR)
+            fail("fork failed");
+        if (wait(pid) != 2)
+            fail("child failed");
+    }
+    cycles = rdtsc() - start;
+    msg("fork+write+wait: %d cycles per child", (int) (cycles / CHILD_CNT));
+}
@@ -0,0 +1,26 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# Timings vary from run to run, so only check that they were
+# reported, that each child ran, and that everything else went as
+# expected.
+fail "missing timing\n"
+  if !grep (/^\(bench-exit\) fork\+write\+wait: \d+ cycles per child$/,
+	    @output);
+fail "wrong number of children\n"
+  if grep (/^bench-exit: exit\(2\)$/, @output) != 10;
+@output = grep (!/cycles per child$|exit\(2\)$/, @output);
+check_expected (\@output, [<<'EOF']);
+(bench-exit) begin
+(bench-exit) end
+bench-exit: exit(0)
+EOF
+pass;
@@ -0,0 +1,52 @@
+/* Measures starting a child and waiting for it to exit, from a
+   parent with a 1 MB footprint, with fork() against exec().
+   fork() shares the parent's pages copy-on-write instead of
+   copying them, and the child exits without writing to any, so
+   the cost should not grow with the parent's size. */
+
+#include <stdint.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Size of the parent's footprint. */
+#define FOOTPRINT (1024 * 1024)
+
+/* Number of children timed each way. */
+#define CHILD_CNT 10
+
+static char footprint[FOOTPRINT];
+
+void test_main(void) {
+    uint64_t start, cycles;
+    size_t ofs;
+    int i;
+
+    for (ofs = 0; ofs < FOOTPRINT; ofs += 4096)
+        footprint[ofs] = 1;
+
+    start = rdtsc();
+    for (i = 0; i < CHILD_CNT; i++) {
+        pid_t pid = fork();
+        if (pid == 0)
+            exit(footprint[0]);
+        if (pid == PID_ERROR)
+            fail("fork failed");
+        if (wait(pid) != 1)
+            fail("forked child failed");
+    }
+    cycles = rdtsc() - start;
+    msg("fork+wait: %d cycles per child", (int) (cycles / CHILD_CNT));
+
+    start = rdtsc();
+    for (i = 0; i < CHILD_CNT; i++) {
+        pid_t pid = exec("child-simple");
+        if (pid == PID_ERROR)
+            fail("exec failed");
+        if (wait(pid) != 81)
+            fail("child-simple failed");
+    }
+    cycles = rdtsc() - start;
+    msg("exec+wait: %d cycles per child", (int) (cycles / CHILD_CNT));
+}
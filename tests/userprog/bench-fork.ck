@@ -0,0 +1,31 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# Timings vary from run to run, so only check that both were
+# reported, that each child ran, and that everything else went as
+# expected.
+foreach my $how ('fork', 'exec') {
+    fail "missing $how+wait timing\n"
+      if !grep (/^\(bench-fork\) $how\+wait: \d+ cycles per child$/,
+		@output);
+}
+fail "wrong number of forked children\n"
+  if grep (/^bench-fork: exit\(1\)$/, @output) != 10;
+fail "wrong number of exec'd children\n"
+  if grep (/^child-simple: exit\(81\)$/, @output) != 10;
+@output = grep (!/cycles per child$|exit\((1|81)\)$|child-simple/,
+		@output);
+check_expected (\@output, [<<'EOF']);
+(bench-fork) begin
+(bench-fork) end
+bench-fork: exit(0)
+EOF
+pass;
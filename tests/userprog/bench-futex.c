@@ -0,0 +1,76 @@
+/* Measures the user-space mutex in <synch.h> uncontended, and
+   contended by two processes incrementing a shared counter, and
+   measures a round trip between two processes through a pair of
+   semaphores, which has to sleep in the kernel every time.
+   Checks that the counter comes out right. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/userprog/bench-futex.h"
+
+/* Number of lock/unlock pairs timed without contention. */
+#define UNCONTENDED_CNT 100000
+
+/* Starts child-futex with the segment open as FD and MODE. */
+static pid_t start_child(int fd, const char *mode) {
+    char cmd[64];
+    pid_t pid;
+
+    snprintf(cmd, sizeof cmd, "child-futex %d %s", fd, mode);
+    pid = exec_flags(cmd, EXEC_INHERIT_FDS);
+    if (pid == PID_ERROR)
+        fail("exec \"%s\" failed", cmd);
+    return pid;
+}
+
+void test_main(void) {
+    struct futex_shared *sh;
+    uint64_t start, cycles;
+    pid_t pid;
+    int fd, i;
+
+    CHECK((fd = shm_create(NULL, 1)) > 1, "create segment");
+    CHECK((sh = shm_map(fd, NULL)) != NULL, "map segment");
+    mutex_init(&sh->mutex);
+    sh->counter = 0;
+    sema_init(&sh->ping, 0);
+    sema_init(&sh->pong, 0);
+
+    start = rdtsc();
+    for (i = 0; i < UNCONTENDED_CNT; i++) {
+        mutex_lock(&sh->mutex);
+        mutex_unlock(&sh->mutex);
+    }
+    cycles = rdtsc() - start;
+    msg("uncontended: %d cycles per lock/unlock",
+        (int) (cycles / UNCONTENDED_CNT));
+
+    start = rdtsc();
+    pid = start_child(fd, "inc");
+    for (i = 0; i < INC_CNT; i++) {
+        mutex_lock(&sh->mutex);
+        sh->counter++;
+        mutex_unlock(&sh->mutex);
+    }
+    if (wait(pid) != 0)
+        fail("child-futex inc failed");
+    cycles = rdtsc() - start;
+    msg("contended: %d cycles per lock/unlock",
+        (int) (cycles / (2 * INC_CNT)));
+    CHECK(sh->counter == 2 * INC_CNT, "counter is %d", 2 * INC_CNT);
+
+    start = rdtsc();
+    pid = start_child(fd, "pong");
+    for (i = 0; i < PING_CNT; i++) {
+        sema_up(&sh->ping);
+        sema_down(&sh->pong);
+    }
+    if (wait(pid) != 0)
+        fail("child-futex pong failed");
+    cycles = rdtsc() - start;
+    msg("ping-pong: %d cycles per round trip", (int) (cycles / PING_CNT));
+}
@@ -0,0 +1,33 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# Timings vary from run to run, so only check that they were
+# reported, and that everything else went as expected.
+foreach my $what ('uncontended', 'contended') {
+    fail "missing $what timing\n"
+      if !grep (/^\(bench-futex\) $what: \d+ cycles per lock\/unlock$/,
+		@output);
+}
+fail "missing ping-pong timing\n"
+  if !grep (/^\(bench-futex\) ping-pong: \d+ cycles per round trip$/,
+	    @output);
+@output = grep (!/cycles per/, @output);
+check_expected (\@output, [<<'EOF']);
+(bench-futex) begin
+(bench-futex) create segment
+(bench-futex) map segment
+child-futex: exit(0)
+(bench-futex) counter is 400000
+child-futex: exit(0)
+(bench-futex) end
+bench-futex: exit(0)
+EOF
+pass;
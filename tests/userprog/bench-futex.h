@@ -0,0 +1,21 @@
+#ifndef TESTS_USERPROG_BENCH_FUTEX_H
+#define TESTS_USERPROG_BENCH_FUTEX_H
+
+#include <synch.h>
+
+/* Layout of the shared memory segment through which bench-futex
+   and child-futex synchronize. */
+struct futex_shared {
+    struct mutex mutex; /* Protects COUNTER. */
+    int counter; /* Incremented by both processes. */
+    struct semaphore ping; /* Upped by the parent. */
+    struct semaphore pong; /* Upped by the child. */
+};
+
+/* Number of increments of COUNTER by each process. */
+#define INC_CNT 200000
+
+/* Number of round trips through PING and PONG. */
+#define PING_CNT 2000
+
+#endif /* tests/userprog/bench-futex.h */
@@ -0,0 +1,72 @@
+/* Measures the round trip into the kernel and back for a system
+   call that does no work, once through "int $0x30" and once
+   through SYSENTER, if the CPU supports it.  The call number is
+   out of range, so the kernel just copies it in and returns -1. */
+
+#include <stdint.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Number of calls to time. */
+#define CALL_CNT 100000
+
+/* A system call number that no system call has. */
+#define NULL_NR 0x7fffffff
+
+/* Makes the null system call with "int $0x30". */
+static int null_int(void) {
+    int retval;
+    asm volatile("pushl %[number]; int $0x30; addl $4, %%esp"
+                 : "=a"(retval)
+                 : [number] "i"(NULL_NR)
+                 : "memory");
+    return retval;
+}
+
+/* Makes the null system call with SYSENTER. */
+static int null_sysenter(void) {
+    int retval;
+    asm volatile("pushl %[number]; movl %%esp, %%ecx; movl $1f, %%edx; "
+                 "sysenter; 1: addl $4, %%esp"
+                 : "=a"(retval)
+                 : [number] "i"(NULL_NR)
+                 : "ecx", "edx", "memory");
+    return retval;
+}
+
+/* Returns true if the CPU supports SYSENTER, using the same test
+   as the kernel. */
+static bool have_sysenter(void) {
+    unsigned eax, ebx, ecx, edx;
+
+    asm volatile("cpuid"
+                 : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
+                 : "a"(1), "c"(0));
+    return (edx & (1u << 11)) != 0 &&
+           !(((eax >> 8) & 0xf) == 6 && ((eax >> 4) & 0xf) < 3 &&
+             (eax & 0xf) < 3);
+}
+
+/* Times CALL_CNT calls to CALL and reports the average under
+   NAME. */
+static void time_calls(const char *name, int (*call)(void)) {
+    uint64_t start, cycles;
+    int i;
+
+    start = rdtsc();
+    for (i = 0; i < CALL_CNT; i++)
+        if (call() != -1)
+            fail("%s: null system call did not return -1", name);
+    cycles = rdtsc() - start;
+    msg("%s: %d cycles per call", name, (int) (cycles / CALL_CNT));
+}
+
+void test_main(void) {
+    time_calls("int", null_int);
+    if (have_sysenter())
+        time_calls("sysenter", null_sysenter);
+    else
+        msg("sysenter: not supported");
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# Timings vary from run to run, so only check that both were
+# reported.
+fail "missing int timing\n"
+  if !grep (/^\(bench-null-syscall\) int: \d+ cycles per call$/, @output);
+fail "missing sysenter timing\n"
+  if !grep (/^\(bench-null-syscall\) sysenter: (\d+ cycles per call|not supported)$/, @output);
+fail "missing exit code\n"
+  if !grep (/^bench-null-syscall: exit\(0\)$/, @output);
+pass;
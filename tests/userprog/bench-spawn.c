@@ -0,0 +1,47 @@
+/* Measures the time until 16 children are all loaded and
+   running, starting them one at a time with exec(), which waits
+   for each to load before starting the next, against starting
+   them all at once with spawn_many(), which lets their loads
+   overlap. */
+
+#include <stdint.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Number of children started each way. */
+#define CHILD_CNT 16
+
+/* Waits for the CHILD_CNT children in PIDS to exit. */
+static void wait_all(const pid_t pids[]) {
+    int i;
+
+    for (i = 0; i < CHILD_CNT; i++)
+        if (wait(pids[i]) != 81)
+            fail("child-simple failed");
+}
+
+void test_main(void) {
+    const char *cmd_lines[CHILD_CNT];
+    pid_t pids[CHILD_CNT];
+    uint64_t start, cycles;
+    int i;
+
+    start = rdtsc();
+    for (i = 0; i < CHILD_CNT; i++)
+        if ((pids[i] = exec("child-simple")) == PID_ERROR)
+            fail("exec failed");
+    cycles = rdtsc() - start;
+    wait_all(pids);
+    msg("exec: %llu cycles until all running", cycles);
+
+    for (i = 0; i < CHILD_CNT; i++)
+        cmd_lines[i] = "child-simple";
+    start = rdtsc();
+    if (spawn_many(cmd_lines, CHILD_CNT, 0, pids) != CHILD_CNT)
+        fail("spawn_many failed");
+    cycles = rdtsc() - start;
+    wait_all(pids);
+    msg("spawn_many: %llu cycles until all running", cycles);
+}
@@ -0,0 +1,29 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# Timings vary from run to run, so only check that both were
+# reported, that each child ran, and that everything else went as
+# expected.
+foreach my $how ('exec', 'spawn_many') {
+    fail "missing $how timing\n"
+      if !grep (/^\(bench-spawn\) $how: \d+ cycles until all running$/,
+		@output);
+}
+fail "wrong number of children\n"
+  if grep (/^child-simple: exit\(81\)$/, @output) != 32;
+@output = grep (!/cycles until all running$|^\(child-simple\) |^child-simple: /,
+		@output);
+check_expected (\@output, [<<'EOF']);
+(bench-spawn) begin
+(bench-spawn) end
+bench-spawn: exit(0)
+EOF
+pass;
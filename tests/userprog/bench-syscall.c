@@ -0,0 +1,53 @@
+/* Measures system call throughput: first the cost of a call
+   that does almost nothing, then the cost of writing and reading
+   back a large buffer, which is dominated by how the kernel
+   validates and copies user memory. */
+
+#include <stdint.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Size of the file and of the buffer written to it. */
+#define BUF_SIZE 65536
+
+/* Number of calls or passes to time. */
+#define CALL_CNT 10000
+#define PASS_CNT 16
+
+static char buf[BUF_SIZE];
+
+void test_main(void) {
+    uint64_t start, cycles;
+    int handle, i;
+
+    CHECK(create("bench", BUF_SIZE), "create \"bench\"");
+    CHECK((handle = open("bench")) > 1, "open \"bench\"");
+
+    start = rdtsc();
+    for (i = 0; i < CALL_CNT; i++)
+        tell(handle);
+    cycles = rdtsc() - start;
+    msg("tell: %d cycles per call", (int) (cycles / CALL_CNT));
+
+    start = rdtsc();
+    for (i = 0; i < PASS_CNT; i++) {
+        seek(handle, 0);
+        if (write(handle, buf, BUF_SIZE) != BUF_SIZE)
+            fail("write failed");
+    }
+    cycles = rdtsc() - start;
+    msg("write: %d cycles per kB", (int) (cycles / (PASS_CNT * BUF_SIZE / 1024)));
+
+    start = rdtsc();
+    for (i = 0; i < PASS_CNT; i++) {
+        seek(handle, 0);
+        if (read(handle, buf, BUF_SIZE) != BUF_SIZE)
+            fail("read failed");
+    }
+    cycles = rdtsc() - start;
+    msg("read: %d cycles per kB", (int) (cycles / (PASS_CNT * BUF_SIZE / 1024)));
+
+    close(handle);
+}
@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# Timings vary from run to run, so only check that each was
+# reported.
+foreach my $what ('tell: \d+ cycles per call',
+                  'write: \d+ cycles per kB',
+                  'read: \d+ cycles per kB') {
+  fail "missing timing matching \"$what\"\n"
+    if !grep (/^\(bench-syscall\) $what$/, @output);
+}
+fail "missing exit code\n" if !grep (/^bench-syscall: exit\(0\)$/, @output);
+pass;
@@ -0,0 +1,57 @@
+/* Measures small reads through a shared system call ring against
+   the same reads made one system call at a time. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include <uring.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Size of the file read. */
+#define FILE_SIZE 16384
+
+/* Bytes per read, and number of reads timed. */
+#define READ_SIZE 16
+#define READ_CNT 8192
+
+/* Reads submitted per uring_submit() call. */
+#define BATCH 32
+
+static char buf[READ_SIZE * BATCH];
+
+/* Returns the file offset of read number I. */
+static int read_ofs(int i) {
+    return (i * READ_SIZE) % FILE_SIZE;
+}
+
+void test_main(void) {
+    struct uring *ring;
+    struct uring_cqe cqe;
+    uint64_t start, cycles;
+    int fd, i, j;
+
+    CHECK(create("bench", FILE_SIZE), "create \"bench\"");
+    CHECK((fd = open("bench")) > 1, "open \"bench\"");
+    CHECK((ring = uring_setup(0)) != NULL, "uring_setup");
+
+    start = rdtsc();
+    for (i = 0; i < READ_CNT; i++)
+        if (pread(fd, buf, READ_SIZE, read_ofs(i)) != READ_SIZE)
+            fail("pread failed");
+    cycles = rdtsc() - start;
+    msg("syscall: %d cycles per read", (int) (cycles / READ_CNT));
+
+    start = rdtsc();
+    for (i = 0; i < READ_CNT; i += BATCH) {
+        for (j = 0; j < BATCH; j++)
+            uring_prep(ring, URING_OP_READ, fd, buf + j * READ_SIZE, READ_SIZE,
+                       read_ofs(i + j), j);
+        uring_submit(ring, BATCH);
+        while (uring_reap(ring, &cqe))
+            if (cqe.res != READ_SIZE)
+                fail("ring read failed");
+    }
+    cycles = rdtsc() - start;
+    msg("uring: %d cycles per read", (int) (cycles / READ_CNT));
+}
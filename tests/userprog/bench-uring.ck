@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# Timings vary from run to run, so only check that both were
+# reported.
+fail "missing syscall timing\n"
+  if !grep (/^\(bench-uring\) syscall: \d+ cycles per read$/, @output);
+fail "missing uring timing\n"
+  if !grep (/^\(bench-uring\) uring: \d+ cycles per read$/, @output);
+fail "missing exit code\n" if !grep (/^bench-uring: exit\(0\)$/, @output);
+pass;
@@ -0,0 +1,42 @@
+/* Child process run by bench-futex test.
+
+   Its arguments are the fd of a shared memory segment inherited
+   from the parent, which holds a struct futex_shared, and what
+   to do with it: "inc" to increment the counter under the mutex
+   INC_CNT times, or "pong" to answer PING_CNT pings. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/userprog/bench-futex.h"
+
+int main(int argc, char *argv[]) {
+    struct futex_shared *sh;
+    int i;
+
+    test_name = "child-futex";
+
+    if (argc != 3)
+        fail("bad command-line arguments");
+    sh = shm_map(atoi(argv[1]), NULL);
+    if (sh == NULL)
+        fail("can't map segment");
+
+    if (!strcmp(argv[2], "inc"))
+        for (i = 0; i < INC_CNT; i++) {
+            mutex_lock(&sh->mutex);
+            sh->counter++;
+            mutex_unlock(&sh->mutex);
+        }
+    else if (!strcmp(argv[2], "pong"))
+        for (i = 0; i < PING_CNT; i++) {
+            sema_down(&sh->ping);
+            sema_up(&sh->pong);
+        }
+    else
+        fail("unknown mode \"%s\"", argv[2]);
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+/* Child process run by pipe-exec test.
+
+   Takes the read and write ends of the pipe it reads from, then
+   those of the pipe it writes to, as command-line arguments, all
+   inherited from the parent.  Closes the ends it doesn't use,
+   then copies everything it reads to its output in upper case
+   until end of file. */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+
+int main(int argc, char *argv[]) {
+    int in_fd, out_fd;
+    char buf[16];
+    int n, i;
+
+    test_name = "child-pipe";
+
+    if (argc != 5)
+        fail("bad command-line arguments");
+    in_fd = atoi(argv[1]);
+    out_fd = atoi(argv[4]);
+    close(atoi(argv[2]));
+    close(atoi(argv[3]));
+
+    while ((n = read(in_fd, buf, sizeof buf)) > 0) {
+        for (i = 0; i < n; i++)
+            buf[i] = toupper((unsigned char) buf[i]);
+        if (write(out_fd, buf, n) != n)
+            fail("write failed");
+    }
+    if (n < 0)
+        fail("read failed");
+
+    return 0;
+}
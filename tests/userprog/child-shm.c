@@ -0,0 +1,28 @@
+/* Child process run by shm-child test.
+
+   Its argument is either the fd of a shared memory segment
+   inherited from the parent or the name of a segment to open.
+   Maps the segment and writes a greeting into it. */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+
+int main(int argc, char *argv[]) {
+    char *p;
+    int fd;
+
+    test_name = "child-shm";
+
+    if (argc != 2)
+        fail("bad command-line arguments");
+    fd = isdigit(*argv[1]) ? atoi(argv[1]) : shm_create(argv[1], 0);
+    if (fd < 0 || (p = shm_map(fd, NULL)) == NULL)
+        fail("can't map segment \"%s\"", argv[1]);
+    snprintf(p, 64, "hello from child-shm %s", argv[1]);
+
+    return 0;
+}
@@ -0,0 +1,44 @@
+/* Duplicates a file descriptor with dup() and dup2() and checks
+   that the duplicates share one file position and survive the
+   original being closed. */
+
+#include <string.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/userprog/sample.inc"
+
+/* Reads SIZE bytes from FD and checks that they match sample[]
+   starting at OFS. */
+static void read_check(int fd, size_t ofs, size_t size) {
+    char buf[32];
+
+    if (read(fd, buf, size) != (int) size)
+        fail("read %zu bytes from fd %d failed", size, fd);
+    if (memcmp(buf, sample + ofs, size))
+        fail("fd %d read wrong data at offset %zu", fd, ofs);
+}
+
+void test_main(void) {
+    int fd, copy, other;
+
+    CHECK((fd = open("sample.txt")) > 1, "open \"sample.txt\"");
+    CHECK((copy = dup(fd)) > fd, "dup");
+    read_check(fd, 0, 10);
+    read_check(copy, 10, 10);
+    CHECK(tell(fd) == 20, "position is shared");
+
+    CHECK((other = open("sample.txt")) > 1, "open \"sample.txt\" again");
+    CHECK(dup2(fd, other) == other, "dup2 onto open fd");
+    read_check(other, 20, 10);
+
+    close(fd);
+    close(copy);
+    read_check(other, 30, 10);
+    msg("read after closing original");
+
+    CHECK(dup(1) == -1, "dup console fails");
+    CHECK(dup2(other, 1) == -1, "dup2 onto console fails");
+    CHECK(dup(fd) == -1, "dup closed fd fails");
+}
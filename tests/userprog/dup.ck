@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(dup) begin
+(dup) open "sample.txt"
+(dup) dup
+(dup) position is shared
+(dup) open "sample.txt" again
+(dup) dup2 onto open fd
+(dup) read after closing original
+(dup) dup console fails
+(dup) dup2 onto console fails
+(dup) dup closed fd fails
+(dup) end
+dup: exit(0)
+EOF
+pass;
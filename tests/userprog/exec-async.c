@@ -0,0 +1,34 @@
+/* Starts children with exec_flags(EXEC_ASYNC) and spawn_many(),
+   which return without waiting for them to load, and checks
+   that exec_status() and wait() report whether they did. */
+
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void test_main(void) {
+    const char *cmd_lines[] = {"child-simple", "no-such-file",
+                               "child-simple"};
+    pid_t pids[3];
+    pid_t pid;
+
+    CHECK((pid = exec_flags("child-simple", EXEC_ASYNC)) != PID_ERROR,
+          "exec child-simple without waiting");
+    CHECK(exec_status(pid) == 1, "child-simple loaded");
+    CHECK(wait(pid) == 81, "wait for child-simple");
+    CHECK(exec_status(pid) == -1, "no status once waited for");
+
+    CHECK((pid = exec_flags("no-such-file", EXEC_ASYNC)) != PID_ERROR,
+          "exec no-such-file without waiting");
+    CHECK(exec_status(pid) == 0, "no-such-file failed to load");
+    CHECK(wait(pid) == -1, "wait for no-such-file");
+
+    CHECK(spawn_many(cmd_lines, 3, 0, pids) == 2,
+          "spawn_many loads two of three");
+    CHECK(pids[0] != PID_ERROR && pids[1] == PID_ERROR &&
+              pids[2] != PID_ERROR,
+          "only no-such-file has no pid");
+    CHECK(wait(pids[0]) == 81 && wait(pids[2]) == 81,
+          "wait for both children");
+}
@@ -0,0 +1,36 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# Children run alongside the parent, so their output may land
+# anywhere.  Check that each ran, then that everything else went
+# as expected.
+fail "wrong number of child-simple exits\n"
+  if grep (/^child-simple: exit\(81\)$/, @output) != 3;
+fail "wrong number of failed loads\n"
+  if grep (/^load: no-such-file: open failed$/, @output) != 2;
+@output = grep (!/^\(child-simple\) |^child-simple: |^load: |^no-such-file: /,
+		@output);
+check_expected (\@output, [<<'EOF']);
+(exec-async) begin
+(exec-async) exec child-simple without waiting
+(exec-async) child-simple loaded
+(exec-async) wait for child-simple
+(exec-async) no status once waited for
+(exec-async) exec no-such-file without waiting
+(exec-async) no-such-file failed to load
+(exec-async) wait for no-such-file
+(exec-async) spawn_many loads two of three
+(exec-async) only no-such-file has no pid
+(exec-async) wait for both children
+(exec-async) end
+exec-async: exit(0)
+EOF
+pass;
@@ -0,0 +1,49 @@
+/* Forks a child that writes to its copies of the parent's data,
+   stack, and a buffer the kernel reads a file into, and to a
+   shared memory segment.  Checks that the parent sees only the
+   write to shared memory, and that the child's read moved the
+   file position the two of them share. */
+
+#include <string.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Initialized data, which the child overwrites. */
+static int value = 1;
+
+/* Zeroed data, which the child reads a file into. */
+static char buf[16];
+
+void test_main(void) {
+    int local = 1;
+    int *shared;
+    int fd, shm_fd, status;
+    pid_t pid;
+
+    CHECK((fd = open("sample.txt")) > 1, "open \"sample.txt\"");
+    CHECK((shm_fd = shm_create(NULL, 1)) > 1, "create segment");
+    CHECK((shared = shm_map(shm_fd, NULL)) != NULL, "map segment");
+
+    /* Nothing may be printed between fork() and wait(), so that
+       the child's messages come out in a predictable order. */
+    pid = fork();
+    if (pid == 0) {
+        msg("child sees %d, %d", value, local);
+        value = local = 2;
+        *shared = 3;
+        if (read(fd, buf, 10) != 10)
+            fail("child's read failed");
+        msg("child read \"%.10s\"", buf);
+        exit(value + local);
+    }
+    status = wait(pid);
+
+    CHECK(pid != PID_ERROR, "fork");
+    CHECK(status == 4, "child exited with 4");
+    CHECK(value == 1 && local == 1, "parent still sees 1, 1");
+    CHECK(buf[0] == '\0', "parent's buffer still empty");
+    CHECK(*shared == 3, "parent sees write to segment");
+    CHECK(tell(fd) == 10, "child moved file position");
+}
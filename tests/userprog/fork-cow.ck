@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fork-cow) begin
+(fork-cow) open "sample.txt"
+(fork-cow) create segment
+(fork-cow) map segment
+(fork-cow) child sees 1, 1
+(fork-cow) child read ""Amazing E"
+fork-cow: exit(4)
+(fork-cow) fork
+(fork-cow) child exited with 4
+(fork-cow) parent still sees 1, 1
+(fork-cow) parent's buffer still empty
+(fork-cow) parent sees write to segment
+(fork-cow) child moved file position
+(fork-cow) end
+fork-cow: exit(0)
+EOF
+pass;
@@ -0,0 +1,35 @@
+/* Checks the futex system calls' behavior when nothing has to
+   sleep, and the fast paths of the user-space primitives built
+   on them. */
+
+#include <synch.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void test_main(void) {
+    int words[2] = {5, 0};
+    struct mutex m;
+    struct semaphore s;
+
+    CHECK(futex_wait(&words[0], 4) == -1, "wait with wrong value fails");
+    CHECK(futex_wake(&words[0], 1) == 0, "wake with no waiters wakes 0");
+    CHECK(futex_wait((int *) ((char *) words + 1), 0) == -1,
+          "wait on misaligned address fails");
+
+    mutex_init(&m);
+    CHECK(mutex_trylock(&m), "trylock free mutex");
+    CHECK(!mutex_trylock(&m), "trylock locked mutex fails");
+    mutex_unlock(&m);
+    mutex_lock(&m);
+    mutex_unlock(&m);
+    CHECK(m.state == 0, "mutex free again");
+
+    sema_init(&s, 1);
+    CHECK(sema_try_down(&s), "try_down at 1");
+    CHECK(!sema_try_down(&s), "try_down at 0 fails");
+    sema_up(&s);
+    sema_down(&s);
+    CHECK(s.value == 0, "semaphore back at 0");
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-basic) begin
+(futex-basic) wait with wrong value fails
+(futex-basic) wake with no waiters wakes 0
+(futex-basic) wait on misaligned address fails
+(futex-basic) trylock free mutex
+(futex-basic) trylock locked mutex fails
+(futex-basic) mutex free again
+(futex-basic) try_down at 1
+(futex-basic) try_down at 0 fails
+(futex-basic) semaphore back at 0
+(futex-basic) end
+futex-basic: exit(0)
+EOF
+pass;
@@ -0,0 +1,46 @@
+/* Sleeps on a futex in a process whose pages are shared
+   copy-on-write with a forked child, then writes to the futex,
+   which moves it to a frame of its own, and checks that waking
+   it still reaches the sleeper. */
+
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static int word;
+
+/* Sleeps on WORD until it changes from 0. */
+static int waiter(void *aux UNUSED) {
+    while (word == 0)
+        futex_wait(&word, 0);
+    return word;
+}
+
+void test_main(void) {
+    int fds[2];
+    pid_t pid;
+    tid_t tid;
+    char c = 'x';
+
+    CHECK(pipe(fds), "create pipe");
+    pid = fork();
+    if (pid == 0) {
+        /* Keep our copy of the parent's pages until it is done. */
+        read(fds[0], &c, 1);
+        exit(7);
+    }
+    CHECK(pid != PID_ERROR, "fork");
+
+    CHECK((tid = thread_create(waiter, NULL)) != TID_ERROR,
+          "start waiter");
+    poll(NULL, 0, 100);
+    word = 1;
+    CHECK(futex_wake(&word, 1) == 1, "wake waiter after copy on write");
+    CHECK(thread_join(tid) == 1, "join waiter");
+
+    msg("let child exit");
+    if (write(fds[1], &c, 1) != 1)
+        fail("write to pipe failed");
+    CHECK(wait(pid) == 7, "wait for child");
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-fork) begin
+(futex-fork) create pipe
+(futex-fork) fork
+(futex-fork) start waiter
+(futex-fork) wake waiter after copy on write
+(futex-fork) join waiter
+(futex-fork) let child exit
+futex-fork: exit(7)
+(futex-fork) wait for child
+(futex-fork) end
+futex-fork: exit(0)
+EOF
+pass;
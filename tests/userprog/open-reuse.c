@@ -0,0 +1,27 @@
+/* Opens and closes a file many more times than a process could
+   ever have open at once, checking that each close frees its
+   file descriptor for the next open, and that open always
+   returns the lowest free descriptor. */
+
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void test_main(void) {
+    int first, second, i;
+
+    CHECK((first = open("sample.txt")) > 1, "open \"sample.txt\"");
+    CHECK((second = open("sample.txt")) > first, "open \"sample.txt\" again");
+
+    for (i = 0; i < 1000; i++) {
+        int fd = open("sample.txt");
+        if (fd != second + 1)
+            fail("open #%d returned %d instead of %d", i, fd, second + 1);
+        close(fd);
+    }
+    msg("opened and closed 1000 times");
+
+    close(first);
+    CHECK(open("sample.txt") == first, "reopen reuses lowest fd");
+}
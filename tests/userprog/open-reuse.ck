@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(open-reuse) begin
+(open-reuse) open "sample.txt"
+(open-reuse) open "sample.txt" again
+(open-reuse) opened and closed 1000 times
+(open-reuse) reopen reuses lowest fd
+(open-reuse) end
+open-reuse: exit(0)
+EOF
+pass;
@@ -0,0 +1,41 @@
+/* Runs a child that inherits the ends of two pipes, sends it a
+   message down one of them, and reads back what the child makes
+   of it from the other. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static const char message[] = "down the pipe and back";
+
+void test_main(void) {
+    int to_child[2], from_child[2];
+    char cmd[64], buf[64];
+    int n, total = 0;
+    pid_t child;
+
+    CHECK(pipe(to_child) && pipe(from_child), "create pipes");
+    snprintf(cmd, sizeof cmd, "child-pipe %d %d %d %d", to_child[0],
+             to_child[1], from_child[0], from_child[1]);
+    CHECK((child = exec_flags(cmd, EXEC_INHERIT_FDS)) != PID_ERROR,
+          "exec child-pipe");
+
+    /* Only the child may hold these, or the child would never see
+       end of file, and neither would we. */
+    close(to_child[0]);
+    close(from_child[1]);
+
+    CHECK(write(to_child[1], message, strlen(message)) ==
+              (int) strlen(message),
+          "write to child");
+    close(to_child[1]);
+
+    while ((n = read(from_child[0], buf + total, sizeof buf - 1 - total)) > 0)
+        total += n;
+    buf[total] = '\0';
+    msg("child sent \"%s\"", buf);
+    CHECK(wait(child) == 0, "wait for child");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-exec) begin
+(pipe-exec) create pipes
+(pipe-exec) exec child-pipe
+(pipe-exec) write to child
+child-pipe: exit(0)
+(pipe-exec) child sent "DOWN THE PIPE AND BACK"
+(pipe-exec) wait for child
+(pipe-exec) end
+pipe-exec: exit(0)
+EOF
+pass;
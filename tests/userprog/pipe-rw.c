@@ -0,0 +1,55 @@
+/* Writes to and reads from a pipe within one process, both in
+   small pieces that go through the pipe's ring buffer and in
+   whole pages, then checks what happens when either end is
+   closed. */
+
+#include <string.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Big enough to take several whole pages, small enough that the
+   pipe holds all of it without a reader. */
+#define BIG_SIZE (8 * 4096)
+
+static char big[BIG_SIZE] __attribute__((aligned(4096)));
+static char big2[BIG_SIZE] __attribute__((aligned(4096)));
+
+void test_main(void) {
+    int fds[2], fds2[2];
+    char buf[128];
+    size_t i;
+
+    CHECK(pipe(fds), "pipe");
+    CHECK(write(fds[1], "hello, pipe", 11) == 11, "write 11 bytes");
+    CHECK(read(fds[0], buf, sizeof buf) == 11, "read 11 bytes");
+    if (memcmp(buf, "hello, pipe", 11))
+        fail("read wrong data");
+
+    for (i = 0; i < BIG_SIZE; i++)
+        big[i] = i % 251;
+    CHECK(write(fds[1], big, BIG_SIZE) == BIG_SIZE, "write %d aligned bytes",
+          BIG_SIZE);
+    CHECK(read(fds[0], big2, BIG_SIZE) == BIG_SIZE, "read %d aligned bytes",
+          BIG_SIZE);
+    if (memcmp(big, big2, BIG_SIZE))
+        fail("read wrong data");
+
+    CHECK(write(fds[1], big, 4096) == 4096, "write 4096 aligned bytes");
+    CHECK(read(fds[0], buf, 100) == 100, "read 100 bytes");
+    CHECK(read(fds[0], big2, BIG_SIZE) == 3996, "read 3996 bytes");
+    if (memcmp(buf, big, 100) || memcmp(big2, big + 100, 3996))
+        fail("read wrong data");
+
+    CHECK(read(fds[1], buf, 1) == -1, "read from write end fails");
+    CHECK(write(fds[0], buf, 1) == -1, "write to read end fails");
+
+    close(fds[1]);
+    CHECK(read(fds[0], buf, sizeof buf) == 0, "read at end of file");
+    close(fds[0]);
+
+    CHECK(pipe(fds2), "pipe");
+    close(fds2[0]);
+    CHECK(write(fds2[1], "x", 1) == -1, "write without readers fails");
+}
@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-rw) begin
+(pipe-rw) pipe
+(pipe-rw) write 11 bytes
+(pipe-rw) read 11 bytes
+(pipe-rw) write 32768 aligned bytes
+(pipe-rw) read 32768 aligned bytes
+(pipe-rw) write 4096 aligned bytes
+(pipe-rw) read 100 bytes
+(pipe-rw) read 3996 bytes
+(pipe-rw) read from write end fails
+(pipe-rw) write to read end fails
+(pipe-rw) read at end of file
+(pipe-rw) pipe
+(pipe-rw) write without readers fails
+(pipe-rw) end
+pipe-rw: exit(0)
+EOF
+pass;
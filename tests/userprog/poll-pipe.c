@@ -0,0 +1,75 @@
+/* Checks poll() on the console and on both ends of a pipe,
+   including sleeping until a timeout and until another thread
+   writes, and checks O_NONBLOCK reads and readv()s. */
+
+#include <iovec.h>
+#include <string.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Sleeps briefly by polling nothing, then writes "hello" to the
+   pipe write end whose fd AUX points to. */
+static int writer(void *aux) {
+    int fd = *(int *) aux;
+
+    poll(NULL, 0, 20);
+    return write(fd, "hello", 5);
+}
+
+void test_main(void) {
+    struct pollfd pfd[2];
+    struct iovec iov[2];
+    char buf[16];
+    int fds[2];
+    tid_t tid;
+
+    CHECK(pipe(fds), "create pipe");
+    pfd[0].fd = fds[0];
+    pfd[0].events = POLLIN;
+    pfd[1].fd = fds[1];
+    pfd[1].events = POLLOUT;
+    CHECK(poll(pfd, 2, 0) == 1 && pfd[0].revents == 0 &&
+              pfd[1].revents == POLLOUT,
+          "only write end is ready");
+    CHECK(poll(pfd, 1, 30) == 0 && pfd[0].revents == 0,
+          "poll of empty pipe times out");
+
+    CHECK(fcntl(fds[0], F_SETFL, O_NONBLOCK) == 0,
+          "make read end nonblocking");
+    CHECK(fcntl(fds[0], F_GETFL, 0) == O_NONBLOCK, "flag is set");
+    CHECK(read(fds[0], buf, sizeof buf) == -1,
+          "nonblocking read of empty pipe fails");
+
+    CHECK((tid = thread_create(writer, &fds[1])) != TID_ERROR,
+          "start writer thread");
+    CHECK(poll(pfd, 1, -1) == 1 && pfd[0].revents == POLLIN,
+          "poll wakes up when data arrives");
+    CHECK(read(fds[0], buf, sizeof buf) == 5 && !memcmp(buf, "hello", 5),
+          "read \"hello\"");
+    CHECK(thread_join(tid) == 5, "join writer thread");
+
+    close(fds[1]);
+    CHECK(poll(pfd, 1, -1) == 1 && pfd[0].revents == POLLHUP,
+          "read end hangs up after write end closes");
+    pfd[1].events = POLLIN;
+    CHECK(poll(pfd + 1, 1, 0) == 1 && pfd[1].revents == POLLNVAL,
+          "closed fd is invalid");
+
+    pfd[0].fd = 0;
+    pfd[0].events = POLLIN;
+    pfd[1].fd = 1;
+    pfd[1].events = POLLOUT;
+    CHECK(poll(pfd, 2, 0) == 1 && pfd[0].revents == 0 &&
+              pfd[1].revents == POLLOUT,
+          "console output is ready, input is not");
+    CHECK(fcntl(0, F_SETFL, O_NONBLOCK) == 0, "make console nonblocking");
+    CHECK(read(0, buf, sizeof buf) == -1,
+          "nonblocking read of console fails");
+    iov[0].iov_base = buf;
+    iov[0].iov_len = 4;
+    iov[1].iov_base = buf + 4;
+    iov[1].iov_len = 4;
+    CHECK(readv(0, iov, 2) == -1, "nonblocking readv of console fails");
+}
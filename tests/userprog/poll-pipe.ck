@@ -0,0 +1,26 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(poll-pipe) begin
+(poll-pipe) create pipe
+(poll-pipe) only write end is ready
+(poll-pipe) poll of empty pipe times out
+(poll-pipe) make read end nonblocking
+(poll-pipe) flag is set
+(poll-pipe) nonblocking read of empty pipe fails
+(poll-pipe) start writer thread
+(poll-pipe) poll wakes up when data arrives
+(poll-pipe) read "hello"
+(poll-pipe) join writer thread
+(poll-pipe) read end hangs up after write end closes
+(poll-pipe) closed fd is invalid
+(poll-pipe) console output is ready, input is not
+(poll-pipe) make console nonblocking
+(poll-pipe) nonblocking read of console fails
+(poll-pipe) nonblocking readv of console fails
+(poll-pipe) end
+poll-pipe: exit(0)
+EOF
+pass;
@@ -0,0 +1,34 @@
+/* Reads and writes a file at explicit positions with pread() and
+   pwrite(), checking the data and that the file position is left
+   alone. */
+
+#include <string.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/userprog/sample.inc"
+
+void test_main(void) {
+    char buf[sizeof sample];
+    int fd;
+
+    CHECK(create("test.txt", sizeof sample - 1), "create \"test.txt\"");
+    CHECK((fd = open("test.txt")) > 1, "open \"test.txt\"");
+
+    /* Write the sample back to front, in two halves. */
+    CHECK(pwrite(fd, sample + 100, sizeof sample - 101, 100)
+              == (int) sizeof sample - 101,
+          "pwrite second half");
+    CHECK(pwrite(fd, sample, 100, 0) == 100, "pwrite first half");
+    CHECK(tell(fd) == 0, "position unchanged");
+
+    memset(buf, 0, sizeof buf);
+    CHECK(pread(fd, buf + 50, sizeof sample - 51, 50)
+              == (int) sizeof sample - 51,
+          "pread from middle");
+    if (memcmp(buf + 50, sample + 50, sizeof sample - 51))
+        fail("pread returned wrong data");
+    CHECK(pread(fd, buf, 10, sizeof sample - 1) == 0, "pread at end of file");
+    CHECK(tell(fd) == 0, "position unchanged");
+}
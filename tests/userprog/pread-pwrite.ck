@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pread-pwrite) begin
+(pread-pwrite) create "test.txt"
+(pread-pwrite) open "test.txt"
+(pread-pwrite) pwrite second half
+(pread-pwrite) pwrite first half
+(pread-pwrite) position unchanged
+(pread-pwrite) pread from middle
+(pread-pwrite) pread at end of file
+(pread-pwrite) position unchanged
+(pread-pwrite) end
+pread-pwrite: exit(0)
+EOF
+pass;
@@ -0,0 +1,43 @@
+/* Writes a file from several buffers with writev() and reads it
+   back into several differently sized buffers with readv(). */
+
+#include <iovec.h>
+#include <string.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/userprog/sample.inc"
+
+void test_main(void) {
+    static char a[17], b[100], c[sizeof sample];
+    struct iovec iov[3];
+    size_t size = sizeof sample - 1;
+    int fd;
+
+    CHECK(create("test.txt", size), "create \"test.txt\"");
+    CHECK((fd = open("test.txt")) > 1, "open \"test.txt\"");
+
+    iov[0].iov_base = sample;
+    iov[0].iov_len = 40;
+    iov[1].iov_base = sample + 40;
+    iov[1].iov_len = 0;
+    iov[2].iov_base = sample + 40;
+    iov[2].iov_len = size - 40;
+    CHECK(writev(fd, iov, 3) == (int) size, "writev 3 buffers");
+
+    seek(fd, 0);
+    iov[0].iov_base = a;
+    iov[0].iov_len = sizeof a;
+    iov[1].iov_base = b;
+    iov[1].iov_len = sizeof b;
+    iov[2].iov_base = c;
+    iov[2].iov_len = sizeof c;
+    CHECK(readv(fd, iov, 3) == (int) size, "readv 3 buffers");
+    if (memcmp(a, sample, sizeof a) || memcmp(b, sample + sizeof a, sizeof b)
+        || memcmp(c, sample + sizeof a + sizeof b,
+                  size - sizeof a - sizeof b))
+        fail("readv returned wrong data");
+
+    CHECK(writev(1, iov, 0) == 0, "writev nothing to console");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(readv-writev) begin
+(readv-writev) create "test.txt"
+(readv-writev) open "test.txt"
+(readv-writev) writev 3 buffers
+(readv-writev) readv 3 buffers
+(readv-writev) writev nothing to console
+(readv-writev) end
+readv-writev: exit(0)
+EOF
+pass;
@@ -0,0 +1,65 @@
+/* Checks that getrusage() counts the calling process's system
+   calls, bytes read and written, copy-on-write page faults, and
+   user time, and that an exited child's usage is added to its
+   parent's totals for children. */
+
+#include <string.h>
+#include <syscall-nr.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[4096];
+
+/* Written only once the child below exits. */
+static char cow_page[4096] __attribute__((aligned(4096)));
+
+void test_main(void) {
+    struct rusage before, after;
+    int fds[2];
+    pid_t pid;
+    int i;
+
+    CHECK(pipe(fds), "create pipe");
+
+    getrusage(RUSAGE_SELF, &before);
+    write(fds[1], buf, 100);
+    read(fds[0], buf, sizeof buf);
+    getrusage(RUSAGE_SELF, &after);
+    CHECK(after.syscalls[SYS_GETRUSAGE] - before.syscalls[SYS_GETRUSAGE] == 1,
+          "getrusage counted once");
+    CHECK(after.syscalls[SYS_WRITE] - before.syscalls[SYS_WRITE] == 1 &&
+              after.syscalls[SYS_READ] - before.syscalls[SYS_READ] == 1,
+          "one write and one read counted");
+    CHECK(after.bytes_written - before.bytes_written == 100 &&
+              after.bytes_read - before.bytes_read == 100,
+          "100 bytes written and read");
+
+    /* The child leaves COW_PAGE shared copy-on-write with us, so
+       our first write to it faults. */
+    CHECK((pid = fork()) != PID_ERROR, "fork");
+    if (pid == 0) {
+        write(fds[1], buf, 50);
+        exit(0);
+    }
+    CHECK(wait(pid) == 0, "wait for child");
+    getrusage(RUSAGE_SELF, &before);
+    cow_page[0] = 1;
+    getrusage(RUSAGE_SELF, &after);
+    CHECK(after.page_faults > before.page_faults, "write faulted");
+
+    CHECK(getrusage(RUSAGE_CHILDREN, &after), "get children's usage");
+    CHECK(after.bytes_written == 50 && after.syscalls[SYS_WRITE] == 1 &&
+              after.syscalls[SYS_EXIT] == 1,
+          "child's write and exit counted");
+
+    do {
+        for (i = 0; i < 100000; i++)
+            asm volatile("" : : : "memory");
+        getrusage(RUSAGE_SELF, &after);
+    } while (after.user_ticks == 0);
+    msg("user time counted");
+
+    CHECK(!getrusage(1, &after), "getrusage rejects bad WHO");
+}
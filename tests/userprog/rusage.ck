@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rusage) begin
+(rusage) create pipe
+(rusage) getrusage counted once
+(rusage) one write and one read counted
+(rusage) 100 bytes written and read
+(rusage) fork
+(rusage) wait for child
+rusage: exit(0)
+(rusage) write faulted
+(rusage) get children's usage
+(rusage) child's write and exit counted
+(rusage) user time counted
+(rusage) getrusage rejects bad WHO
+(rusage) end
+rusage: exit(0)
+EOF
+pass;
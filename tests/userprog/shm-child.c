@@ -0,0 +1,28 @@
+/* Shares memory with child processes, once through an anonymous
+   segment whose fd the child inherits and once through a named
+   segment that the child opens by name, and checks that we see
+   what each child wrote. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void test_main(void) {
+    char cmd[64];
+    char *anon, *named;
+    int fd;
+
+    CHECK((fd = shm_create(NULL, 1)) > 1, "create anonymous segment");
+    CHECK((anon = shm_map(fd, NULL)) != NULL, "map anonymous segment");
+    snprintf(cmd, sizeof cmd, "child-shm %d", fd);
+    CHECK(wait(exec_flags(cmd, EXEC_INHERIT_FDS)) == 0, "run \"%s\"", cmd);
+    msg("anonymous segment holds \"%s\"", anon);
+
+    CHECK((fd = shm_create("shared", 1)) > 1, "create \"shared\"");
+    CHECK((named = shm_map(fd, NULL)) != NULL, "map \"shared\"");
+    CHECK(wait(exec("child-shm shared")) == 0, "run \"child-shm shared\"");
+    msg("\"shared\" holds \"%s\"", named);
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(shm-child) begin
+(shm-child) create anonymous segment
+(shm-child) map anonymous segment
+(shm-child) run "child-shm 2"
+child-shm: exit(0)
+(shm-child) anonymous segment holds "hello from child-shm 2"
+(shm-child) create "shared"
+(shm-child) map "shared"
+(shm-child) run "child-shm shared"
+child-shm: exit(0)
+(shm-child) "shared" holds "hello from child-shm shared"
+(shm-child) end
+shm-child: exit(0)
+EOF
+pass;
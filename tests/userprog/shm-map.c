@@ -0,0 +1,49 @@
+/* Maps a shared memory segment more than once in one process,
+   at addresses of the kernel's choosing and our own, and checks
+   that every mapping shows the same memory, including after the
+   segment's fd is closed.  Also tries some bad mappings. */
+
+#include <string.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* An address far from the code, data, and stack. */
+#define FIXED_ADDR ((char *) 0x20000000)
+
+void test_main(void) {
+    char *a, *b, *c, *d;
+    int fd, fd2, fd3;
+
+    CHECK((fd = shm_create(NULL, 2)) > 1, "create anonymous segment");
+    CHECK((a = shm_map(fd, NULL)) != NULL, "map segment");
+    CHECK((b = shm_map(fd, NULL)) != NULL && b != a, "map segment again");
+    if (a[0] != 0 || a[8191] != 0)
+        fail("new segment not zeroed");
+    strlcpy(a + 4096, "shared", 7);
+    CHECK(!strcmp(b + 4096, "shared"), "second mapping sees first");
+    CHECK(shm_unmap(a), "unmap first mapping");
+    CHECK(!strcmp(b + 4096, "shared"), "second mapping survives");
+
+    CHECK(shm_map(fd, FIXED_ADDR) == FIXED_ADDR, "map at fixed address");
+    CHECK(shm_map(fd, FIXED_ADDR + 4096) == NULL, "map over mapping fails");
+    CHECK(shm_map(fd, FIXED_ADDR - 1) == NULL, "map misaligned fails");
+    CHECK(shm_map(fd, (char *) test_main - (unsigned) test_main % 4096) ==
+              NULL,
+          "map over code fails");
+    CHECK(!shm_unmap(FIXED_ADDR + 4096), "unmap middle of mapping fails");
+    CHECK(read(fd, b, 1) == -1, "read from segment fd fails");
+
+    close(fd);
+    CHECK(!strcmp(FIXED_ADDR + 4096, "shared"), "mapping survives close");
+    CHECK(shm_unmap(FIXED_ADDR), "unmap fixed mapping");
+
+    CHECK((fd2 = shm_create("seg", 1)) > 1, "create \"seg\"");
+    CHECK((fd3 = shm_create("seg", 0)) > 1 && fd3 != fd2, "open \"seg\"");
+    CHECK(shm_create("seg", 5) == -1, "open \"seg\" with wrong size fails");
+    CHECK((c = shm_map(fd2, NULL)) != NULL && (d = shm_map(fd3, NULL)) != NULL,
+          "map \"seg\" twice");
+    c[100] = 'x';
+    CHECK(d[100] == 'x', "both mappings of \"seg\" agree");
+}
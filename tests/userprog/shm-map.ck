@@ -0,0 +1,29 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(shm-map) begin
+(shm-map) create anonymous segment
+(shm-map) map segment
+(shm-map) map segment again
+(shm-map) second mapping sees first
+(shm-map) unmap first mapping
+(shm-map) second mapping survives
+(shm-map) map at fixed address
+(shm-map) map over mapping fails
+(shm-map) map misaligned fails
+(shm-map) map over code fails
+(shm-map) unmap middle of mapping fails
+(shm-map) read from segment fd fails
+(shm-map) mapping survives close
+(shm-map) unmap fixed mapping
+(shm-map) create "seg"
+(shm-map) open "seg"
+(shm-map) open "seg" with wrong size fails
+(shm-map) map "seg" twice
+(shm-map) both mappings of "seg" agree
+(shm-map) end
+shm-map: exit(0)
+EOF
+pass;
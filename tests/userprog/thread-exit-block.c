@@ -0,0 +1,44 @@
+/* Checks that the process exiting ends threads that are asleep
+   in the kernel: in a read from a pipe whose write end the
+   process itself holds, in a poll() with no timeout, and in a
+   console read.  If it didn't, this test would never finish. */
+
+#include <stdio.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* The pipe, which no thread ever writes. */
+static int fds[2];
+
+static int pipe_reader(void *aux UNUSED) {
+    char c;
+    return read(fds[0], &c, 1);
+}
+
+static int poller(void *aux UNUSED) {
+    struct pollfd pfd;
+
+    pfd.fd = fds[0];
+    pfd.events = POLLIN;
+    return poll(&pfd, 1, -1);
+}
+
+static int console_reader(void *aux UNUSED) {
+    char c;
+    return read(STDIN_FILENO, &c, 1);
+}
+
+void test_main(void) {
+    CHECK(pipe(fds), "create pipe");
+    CHECK(thread_create(pipe_reader, NULL) != TID_ERROR,
+          "start thread that reads the pipe");
+    CHECK(thread_create(poller, NULL) != TID_ERROR,
+          "start thread that polls the pipe");
+    CHECK(thread_create(console_reader, NULL) != TID_ERROR,
+          "start thread that reads the console");
+
+    /* Give the threads time to go to sleep. */
+    poll(NULL, 0, 20);
+}
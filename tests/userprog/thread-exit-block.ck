@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(thread-exit-block) begin
+(thread-exit-block) create pipe
+(thread-exit-block) start thread that reads the pipe
+(thread-exit-block) start thread that polls the pipe
+(thread-exit-block) start thread that reads the console
+(thread-exit-block) end
+thread-exit-block: exit(0)
+EOF
+pass;
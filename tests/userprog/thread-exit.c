@@ -0,0 +1,46 @@
+/* Checks that thread_exit() ends just the calling thread, and
+   that the process exiting ends threads that are still busy in
+   user code or asleep on a futex.  If it didn't, this test would
+   never finish. */
+
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Stays 0, so that waits for it to change last forever. */
+static int word;
+
+/* Exits from below the thread's first function. */
+static void NO_RETURN exit_early(int value) {
+    thread_exit(value);
+}
+
+static int exiter(void *aux UNUSED) {
+    exit_early(7);
+}
+
+static int spinner(void *aux UNUSED) {
+    while (word == 0)
+        asm volatile("" : : : "memory");
+    return 0;
+}
+
+static int sleeper(void *aux UNUSED) {
+    while (word == 0)
+        futex_wait(&word, 0);
+    return 0;
+}
+
+void test_main(void) {
+    tid_t tid;
+
+    CHECK((tid = thread_create(exiter, NULL)) != TID_ERROR,
+          "start thread that exits");
+    CHECK(thread_join(tid) == 7, "join returns 7");
+
+    CHECK(thread_create(spinner, NULL) != TID_ERROR,
+          "start thread that spins");
+    CHECK(thread_create(sleeper, NULL) != TID_ERROR,
+          "start thread that sleeps");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(thread-exit) begin
+(thread-exit) start thread that exits
+(thread-exit) join returns 7
+(thread-exit) start thread that spins
+(thread-exit) start thread that sleeps
+(thread-exit) end
+thread-exit: exit(0)
+EOF
+pass;
@@ -0,0 +1,50 @@
+/* Starts several threads that each sum part of an array, and
+   checks the sums that thread_join() returns, along with joins
+   that should fail. */
+
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define THREAD_CNT 4
+#define ELEM_CNT 4096
+
+static int array[ELEM_CNT];
+
+/* Returns the sum of the ELEM_CNT / THREAD_CNT elements of ARRAY
+   starting at the slice numbered by SLICE_. */
+static int sum_slice(void *slice_) {
+    int slice = (int) slice_;
+    int per = ELEM_CNT / THREAD_CNT;
+    int sum = 0;
+    int i;
+
+    for (i = slice * per; i < (slice + 1) * per; i++)
+        sum += array[i];
+    return sum;
+}
+
+void test_main(void) {
+    tid_t tids[THREAD_CNT];
+    int expected = 0;
+    int sum = 0;
+    int i;
+
+    for (i = 0; i < ELEM_CNT; i++) {
+        array[i] = i % 7;
+        expected += array[i];
+    }
+
+    for (i = 0; i < THREAD_CNT; i++)
+        if ((tids[i] = thread_create(sum_slice, (void *) i)) == TID_ERROR)
+            fail("thread_create %d failed", i);
+    msg("started %d threads", THREAD_CNT);
+
+    for (i = 0; i < THREAD_CNT; i++)
+        sum += thread_join(tids[i]);
+    CHECK(sum == expected, "sum of slices is %d", expected);
+
+    CHECK(thread_join(tids[0]) == -1, "second join fails");
+    CHECK(thread_join(-1) == -1, "join of bad tid fails");
+}
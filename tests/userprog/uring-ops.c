@@ -0,0 +1,56 @@
+/* Carries out each kind of operation through a shared system
+   call ring, in a single batch, and checks the results. */
+
+#include <string.h>
+#include <syscall.h>
+#include <uring.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/userprog/sample.inc"
+
+void test_main(void) {
+    static char buf[sizeof sample];
+    struct uring *ring;
+    struct uring_cqe cqe;
+    int fd, i;
+
+    CHECK((ring = uring_setup(0)) != NULL, "uring_setup");
+    CHECK(uring_setup(0) == NULL, "second uring_setup fails");
+
+    /* Open synchronously, so that we know the fd. */
+    uring_prep(ring, URING_OP_OPEN, 0, "sample.txt", 0, 0, 1);
+    CHECK(uring_submit(ring, 0) == 1, "submit open");
+    CHECK(uring_reap(ring, &cqe) && cqe.user_data == 1 && cqe.res > 1,
+          "open \"sample.txt\"");
+    fd = cqe.res;
+
+    /* Then everything else in one batch. */
+    uring_prep(ring, URING_OP_NOP, 0, NULL, 0, 0, 2);
+    uring_prep(ring, URING_OP_READ, fd, buf, 10, -1, 3);
+    uring_prep(ring, URING_OP_READ, fd, buf + 50, sizeof sample - 51, 50, 4);
+    uring_prep(ring, URING_OP_SEEK, fd, NULL, 0, 10, 5);
+    uring_prep(ring, URING_OP_READ, fd, buf + 10, 40, -1, 6);
+    uring_prep(ring, URING_OP_CLOSE, fd, NULL, 0, 0, 7);
+    uring_prep(ring, URING_OP_READ, fd, buf, 10, -1, 8);
+    uring_prep(ring, URING_OP_WRITE, 1, "", 0, -1, 9);
+    CHECK(uring_submit(ring, 0) == 8, "submit 8 operations");
+
+    for (i = 2; i <= 9; i++) {
+        static const int expected[] = {0, 10, sizeof sample - 51, 0, 40,
+                                       0, -1, 0};
+
+        if (!uring_reap(ring, &cqe))
+            fail("missing completion %d", i);
+        if (cqe.user_data != (unsigned) i)
+            fail("completion %d has user_data %u", i, cqe.user_data);
+        if (cqe.res != expected[i - 2])
+            fail("operation %d returned %d, expected %d", i, cqe.res,
+                 expected[i - 2]);
+    }
+    CHECK(!uring_reap(ring, &cqe), "no more completions");
+
+    if (memcmp(buf, sample, sizeof sample - 1))
+        fail("read wrong data");
+    msg("read right data");
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(uring-ops) begin
+(uring-ops) uring_setup
+(uring-ops) second uring_setup fails
+(uring-ops) submit open
+(uring-ops) open "sample.txt"
+(uring-ops) submit 8 operations
+(uring-ops) no more completions
+(uring-ops) read right data
+(uring-ops) end
+uring-ops: exit(0)
+EOF
+pass;
@@ -0,0 +1,56 @@
+/* Has a ring's polling thread read a file in many small pieces,
+   in batches, and checks the data.  Then lets the thread go to
+   sleep, and checks that a submission wakes it. */
+
+#include <string.h>
+#include <syscall.h>
+#include <uring.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/userprog/sample.inc"
+
+/* Bytes read by each operation. */
+#define PIECE 7
+
+void test_main(void) {
+    static char buf[sizeof sample];
+    struct uring *ring;
+    struct uring_cqe cqe;
+    size_t ofs;
+    int fd, reaped = 0, queued = 0;
+
+    CHECK((ring = uring_setup(URING_SETUP_POLL)) != NULL, "uring_setup");
+    if (!(ring->setup_flags & URING_SETUP_POLL))
+        fail("no polling thread");
+    CHECK((fd = open("sample.txt")) > 1, "open \"sample.txt\"");
+
+    for (ofs = 0; ofs < sizeof sample - 1; ofs += PIECE) {
+        size_t len = sizeof sample - 1 - ofs < PIECE ? sizeof sample - 1 - ofs
+                                                     : PIECE;
+        while (!uring_prep(ring, URING_OP_READ, fd, buf + ofs, len, ofs, ofs))
+            uring_submit(ring, 1);
+        queued++;
+    }
+    uring_submit(ring, queued);
+    while (uring_reap(ring, &cqe)) {
+        if (cqe.res <= 0)
+            fail("read at offset %u failed", cqe.user_data);
+        reaped++;
+    }
+    while (reaped < queued) {
+        uring_submit(ring, 1);
+        while (uring_reap(ring, &cqe))
+            reaped++;
+    }
+    if (memcmp(buf, sample, sizeof sample - 1))
+        fail("read wrong data");
+    msg("read %d pieces", queued);
+
+    /* Give the polling thread time to fall asleep. */
+    while (!(ring->flags & URING_NEED_WAKEUP))
+        tell(fd);
+    uring_prep(ring, URING_OP_NOP, 0, NULL, 0, 0, 0);
+    uring_submit(ring, 1);
+    CHECK(uring_reap(ring, &cqe) && cqe.res == 0, "wake up polling thread");
+}
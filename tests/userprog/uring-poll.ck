@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(uring-poll) begin
+(uring-poll) uring_setup
+(uring-poll) open "sample.txt"
+(uring-poll) read 35 pieces
+(uring-poll) wake up polling thread
+(uring-poll) end
+uring-poll: exit(0)
+EOF
+pass;
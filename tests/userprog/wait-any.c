@@ -0,0 +1,48 @@
+/* Forks children that exit in the opposite order from the one
+   they were started in, and checks that wait_any() reaps them in
+   the order they exit, that a child that fails to load is never
+   returned, and that wait_any_timeout() gives up when no child
+   exits in time. */
+
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Number of children reaped by wait_any(). */
+#define CHILD_CNT 3
+
+/* Forks a child that sleeps for MS milliseconds, then exits with
+   STATUS.  Returns the child's pid. */
+static pid_t fork_sleeper(int ms, int status) {
+    pid_t pid = fork();
+
+    if (pid == 0) {
+        poll(NULL, 0, ms);
+        exit(status);
+    }
+    if (pid == PID_ERROR)
+        fail("fork failed");
+    return pid;
+}
+
+void test_main(void) {
+    pid_t pids[CHILD_CNT];
+    pid_t pid;
+    int status;
+    int i;
+
+    for (i = 0; i < CHILD_CNT; i++)
+        pids[i] = fork_sleeper((CHILD_CNT - i) * 200, i);
+    CHECK(wait_any_timeout(&status, 0) == 0, "no child has exited yet");
+    for (i = CHILD_CNT - 1; i >= 0; i--)
+        CHECK(wait_any(&status) == pids[i] && status == i,
+              "child %d exits next", i);
+    CHECK(wait_any(&status) == PID_ERROR, "no children left");
+    CHECK(exec("no-such-file") == PID_ERROR, "exec missing program");
+    CHECK(wait_any(&status) == PID_ERROR, "still no children");
+
+    pid = fork_sleeper(1000, CHILD_CNT);
+    CHECK(wait_any_timeout(&status, 100) == 0, "wait times out");
+    CHECK(wait_any_timeout(NULL, -1) == pid, "wait for last child");
+}
@@ -0,0 +1,24 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(wait-any) begin
+(wait-any) no child has exited yet
+(wait-any) child 2 exits next
+wait-any: exit(2)
+(wait-any) child 1 exits next
+wait-any: exit(1)
+(wait-any) child 0 exits next
+wait-any: exit(0)
+(wait-any) no children left
+load: no-such-file: open failed
+(wait-any) exec missing program
+(wait-any) still no children
+(wait-any) wait times out
+(wait-any) wait for last child
+wait-any: exit(3)
+(wait-any) end
+wait-any: exit(0)
+EOF
+pass;
@@ -0,0 +1,46 @@
+/* Reads 128 kB from the pipe whose fd is given as the first
+   argument into static data and "sorts" the bytes in it, using
+   counting sort, a single-pass algorithm.  The sorted data is
+   written to the pipe whose fd is given as the second
+   argument. */
+
+#include <debug.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Page-aligned so that the pipes can pass it a whole page at a
+   time. */
+unsigned char buf[128 * 1024] __attribute__((aligned(4096)));
+size_t histogram[256];
+
+int main(int argc UNUSED, char *argv[]) {
+    int in_fd, out_fd;
+    unsigned char *p;
+    size_t size;
+    size_t i;
+    int n;
+
+    test_name = "child-sort-pipe";
+    quiet = true;
+
+    in_fd = atoi(argv[1]);
+    out_fd = atoi(argv[2]);
+
+    for (size = 0; size < sizeof buf; size += n)
+        CHECK((n = read(in_fd, buf + size, sizeof buf - size)) > 0,
+              "read from pipe");
+    for (i = 0; i < size; i++)
+        histogram[buf[i]]++;
+    p = buf;
+    for (i = 0; i < sizeof histogram / sizeof *histogram; i++) {
+        size_t j = histogram[i];
+        while (j-- > 0)
+            *p++ = i;
+    }
+    CHECK(write(out_fd, buf, size) == (int) size, "write to pipe");
+
+    return 123;
+}
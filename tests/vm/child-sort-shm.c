@@ -0,0 +1,37 @@
+/* Maps the shared memory segment whose fd is given as the first
+   argument and "sorts" the 128 kB of it that start at the offset
+   given as the second argument, in place, using counting sort, a
+   single-pass algorithm. */
+
+#include <debug.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHUNK_SIZE (128 * 1024)
+
+size_t histogram[256];
+
+int main(int argc UNUSED, char *argv[]) {
+    unsigned char *data, *p;
+    size_t i;
+
+    test_name = "child-sort-shm";
+    quiet = true;
+
+    CHECK((data = shm_map(atoi(argv[1]), NULL)) != NULL, "map segment");
+    data += atoi(argv[2]);
+
+    for (i = 0; i < CHUNK_SIZE; i++)
+        histogram[data[i]]++;
+    p = data;
+    for (i = 0; i < sizeof histogram / sizeof *histogram; i++) {
+        size_t j = histogram[i];
+        while (j-- > 0)
+            *p++ = i;
+    }
+
+    return 123;
+}
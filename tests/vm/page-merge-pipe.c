@@ -0,0 +1,6 @@
+#include "tests/main.h"
+#include "tests/vm/parallel-merge.h"
+
+void test_main(void) {
+    parallel_merge_pipe("child-sort-pipe", 123);
+}
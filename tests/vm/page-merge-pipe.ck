@@ -0,0 +1,29 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-merge-pipe) begin
+(page-merge-pipe) init
+(page-merge-pipe) sort chunk 0
+(page-merge-pipe) sort chunk 1
+(page-merge-pipe) sort chunk 2
+(page-merge-pipe) sort chunk 3
+(page-merge-pipe) sort chunk 4
+(page-merge-pipe) sort chunk 5
+(page-merge-pipe) sort chunk 6
+(page-merge-pipe) sort chunk 7
+(page-merge-pipe) wait for child 0
+(page-merge-pipe) wait for child 1
+(page-merge-pipe) wait for child 2
+(page-merge-pipe) wait for child 3
+(page-merge-pipe) wait for child 4
+(page-merge-pipe) wait for child 5
+(page-merge-pipe) wait for child 6
+(page-merge-pipe) wait for child 7
+(page-merge-pipe) merge
+(page-merge-pipe) verify
+(page-merge-pipe) success, buf_idx=1,048,576
+(page-merge-pipe) end
+EOF
+pass;
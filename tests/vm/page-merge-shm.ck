@@ -0,0 +1,31 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-merge-shm) begin
+(page-merge-shm) create segment
+(page-merge-shm) map segment
+(page-merge-shm) init
+(page-merge-shm) sort chunk 0
+(page-merge-shm) sort chunk 1
+(page-merge-shm) sort chunk 2
+(page-merge-shm) sort chunk 3
+(page-merge-shm) sort chunk 4
+(page-merge-shm) sort chunk 5
+(page-merge-shm) sort chunk 6
+(page-merge-shm) sort chunk 7
+(page-merge-shm) wait for child 0
+(page-merge-shm) wait for child 1
+(page-merge-shm) wait for child 2
+(page-merge-shm) wait for child 3
+(page-merge-shm) wait for child 4
+(page-merge-shm) wait for child 5
+(page-merge-shm) wait for child 6
+(page-merge-shm) wait for child 7
+(page-merge-shm) merge
+(page-merge-shm) verify
+(page-merge-shm) success, buf_idx=1,048,576
+(page-merge-shm) end
+EOF
+pass;
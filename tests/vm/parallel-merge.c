@@ -16,21 +16,24 @@
 #define CHUNK_CNT 8 /* Number of chunks. */
 #define DATA_SIZE (CHUNK_CNT * CHUNK_SIZE) /* Buffer size. */
 
-unsigned char buf1[DATA_SIZE], buf2[DATA_SIZE];
+/* BUF1 is page-aligned so that pipes can pass its chunks a
+   whole page at a time. */
+unsigned char buf1[DATA_SIZE] __attribute__((aligned(4096)));
+unsigned char buf2[DATA_SIZE];
 size_t histogram[256];
 
-/* Initialize buf1 with random data,
+/* Initialize DATA, which is DATA_SIZE bytes, with random data,
    then count the number of instances of each value within it. */
-static void init(void) {
+static void init(unsigned char *data) {
     struct arc4 arc4;
     size_t i;
 
     msg("init");
 
     arc4_init(&arc4, "foobar", 6);
-    arc4_crypt(&arc4, buf1, sizeof buf1);
-    for (i = 0; i < sizeof buf1; i++)
-        histogram[buf1[i]]++;
+    arc4_crypt(&arc4, data, DATA_SIZE);
+    for (i = 0; i < DATA_SIZE; i++)
+        histogram[data[i]]++;
 }
 
 /* Sort each chunk of buf1 using SUBPROCESS,
@@ -76,8 +79,88 @@ static void sort_chunks(const char *subprocess, int exit_status) {
     }
 }
 
-/* Merge the sorted chunks in buf1 into a fully sorted buf2. */
-static void merge(void) {
+/* Sort each chunk of buf1 using SUBPROCESS, which is expected
+   to return EXIT_STATUS, as in sort_chunks(), but pass each
+   chunk to the subprocess through a pipe and read it back
+   through another one, instead of going through a file. */
+static void sort_chunks_pipe(const char *subprocess, int exit_status) {
+    pid_t children[CHUNK_CNT];
+    int results[CHUNK_CNT];
+    size_t i;
+
+    for (i = 0; i < CHUNK_CNT; i++) {
+        int to_child[2], from_child[2];
+        char cmd[128];
+
+        msg("sort chunk %zu", i);
+
+        /* Start the subprocess with our end of each pipe too, but
+           it reads and writes exactly a chunk, so it never waits
+           for end of file. */
+        quiet = true;
+        CHECK(pipe(to_child) && pipe(from_child), "create pipes");
+        snprintf(cmd, sizeof cmd, "%s %d %d", subprocess, to_child[0],
+                 from_child[1]);
+        CHECK((children[i] = exec_flags(cmd, EXEC_INHERIT_FDS)) != -1,
+              "exec \"%s\"", cmd);
+        close(to_child[0]);
+        close(from_child[1]);
+
+        /* Write this chunk to the pipe. */
+        CHECK(write(to_child[1], buf1 + CHUNK_SIZE * i, CHUNK_SIZE) ==
+                  CHUNK_SIZE,
+              "write chunk %zu", i);
+        close(to_child[1]);
+        results[i] = from_child[0];
+        quiet = false;
+    }
+
+    for (i = 0; i < CHUNK_CNT; i++) {
+        size_t ofs;
+        int n;
+
+        /* Read the sorted chunk back from the pipe.  The
+           subprocess can't exit until it has written all of it. */
+        quiet = true;
+        for (ofs = 0; ofs < CHUNK_SIZE; ofs += n)
+            CHECK((n = read(results[i], buf1 + CHUNK_SIZE * i + ofs,
+                            CHUNK_SIZE - ofs)) > 0,
+                  "read chunk %zu", i);
+        close(results[i]);
+        quiet = false;
+
+        CHECK(wait(children[i]) == exit_status, "wait for child %zu", i);
+    }
+}
+
+/* Sort each chunk of the shared memory segment open as SEGMENT
+   in place, using SUBPROCESS, which is expected to return
+   EXIT_STATUS.  Each subprocess maps the segment itself, so no
+   data is copied at all. */
+static void sort_chunks_shm(const char *subprocess, int exit_status,
+                            int segment) {
+    pid_t children[CHUNK_CNT];
+    size_t i;
+
+    for (i = 0; i < CHUNK_CNT; i++) {
+        char cmd[128];
+
+        msg("sort chunk %zu", i);
+
+        quiet = true;
+        snprintf(cmd, sizeof cmd, "%s %d %zu", subprocess, segment,
+                 CHUNK_SIZE * i);
+        CHECK((children[i] = exec_flags(cmd, EXEC_INHERIT_FDS)) != -1,
+              "exec \"%s\"", cmd);
+        quiet = false;
+    }
+
+    for (i = 0; i < CHUNK_CNT; i++)
+        CHECK(wait(children[i]) == exit_status, "wait for child %zu", i);
+}
+
+/* Merge the sorted chunks in DATA into a fully sorted buf2. */
+static void merge(unsigned char *data) {
     unsigned char *mp[CHUNK_CNT];
     size_t mp_left;
     unsigned char *op;
@@ -88,7 +171,7 @@ static void merge(void) {
     /* Initialize merge pointers. */
     mp_left = CHUNK_CNT;
     for (i = 0; i < CHUNK_CNT; i++)
-        mp[i] = buf1 + CHUNK_SIZE * i;
+        mp[i] = data + CHUNK_SIZE * i;
 
     /* Merge. */
     op = buf2;
@@ -104,7 +187,7 @@ static void merge(void) {
 
         /* Advance merge pointer.
            Delete this chunk from the set if it's emptied. */
-        if ((++mp[min] - buf1) % CHUNK_SIZE == 0)
+        if ((++mp[min] - data) % CHUNK_SIZE == 0)
             mp[min] = mp[--mp_left];
     }
 }
@@ -129,8 +212,33 @@ static void verify(void) {
 }
 
 void parallel_merge(const char *child_name, int exit_status) {
-    init();
+    init(buf1);
     sort_chunks(child_name, exit_status);
-    merge();
+    merge(buf1);
+    verify();
+}
+
+/* Like parallel_merge(), but CHILD_NAME reads its chunk from
+   one pipe and writes the sorted chunk to another. */
+void parallel_merge_pipe(const char *child_name, int exit_status) {
+    init(buf1);
+    sort_chunks_pipe(child_name, exit_status);
+    merge(buf1);
+    verify();
+}
+
+/* Like parallel_merge(), but the data lives in an anonymous
+   shared memory segment instead of buf1, and CHILD_NAME sorts
+   its chunk of the segment in place. */
+void parallel_merge_shm(const char *child_name, int exit_status) {
+    unsigned char *data;
+    int segment;
+
+    CHECK((segment = shm_create(NULL, DATA_SIZE / 4096)) > 1,
+          "create segment");
+    CHECK((data = shm_map(segment, NULL)) != NULL, "map segment");
+    init(data);
+    sort_chunks_shm(child_name, exit_status, segment);
+    merge(data);
     verify();
 }
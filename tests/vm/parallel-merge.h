@@ -2,5 +2,7 @@
 #define TESTS_VM_PARALLEL_MERGE 1
 
 void parallel_merge(const char *child_name, int exit_status);
+void parallel_merge_pipe(const char *child_name, int exit_status);
+void parallel_merge_shm(const char *child_name, int exit_status);
 
 #endif /* tests/vm/parallel-merge.h */
@@ -0,0 +1,92 @@
+#ifndef THREADS_CPU_H
+#define THREADS_CPU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Functions for querying and controlling x86 processor
+   features that are not tied to a particular device.
+
+   See [IA32-v2a] "CPUID" and [IA32-v3a] 2.5 "Control
+   Registers". */
+
+/* Feature flags reported in EDX by CPUID leaf 1. */
+#define CPUID_PSE (1u << 3) /* 4 MB pages (CR4.PSE). */
+#define CPUID_TSC (1u << 4) /* Time-stamp counter (RDTSC). */
+#define CPUID_SEP (1u << 11) /* SYSENTER and SYSEXIT. */
+#define CPUID_PGE (1u << 13) /* Global pages (CR4.PGE). */
+
+/* Flags in control register 4. */
+#define CR4_PSE 0x00000010 /* Page Size Extensions. */
+#define CR4_PGE 0x00000080 /* Page Global Enable. */
+
+/* Model-specific registers. */
+#define MSR_SYSENTER_CS 0x174 /* SYSENTER target code segment. */
+#define MSR_SYSENTER_ESP 0x175 /* SYSENTER target stack pointer. */
+#define MSR_SYSENTER_EIP 0x176 /* SYSENTER target instruction. */
+
+/* Executes CPUID with EAX set to LEAF and stores the resulting
+   EAX, EBX, ECX, and EDX into the corresponding arguments. */
+static inline void cpuid(uint32_t leaf, uint32_t *eax, uint32_t *ebx,
+                         uint32_t *ecx, uint32_t *edx) {
+    /* See [IA32-v2a] "CPUID". */
+    asm volatile("cpuid"
+                 : "=a"(*eax), "=b"(*ebx), "=c"(*ecx), "=d"(*edx)
+                 : "a"(leaf), "c"(0));
+}
+
+/* Returns true if CPUID leaf 1 reports all of the FEATURES
+   bits (CPUID_*) in EDX, false otherwise. */
+static inline bool cpu_has_features(uint32_t features) {
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(1, &eax, &ebx, &ecx, &edx);
+    return (edx & features) == features;
+}
+
+/* Returns true if the CPU supports SYSENTER and SYSEXIT, false
+   otherwise.  Early Pentium Pro processors report CPUID_SEP
+   without actually supporting the instructions.  See [IA32-v2b]
+   "SYSENTER". */
+static inline bool cpu_has_sysenter(void) {
+    uint32_t eax, ebx, ecx, edx;
+    uint32_t family, model, stepping;
+
+    cpuid(1, &eax, &ebx, &ecx, &edx);
+    family = (eax >> 8) & 0xf;
+    model = (eax >> 4) & 0xf;
+    stepping = eax & 0xf;
+    return (edx & CPUID_SEP) != 0 &&
+           !(family == 6 && model < 3 && stepping < 3);
+}
+
+/* Stores VALUE into model-specific register MSR. */
+static inline void wrmsr(uint32_t msr, uint64_t value) {
+    /* See [IA32-v2b] "WRMSR". */
+    asm volatile("wrmsr" : : "c"(msr), "A"(value));
+}
+
+/* Returns the value of control register 4. */
+static inline uint32_t cr4_read(void) {
+    /* See [IA32-v2a] "MOV--Move to/from Control Registers". */
+    uint32_t cr4;
+    asm volatile("movl %%cr4, %0" : "=r"(cr4));
+    return cr4;
+}
+
+/* Stores CR4 into control register 4. */
+static inline void cr4_write(uint32_t cr4) {
+    /* See [IA32-v2a] "MOV--Move to/from Control Registers". */
+    asm volatile("movl %0, %%cr4" : : "r"(cr4) : "memory");
+}
+
+/* Returns the processor's time-stamp counter, which counts
+   clock cycles since reset.  Only meaningful if the CPU reports
+   CPUID_TSC. */
+static inline uint64_t rdtsc(void) {
+    /* See [IA32-v2b] "RDTSC". */
+    uint64_t tsc;
+    asm volatile("rdtsc" : "=A"(tsc));
+    return tsc;
+}
+
+#endif /* threads/cpu.h */
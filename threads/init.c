@@ -17,17 +17,23 @@
 #include "devices/shutdown.h"
 #include "devices/timer.h"
 #include "devices/vga.h"
+#include "threads/cpu.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/loader.h"
 #include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/pte.h"
+#include "threads/schedtrace.h"
 #include "threads/thread.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/exception.h"
+#include "userprog/futex.h"
 #include "userprog/gdt.h"
+#include "userprog/pagedir.h"
 #include "userprog/process.h"
+#include "userprog/shm.h"
 #include "userprog/syscall.h"
 #include "userprog/tss.h"
 #else
@@ -59,6 +65,9 @@ static const char *swap_bdev_name;
 /* -ul: Maximum number of pages to put into palloc's user pool. */
 static size_t user_page_limit = SIZE_MAX;
 
+/* -nopse: Map kernel memory with 4 kB pages only? */
+static bool small_pages_only;
+
 static void bss_init(void);
 static void paging_init(void);
 
@@ -111,10 +120,18 @@ int main(void) {
 #ifdef USERPROG
     exception_init();
     syscall_init();
+    pagedir_init();
+    process_init();
+    shm_init();
+    futex_init();
 #endif
 
     /* Start thread scheduler and enable interrupts. */
     thread_start();
+    workqueue_init();
+#ifdef USERPROG
+    pagedir_start_reaper();
+#endif
     serial_init_queue();
     timer_calibrate();
 
@@ -149,11 +166,26 @@ static void bss_init(void) {
 /* Populates the base page directory and page table with the
    kernel virtual mapping, and then sets up the CPU to use the
    new page directory.  Points init_page_dir to the page
-   directory it creates. */
+   directory it creates.
+
+   Every process's page directory shares these kernel page
+   tables (see pagedir_create()), so the kernel mappings are
+   identical in all address spaces.  If the CPU supports it, we
+   mark them global so that they stay in the TLB when CR3 is
+   reloaded on a switch between processes.
+
+   Where the CPU supports 4 MB pages, each 4 MB region of RAM
+   that lies wholly in RAM and contains no kernel text is mapped
+   by a single large page instead of a page table, so the kernel
+   direct map consumes far fewer TLB entries.  The region that
+   holds the kernel text keeps 4 kB pages because the text must
+   be mapped read-only. */
 static void paging_init(void) {
     uint32_t *pd, *pt;
     size_t page;
     extern char _start, _end_kernel_text;
+    bool global = cpu_has_features(CPUID_PGE);
+    bool large = !small_pages_only && cpu_has_features(CPUID_PSE);
 
     pd = init_page_dir = palloc_get_page(PAL_ASSERT | PAL_ZERO);
     pt = NULL;
@@ -164,20 +196,43 @@ static void paging_init(void) {
         size_t pte_idx = pt_no(vaddr);
         bool in_kernel_text = &_start <= vaddr && vaddr < &_end_kernel_text;
 
+        if (large && pte_idx == 0 && page + PTSPAN / PGSIZE <= init_ram_pages &&
+            (vaddr + PTSPAN <= &_start || vaddr >= &_end_kernel_text)) {
+            pd[pde_idx] = pde_create_large(vaddr, true);
+            if (global)
+                pd[pde_idx] |= PTE_G;
+            page += PTSPAN / PGSIZE - 1;
+            continue;
+        }
+
         if (pd[pde_idx] == 0) {
             pt = palloc_get_page(PAL_ASSERT | PAL_ZERO);
             pd[pde_idx] = pde_create(pt);
         }
 
         pt[pte_idx] = pte_create_kernel(vaddr, !in_kernel_text);
+        if (global)
+            pt[pte_idx] |= PTE_G;
     }
 
+    /* Large pages must be enabled before the CPU walks a page
+       directory that contains them.  The loader's page tables,
+       which are active now, don't use PTE_PS. */
+    if (large)
+        cr4_write(cr4_read() | CR4_PSE);
+
     /* Store the physical address of the page directory into CR3
        aka PDBR (page directory base register).  This activates our
        new page tables immediately.  See [IA32-v2a] "MOV--Move
        to/from Control Registers" and [IA32-v3a] 3.7.5 "Base Address
        of the Page Directory". */
     asm volatile("movl %0, %%cr3" : : "r"(vtop(init_page_dir)));
+
+    /* Now that no stale loader mappings can be marked global,
+       honor PTE_G.  See [IA32-v3a] 3.12 "Translation Lookaside
+       Buffers (TLBs)". */
+    if (global)
+        cr4_write(cr4_read() | CR4_PGE);
 }
 
 /* Breaks the kernel command line into words and returns them as
@@ -242,9 +297,17 @@ static char **parse_options(char **argv) {
             random_init(atoi(value));
         else if (!strcmp(name, "-mlfqs"))
             thread_mlfqs = true;
+        else if (!strcmp(name, "-nopse"))
+            small_pages_only = true;
+        else if (!strcmp(name, "-schedtrace"))
+            schedtrace_enabled = cpu_has_features(CPUID_TSC);
+        else if (!strcmp(name, "-tcache"))
+            thread_cache_max = atoi(value);
 #ifdef USERPROG
         else if (!strcmp(name, "-ul"))
             user_page_limit = atoi(value);
+        else if (!strcmp(name, "-ru"))
+            process_print_usage = true;
 #endif
         else
             PANIC("unknown option `%s' (use -h for help)", name);
@@ -269,13 +332,25 @@ static void run_task(char **argv) {
 
     printf("Executing '%s':\n", task);
 #ifdef USERPROG
-    process_wait(process_execute(task));
+    process_wait(process_execute(task, 0));
 #else
     run_test(task);
 #endif
     printf("Execution of '%s' complete.\n", task);
 }
 
+/* Prints statistics from the scheduler trace. */
+static void run_schedtrace(char **argv UNUSED) {
+    schedtrace_print_stats();
+}
+
+#ifdef FILESYS
+/* Writes the scheduler trace to the scratch device. */
+static void run_schedtrace_dump(char **argv UNUSED) {
+    schedtrace_dump();
+}
+#endif
+
 /* Executes all of the actions specified in ARGV[]
    up to the null pointer sentinel. */
 static void run_actions(char **argv) {
@@ -289,7 +364,9 @@ static void run_actions(char **argv) {
     /* Table of supported actions. */
     static const struct action actions[] = {
         {"run", 2, run_task},
+        {"schedtrace", 1, run_schedtrace},
 #ifdef FILESYS
+        {"schedtrace-dump", 1, run_schedtrace_dump},
         {"ls", 1, fsutil_ls},
         {"cat", 2, fsutil_cat},
         {"rm", 2, fsutil_rm},
@@ -334,6 +411,7 @@ static void usage(void) {
 #else
            "  run TEST           Run TEST.\n"
 #endif
+           "  schedtrace         Print scheduler trace statistics.\n"
 #ifdef FILESYS
            "  ls                 List files in the root directory.\n"
            "  cat FILE           Print FILE to the console.\n"
@@ -341,6 +419,7 @@ static void usage(void) {
            "Use these actions indirectly via `pintos' -g and -p options:\n"
            "  extract            Untar from scratch device into file system.\n"
            "  append FILE        Append FILE to tar file on scratch device.\n"
+           "  schedtrace-dump    Write scheduler trace to scratch device.\n"
 #endif
            "\nOptions:\n"
            "  -h                 Print this help message and power off.\n"
@@ -356,8 +435,12 @@ static void usage(void) {
 #endif
            "  -rs=SEED           Set random number seed to SEED.\n"
            "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+           "  -nopse             Map kernel memory with 4 kB pages only.\n"
+           "  -schedtrace        Record scheduler events for analysis.\n"
+           "  -tcache=COUNT      Cache up to COUNT free thread pages.\n"
 #ifdef USERPROG
            "  -ul=COUNT          Limit user memory to COUNT pages.\n"
+           "  -ru                Print resource usage as processes exit.\n"
 #endif
     );
     shutdown_power_off();
@@ -11,6 +11,10 @@
 #include "threads/io.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
+#ifdef USERPROG
+#include "userprog/gdt.h"
+#include "userprog/process.h"
+#endif
 
 /* Programmable Interrupt Controller (PIC) registers.
    A PC has two PICs, called the master and slave PICs, with the
@@ -350,6 +354,12 @@ void intr_handler(struct intr_frame *frame) {
         if (yield_on_return)
             thread_yield();
     }
+
+#ifdef USERPROG
+    /* Don't go back to user code in a process that is exiting. */
+    if (frame->cs == SEL_UCSEG)
+        process_check_exit();
+#endif
 }
 
 /* Handles an unexpected interrupt with interrupt frame F.  An
@@ -0,0 +1,213 @@
+#include "threads/lockstat.h"
+
+#include <debug.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "threads/cpu.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+
+/* Maximum number of lock classes.  Locks initialized after the
+   table fills up are not profiled. */
+#define CLASS_CNT LOCKSTAT_CLASS_MAX
+
+/* Number of classes printed at shutdown. */
+#define TOP_CNT 10
+
+/* Lock classes.  Classes are never removed, because locks of a
+   class may be created and destroyed many times, and their names
+   are expected to be string literals. */
+static struct lock_class classes[CLASS_CNT];
+static size_t class_cnt;
+
+/* Sorted copy of CLASSES, for reporting. */
+static struct lock_class snapshot[CLASS_CNT];
+
+/* Does the CPU have a time-stamp counter?  If not, no lock
+   gets a class and nothing is profiled. */
+static enum { TSC_UNKNOWN, TSC_ABSENT, TSC_PRESENT } tsc_state;
+
+static int compare_by_wait(const void *, const void *);
+static size_t sorted_snapshot(void);
+
+/* Returns the class named NAME, creating it if necessary, or a
+   null pointer if profiling is unavailable or there is no room
+   for another class. */
+struct lock_class *lockstat_class(const char *name) {
+    struct lock_class *c = NULL;
+    enum intr_level old_level;
+    size_t i;
+
+    ASSERT(name != NULL);
+
+    old_level = intr_disable();
+    if (tsc_state == TSC_UNKNOWN)
+        tsc_state = cpu_has_features(CPUID_TSC) ? TSC_PRESENT : TSC_ABSENT;
+    if (tsc_state == TSC_PRESENT) {
+        for (i = 0; i < class_cnt; i++)
+            if (classes[i].name == name || !strcmp(classes[i].name, name)) {
+                c = &classes[i];
+                break;
+            }
+        if (c == NULL && class_cnt < CLASS_CNT) {
+            c = &classes[class_cnt++];
+            c->name = name;
+        }
+    }
+    intr_set_level(old_level);
+
+    return c;
+}
+
+/* Downs LOCK's semaphore on behalf of lock_acquire(), timing the
+   wait if the lock is contended, and accounts for the
+   acquisition in LOCK's class, which must not be null. */
+void lockstat_acquire(struct lock *lock) {
+    struct lock_class *c = lock->class;
+    enum intr_level old_level;
+    uint64_t wait = 0;
+    bool contended = false;
+
+    ASSERT(c != NULL);
+
+    if (!sema_try_down(&lock->semaphore)) {
+        uint64_t start = rdtsc();
+        sema_down(&lock->semaphore);
+        wait = rdtsc() - start;
+        contended = true;
+    }
+
+    /* Other locks in the class may be used concurrently. */
+    old_level = intr_disable();
+    c->acquire_cnt++;
+    if (contended) {
+        c->contended_cnt++;
+        c->wait_cycles += wait;
+        if (wait > c->max_wait_cycles)
+            c->max_wait_cycles = wait;
+    }
+    intr_set_level(old_level);
+
+    lock->acquire_tsc = rdtsc();
+}
+
+/* Accounts for an uncontended acquisition of LOCK, whose class
+   must not be null, by lock_try_acquire(). */
+void lockstat_acquired(struct lock *lock) {
+    enum intr_level old_level;
+
+    ASSERT(lock->class != NULL);
+
+    old_level = intr_disable();
+    lock->class->acquire_cnt++;
+    intr_set_level(old_level);
+
+    lock->acquire_tsc = rdtsc();
+}
+
+/* Accounts for the time LOCK, whose class must not be null, was
+   held.  Called by lock_release() just before releasing it. */
+void lockstat_release(struct lock *lock) {
+    uint64_t held = rdtsc() - lock->acquire_tsc;
+    enum intr_level old_level;
+
+    ASSERT(lock->class != NULL);
+
+    old_level = intr_disable();
+    lock->class->hold_cycles += held;
+    intr_set_level(old_level);
+}
+
+/* Stores statistics for up to MAX_CNT lock classes into STATS,
+   most waited-on first, and returns the number stored.  STATS
+   must be in kernel memory. */
+size_t lockstat_get(struct lockstat *stats, size_t max_cnt) {
+    enum intr_level old_level;
+    size_t cnt, i;
+
+    old_level = intr_disable();
+    cnt = sorted_snapshot();
+    if (cnt > max_cnt)
+        cnt = max_cnt;
+    for (i = 0; i < cnt; i++) {
+        const struct lock_class *c = &snapshot[i];
+        struct lockstat *s = &stats[i];
+
+        strlcpy(s->name, c->name, sizeof s->name);
+        s->acquire_cnt = c->acquire_cnt;
+        s->contended_cnt = c->contended_cnt;
+        s->wait_cycles = c->wait_cycles;
+        s->max_wait_cycles = c->max_wait_cycles;
+        s->hold_cycles = c->hold_cycles;
+    }
+    intr_set_level(old_level);
+
+    return cnt;
+}
+
+/* Prints the lock classes with the most total wait time. */
+void lockstat_print_stats(void) {
+    enum intr_level old_level;
+    size_t cnt, i;
+
+    if (tsc_state != TSC_PRESENT)
+        return;
+
+    /* Printing acquires the console lock, so we can't keep
+       interrupts off.  This is only called at shutdown, when
+       nothing else will overwrite SNAPSHOT. */
+    old_level = intr_disable();
+    cnt = sorted_snapshot();
+    intr_set_level(old_level);
+    if (cnt > TOP_CNT)
+        cnt = TOP_CNT;
+
+    printf("Locks: %-24s %10s %10s %12s %12s %12s\n", "class", "acquired",
+           "contended", "wait cycles", "max wait", "hold cycles");
+    for (i = 0; i < cnt; i++) {
+        const struct lock_class *c = &snapshot[i];
+        const char *name = c->name;
+
+        /* Call-site names come from __FILE__, which has a
+           "../../" prefix in the build directory. */
+        while (name[0] == '.' && name[1] == '.' && name[2] == '/')
+            name += 3;
+        printf("Locks: %-24s %10" PRIu64 " %10" PRIu64 " %12" PRIu64
+               " %12" PRIu64 " %12" PRIu64 "\n",
+               name, c->acquire_cnt, c->contended_cnt, c->wait_cycles,
+               c->max_wait_cycles, c->hold_cycles);
+    }
+}
+
+/* Copies the classes that have been acquired at least once into
+   SNAPSHOT, sorted with the most waited-on first, and returns
+   the number copied.  Interrupts must be off. */
+static size_t sorted_snapshot(void) {
+    size_t cnt = 0, i;
+
+    ASSERT(intr_get_level() == INTR_OFF);
+
+    for (i = 0; i < class_cnt; i++)
+        if (classes[i].acquire_cnt > 0)
+            snapshot[cnt++] = classes[i];
+    qsort(snapshot, cnt, sizeof *snapshot, compare_by_wait);
+    return cnt;
+}
+
+/* qsort() comparison function that orders lock classes by
+   descending total wait time, then by descending acquisition
+   count. */
+static int compare_by_wait(const void *a_, const void *b_) {
+    const struct lock_class *a = a_;
+    const struct lock_class *b = b_;
+
+    if (a->wait_cycles != b->wait_cycles)
+        return a->wait_cycles > b->wait_cycles ? -1 : 1;
+    if (a->acquire_cnt != b->acquire_cnt)
+        return a->acquire_cnt > b->acquire_cnt ? -1 : 1;
+    return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef THREADS_LOCKSTAT_H
+#define THREADS_LOCKSTAT_H
+
+#include <lockstat.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct lock;
+
+/* Statistics for one lock class.  See lib/lockstat.h. */
+struct lock_class {
+    const char *name; /* Class name. */
+    uint64_t acquire_cnt; /* Number of acquisitions. */
+    uint64_t contended_cnt; /* Acquisitions that had to wait. */
+    uint64_t wait_cycles; /* Total time spent waiting. */
+    uint64_t max_wait_cycles; /* Longest wait. */
+    uint64_t hold_cycles; /* Total time held. */
+};
+
+struct lock_class *lockstat_class(const char *name);
+void lockstat_acquire(struct lock *);
+void lockstat_acquired(struct lock *);
+void lockstat_release(struct lock *);
+
+size_t lockstat_get(struct lockstat *, size_t max_cnt);
+void lockstat_print_stats(void);
+
+#endif /* threads/lockstat.h */
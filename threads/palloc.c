@@ -136,6 +136,23 @@ void palloc_free_page(void *page) {
     palloc_free_multiple(page, 1);
 }
 
+/* Frees the PAGE_CNT pages in PAGES, which need not be
+   contiguous or come from the same pool.  Runs of pages that
+   follow one another in PAGES and in memory are freed together,
+   so a batch of pages that were allocated in order costs about
+   as much to free as one allocation of them all. */
+void palloc_free_pages(void **pages, size_t page_cnt) {
+    size_t start, end;
+
+    for (start = 0; start < page_cnt; start = end) {
+        for (end = start + 1; end < page_cnt; end++)
+            if ((uint8_t *) pages[end] !=
+                (uint8_t *) pages[end - 1] + PGSIZE)
+                break;
+        palloc_free_multiple(pages[start], end - start);
+    }
+}
+
 /* Initializes pool P as starting at START and ending at END,
    naming it NAME for debugging purposes. */
 static void init_pool(struct pool *p, void *base, size_t page_cnt,
@@ -151,7 +168,7 @@ static void init_pool(struct pool *p, void *base, size_t page_cnt,
     printf("%zu pages available in %s.\n", page_cnt, name);
 
     /* Initialize the pool. */
-    lock_init(&p->lock);
+    lock_init_named(&p->lock, name);
     p->used_map = bitmap_create_in_buf(page_cnt, base, bm_pages * PGSIZE);
     p->base = base + bm_pages * PGSIZE;
 }
@@ -0,0 +1,256 @@
+#include "threads/schedtrace.h"
+
+#include <debug.h>
+#include <inttypes.h>
+#include <round.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "threads/cpu.h"
+#include "threads/interrupt.h"
+#ifdef FILESYS
+#include <ustar.h>
+
+#include "devices/block.h"
+#endif
+
+/* Number of events in the ring.  Must be a power of 2. */
+#define RING_CNT 2048
+
+/* The ring, and the number of events ever recorded into it.
+   Event N is stored in ring[N % RING_CNT]. */
+static struct sched_event ring[RING_CNT];
+static uint32_t event_cnt;
+
+/* Is tracing on? */
+bool schedtrace_enabled;
+
+/* Greatest number of distinct threads schedtrace_print_stats()
+   reports on.  Events for others are ignored. */
+#define THREAD_CNT 64
+
+/* Per-thread totals, computed from the ring. */
+struct thread_stats {
+    tid_t tid; /* Thread identifier. */
+    char name[16]; /* Name, if the thread still exists. */
+    uint64_t run_cycles; /* Time spent running. */
+    uint64_t wait_cycles; /* Time spent ready but not running. */
+    uint64_t max_latency; /* Longest unblock-to-run latency. */
+    unsigned wakeups; /* Number of unblock-to-run latencies. */
+    uint64_t running_since; /* If nonzero, started running then. */
+    uint64_t ready_since; /* If nonzero, became ready then. */
+    bool woken; /* Became ready by being unblocked? */
+};
+
+/* Unblock-to-run latency histogram.  Bucket N counts latencies
+   of less than 2**N cycles that don't fit an earlier bucket.
+   The last bucket also counts anything bigger. */
+#define HIST_CNT 40
+
+/* Scratch space for schedtrace_print_stats(), which is too big
+   for a kernel stack. */
+static struct thread_stats threads[THREAD_CNT];
+static unsigned histogram[HIST_CNT];
+
+static struct thread_stats *find_stats(tid_t, size_t *cnt);
+static thread_action_func copy_name;
+static unsigned log2_bucket(uint64_t);
+
+/* Records an event of the given TYPE for the thread with
+   identifier TID, if tracing is on.  May be called with
+   interrupts on or off. */
+void schedtrace_record(enum sched_event_type type, tid_t tid) {
+    enum intr_level old_level;
+    struct sched_event *e;
+
+    if (!schedtrace_enabled)
+        return;
+
+    old_level = intr_disable();
+    e = &ring[event_cnt++ % RING_CNT];
+    e->tsc = rdtsc();
+    e->tid = tid;
+    e->type = type;
+    intr_set_level(old_level);
+}
+
+/* Prints per-thread run and wait times and the unblock-to-run
+   latency histogram for the events in the ring, if tracing is
+   on. */
+void schedtrace_print_stats(void) {
+    enum intr_level old_level;
+    uint32_t first, last, i;
+    size_t thread_cnt = 0;
+    bool was_enabled = schedtrace_enabled;
+
+    if (!was_enabled)
+        return;
+
+    /* Stop recording so that the ring holds still while we read
+       it.  Printing blocks on the console lock, which would
+       otherwise add events. */
+    old_level = intr_disable();
+    schedtrace_enabled = false;
+    last = event_cnt;
+    first = last > RING_CNT ? last - RING_CNT : 0;
+    intr_set_level(old_level);
+
+    memset(threads, 0, sizeof threads);
+    memset(histogram, 0, sizeof histogram);
+    for (i = first; i != last; i++) {
+        const struct sched_event *e = &ring[i % RING_CNT];
+        struct thread_stats *s = find_stats(e->tid, &thread_cnt);
+
+        if (s == NULL)
+            continue;
+        switch (e->type) {
+        case SCHED_SWITCH_IN:
+            if (s->ready_since != 0) {
+                uint64_t wait = e->tsc - s->ready_since;
+                s->wait_cycles += wait;
+                if (s->woken) {
+                    histogram[log2_bucket(wait)]++;
+                    s->wakeups++;
+                    if (wait > s->max_latency)
+                        s->max_latency = wait;
+                }
+            }
+            s->ready_since = 0;
+            s->running_since = e->tsc;
+            break;
+        case SCHED_SWITCH_OUT:
+            if (s->running_since != 0)
+                s->run_cycles += e->tsc - s->running_since;
+            s->running_since = 0;
+            break;
+        case SCHED_YIELD:
+            s->ready_since = e->tsc;
+            s->woken = false;
+            break;
+        case SCHED_UNBLOCK:
+            s->ready_since = e->tsc;
+            s->woken = true;
+            break;
+        case SCHED_BLOCK:
+            break;
+        }
+    }
+
+    old_level = intr_disable();
+    thread_foreach(copy_name, &thread_cnt);
+    intr_set_level(old_level);
+
+    printf("Schedtrace: %" PRIu32 " events, %" PRIu32 " overwritten\n",
+           last - first, first);
+    printf("Schedtrace: %5s %-16s %12s %12s %7s %12s\n", "tid", "name",
+           "run cycles", "wait cycles", "wakeups", "max latency");
+    for (i = 0; i < thread_cnt; i++) {
+        const struct thread_stats *s = &threads[i];
+
+        printf("Schedtrace: %5d %-16s %12" PRIu64 " %12" PRIu64
+               " %7u %12" PRIu64 "\n",
+               s->tid, s->name[0] != '\0' ? s->name : "-", s->run_cycles,
+               s->wait_cycles, s->wakeups, s->max_latency);
+    }
+    printf("Schedtrace: unblock-to-run latency histogram:\n");
+    for (i = 0; i < HIST_CNT; i++)
+        if (histogram[i] != 0)
+            printf("Schedtrace: %s %12" PRIu64 " cycles: %u\n",
+                   i < HIST_CNT - 1 ? "<" : ">=",
+                   (uint64_t) 1 << (i < HIST_CNT - 1 ? i : i - 1),
+                   histogram[i]);
+
+    schedtrace_enabled = was_enabled;
+}
+
+#ifdef FILESYS
+/* Writes the events in the ring, oldest first, to the scratch
+   device as a ustar archive containing a file named
+   "schedtrace".  The file is an array of struct sched_event. */
+void schedtrace_dump(void) {
+    static char buffer[BLOCK_SECTOR_SIZE];
+    struct block *dst;
+    enum intr_level old_level;
+    uint32_t first, last, i;
+    block_sector_t sector = 0;
+    size_t ofs = 0;
+    bool was_enabled = schedtrace_enabled;
+
+    /* Stop recording while the disk writes add events. */
+    old_level = intr_disable();
+    schedtrace_enabled = false;
+    last = event_cnt;
+    first = last > RING_CNT ? last - RING_CNT : 0;
+    intr_set_level(old_level);
+
+    printf("Dumping %" PRIu32 " scheduler events to scratch device...\n",
+           last - first);
+    dst = block_get_role(BLOCK_SCRATCH);
+    if (dst == NULL)
+        PANIC("couldn't open scratch device");
+    if (block_size(dst) < DIV_ROUND_UP((last - first) * sizeof *ring,
+                                       BLOCK_SECTOR_SIZE) + 3)
+        PANIC("scratch device too small for scheduler trace");
+
+    if (!ustar_make_header("schedtrace", USTAR_REGULAR,
+                           (last - first) * sizeof *ring, buffer))
+        NOT_REACHED();
+    block_write(dst, sector++, buffer);
+
+    /* BLOCK_SECTOR_SIZE is a multiple of the event size, so
+       events never straddle sectors. */
+    for (i = first; i != last; i++) {
+        memcpy(buffer + ofs, &ring[i % RING_CNT], sizeof *ring);
+        ofs += sizeof *ring;
+        if (ofs == BLOCK_SECTOR_SIZE || i + 1 == last) {
+            memset(buffer + ofs, 0, BLOCK_SECTOR_SIZE - ofs);
+            block_write(dst, sector++, buffer);
+            ofs = 0;
+        }
+    }
+
+    /* End-of-archive marker. */
+    memset(buffer, 0, BLOCK_SECTOR_SIZE);
+    block_write(dst, sector++, buffer);
+    block_write(dst, sector, buffer);
+
+    schedtrace_enabled = was_enabled;
+}
+#endif
+
+/* Returns the stats for TID among the first *CNT elements of
+   THREADS, adding it if it's not there and there's room, or a
+   null pointer if there is no room. */
+static struct thread_stats *find_stats(tid_t tid, size_t *cnt) {
+    size_t i;
+
+    for (i = 0; i < *cnt; i++)
+        if (threads[i].tid == tid)
+            return &threads[i];
+    if (*cnt >= THREAD_CNT)
+        return NULL;
+    threads[*cnt].tid = tid;
+    return &threads[(*cnt)++];
+}
+
+/* thread_foreach() callback that copies T's name into its
+   entry among the first *CNT_ elements of THREADS, if any. */
+static void copy_name(struct thread *t, void *cnt_) {
+    const size_t *cnt = cnt_;
+    size_t i;
+
+    for (i = 0; i < *cnt; i++)
+        if (threads[i].tid == t->tid)
+            strlcpy(threads[i].name, t->name, sizeof threads[i].name);
+}
+
+/* Returns the histogram bucket for a latency of CYCLES. */
+static unsigned log2_bucket(uint64_t cycles) {
+    unsigned bucket = 0;
+
+    while (cycles != 0 && bucket < HIST_CNT - 1) {
+        cycles >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
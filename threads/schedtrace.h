@@ -0,0 +1,49 @@
+#ifndef THREADS_SCHEDTRACE_H
+#define THREADS_SCHEDTRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "threads/thread.h"
+
+/* Scheduler event trace.
+
+   When enabled with the "-schedtrace" kernel option, the
+   scheduler records each thread switch, block, yield, and
+   unblock in a fixed-size ring, stamped with the CPU's
+   time-stamp counter.  Once the ring is full, the oldest events
+   are overwritten.
+
+   schedtrace_print_stats() turns the ring into per-thread run
+   and wait times and a histogram of unblock-to-run latency.  It
+   runs at shutdown and may also be called at any other time,
+   e.g. through the "schedtrace" kernel action.  With a file
+   system, the "schedtrace-dump" action writes the raw ring to
+   the scratch device as a ustar archive holding a single file,
+   for analysis on the host. */
+
+/* Kinds of scheduler events. */
+enum sched_event_type {
+    SCHED_SWITCH_IN, /* Thread started running. */
+    SCHED_SWITCH_OUT, /* Thread stopped running. */
+    SCHED_BLOCK, /* Running thread blocked. */
+    SCHED_YIELD, /* Running thread yielded, still ready. */
+    SCHED_UNBLOCK /* Blocked thread made ready. */
+};
+
+/* A scheduler event, as stored in the ring and in the dump. */
+struct sched_event {
+    uint64_t tsc; /* Time-stamp counter. */
+    tid_t tid; /* Thread the event concerns. */
+    uint32_t type; /* An enum sched_event_type. */
+};
+
+/* Is tracing on?  Controlled by kernel command-line option
+   "-schedtrace". */
+extern bool schedtrace_enabled;
+
+void schedtrace_record(enum sched_event_type, tid_t);
+void schedtrace_print_stats(void);
+void schedtrace_dump(void);
+
+#endif /* threads/schedtrace.h */
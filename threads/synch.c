@@ -31,7 +31,9 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "devices/timer.h"
 #include "threads/interrupt.h"
+#include "threads/lockstat.h"
 #include "threads/thread.h"
 
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
@@ -142,7 +144,9 @@ static void sema_test_helper(void *sema_) {
     }
 }
 
-/* Initializes LOCK.  A lock can be held by at most a single
+/* Initializes LOCK, accounting its contention statistics to
+   the lock class named NAME, which should be a string literal.
+   A lock can be held by at most a single
    thread at any given time.  Our locks are not "recursive", that
    is, it is an error for the thread currently holding a lock to
    try to acquire that lock.
@@ -157,11 +161,13 @@ static void sema_test_helper(void *sema_) {
    acquire and release it.  When these restrictions prove
    onerous, it's a good sign that a semaphore should be used,
    instead of a lock. */
-void lock_init(struct lock *lock) {
+void lock_init_named(struct lock *lock, const char *name) {
     ASSERT(lock != NULL);
 
     lock->holder = NULL;
     sema_init(&lock->semaphore, 1);
+    lock->class = lockstat_class(name);
+    lock->acquire_tsc = 0;
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -177,7 +183,10 @@ void lock_acquire(struct lock *lock) {
     ASSERT(!intr_context());
     ASSERT(!lock_held_by_current_thread(lock));
 
-    sema_down(&lock->semaphore);
+    if (lock->class != NULL)
+        lockstat_acquire(lock);
+    else
+        sema_down(&lock->semaphore);
     lock->holder = thread_current();
 }
 
@@ -194,8 +203,11 @@ bool lock_try_acquire(struct lock *lock) {
     ASSERT(!lock_held_by_current_thread(lock));
 
     success = sema_try_down(&lock->semaphore);
-    if (success)
+    if (success) {
         lock->holder = thread_current();
+        if (lock->class != NULL)
+            lockstat_acquired(lock);
+    }
     return success;
 }
 
@@ -208,6 +220,8 @@ void lock_release(struct lock *lock) {
     ASSERT(lock != NULL);
     ASSERT(lock_held_by_current_thread(lock));
 
+    if (lock->class != NULL)
+        lockstat_release(lock);
     lock->holder = NULL;
     sema_up(&lock->semaphore);
 }
@@ -225,8 +239,11 @@ bool lock_held_by_current_thread(const struct lock *lock) {
 struct semaphore_elem {
     struct list_elem elem; /* List element. */
     struct semaphore semaphore; /* This semaphore. */
+    bool signaled; /* Removed from the list by cond_signal()? */
 };
 
+static void wake_waiter(void *semaphore);
+
 /* Initializes condition variable COND.  A condition variable
    allows one piece of code to signal a condition and cooperating
    code to receive the signal and act upon it. */
@@ -265,10 +282,50 @@ void cond_wait(struct condition *cond, struct lock *lock) {
     ASSERT(lock_held_by_current_thread(lock));
 
     sema_init(&waiter.semaphore, 0);
+    waiter.signaled = false;
+    list_push_back(&cond->waiters, &waiter.elem);
+    lock_release(lock);
+    sema_down(&waiter.semaphore);
+    lock_acquire(lock);
+}
+
+/* Like cond_wait(), but stops waiting once TICKS timer ticks
+   have passed without COND being signaled.  Returns true if COND
+   was signaled, false if the time ran out first or TICKS is not
+   positive.  Either way, LOCK is held on return. */
+bool cond_wait_timeout(struct condition *cond, struct lock *lock,
+                       int64_t ticks) {
+    struct semaphore_elem waiter;
+    struct timer_alarm alarm;
+
+    ASSERT(cond != NULL);
+    ASSERT(lock != NULL);
+    ASSERT(!intr_context());
+    ASSERT(lock_held_by_current_thread(lock));
+
+    if (ticks <= 0)
+        return false;
+
+    sema_init(&waiter.semaphore, 0);
+    waiter.signaled = false;
     list_push_back(&cond->waiters, &waiter.elem);
+    timer_alarm_init(&alarm, wake_waiter, &waiter.semaphore);
+    timer_alarm_set(&alarm, ticks);
     lock_release(lock);
     sema_down(&waiter.semaphore);
+    timer_alarm_cancel(&alarm);
     lock_acquire(lock);
+
+    /* If the alarm woke us up, we are still on the list, which
+       only a holder of LOCK may change. */
+    if (!waiter.signaled)
+        list_remove(&waiter.elem);
+    return waiter.signaled;
+}
+
+/* Timer alarm function for cond_wait_timeout(). */
+static void wake_waiter(void *semaphore) {
+    sema_up(semaphore);
 }
 
 /* If any threads are waiting on COND (protected by LOCK), then
@@ -284,10 +341,12 @@ void cond_signal(struct condition *cond, struct lock *lock UNUSED) {
     ASSERT(!intr_context());
     ASSERT(lock_held_by_current_thread(lock));
 
-    if (!list_empty(&cond->waiters))
-        sema_up(&list_entry(list_pop_front(&cond->waiters),
-                            struct semaphore_elem, elem)
-                     ->semaphore);
+    if (!list_empty(&cond->waiters)) {
+        struct semaphore_elem *waiter = list_entry(
+            list_pop_front(&cond->waiters), struct semaphore_elem, elem);
+        waiter->signaled = true;
+        sema_up(&waiter->semaphore);
+    }
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -303,3 +362,170 @@ void cond_broadcast(struct condition *cond, struct lock *lock) {
     while (!list_empty(&cond->waiters))
         cond_signal(cond, lock);
 }
+
+static struct thread *pop_max_priority(struct list *);
+
+/* Initializes RW as an unheld readers-writer lock. */
+void rwlock_init(struct rwlock *rw) {
+    ASSERT(rw != NULL);
+
+    rw->readers = 0;
+    rw->writer = NULL;
+    list_init(&rw->read_waiters);
+    list_init(&rw->write_waiters);
+}
+
+/* Acquires RW for reading, sleeping until no writer holds or is
+   waiting for it.  The current thread must not already hold RW.
+
+   Access is handed over directly by the releasing thread, so a
+   thread that wakes up from waiting already holds RW.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void rwlock_acquire_read(struct rwlock *rw) {
+    enum intr_level old_level;
+
+    ASSERT(rw != NULL);
+    ASSERT(!intr_context());
+    ASSERT(rw->writer != thread_current());
+
+    old_level = intr_disable();
+    if (rw->writer == NULL && list_empty(&rw->write_waiters))
+        rw->readers++;
+    else {
+        list_push_back(&rw->read_waiters, &thread_current()->elem);
+        thread_block();
+    }
+    intr_set_level(old_level);
+}
+
+/* Releases RW, which the current thread must hold for reading.
+   If this was the last reader, hands RW to the highest-priority
+   waiting writer, if any. */
+void rwlock_release_read(struct rwlock *rw) {
+    enum intr_level old_level;
+
+    ASSERT(rw != NULL);
+
+    old_level = intr_disable();
+    ASSERT(rw->readers > 0);
+    if (--rw->readers == 0 && !list_empty(&rw->write_waiters)) {
+        rw->writer = pop_max_priority(&rw->write_waiters);
+        thread_unblock(rw->writer);
+    }
+    intr_set_level(old_level);
+}
+
+/* Acquires RW for writing, sleeping until no other thread holds
+   it.  The current thread must not already hold RW.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void rwlock_acquire_write(struct rwlock *rw) {
+    struct thread *cur = thread_current();
+    enum intr_level old_level;
+
+    ASSERT(rw != NULL);
+    ASSERT(!intr_context());
+    ASSERT(rw->writer != cur);
+
+    old_level = intr_disable();
+    if (rw->writer == NULL && rw->readers == 0)
+        rw->writer = cur;
+    else {
+        list_push_back(&rw->write_waiters, &cur->elem);
+        thread_block();
+        ASSERT(rw->writer == cur);
+    }
+    intr_set_level(old_level);
+}
+
+/* Releases RW, which the current thread must hold for writing.
+   Hands RW to the highest-priority waiting writer if there is
+   one, otherwise to all of the waiting readers. */
+void rwlock_release_write(struct rwlock *rw) {
+    enum intr_level old_level;
+
+    ASSERT(rw != NULL);
+    ASSERT(rwlock_held_for_write(rw));
+
+    old_level = intr_disable();
+    if (!list_empty(&rw->write_waiters)) {
+        rw->writer = pop_max_priority(&rw->write_waiters);
+        thread_unblock(rw->writer);
+    } else {
+        rw->writer = NULL;
+        while (!list_empty(&rw->read_waiters)) {
+            rw->readers++;
+            thread_unblock(list_entry(list_pop_front(&rw->read_waiters),
+                                      struct thread, elem));
+        }
+    }
+    intr_set_level(old_level);
+}
+
+/* Returns true if the current thread holds RW for writing, false
+   otherwise.  There is no equivalent for readers, because RW
+   does not keep track of which threads are reading. */
+bool rwlock_held_for_write(const struct rwlock *rw) {
+    ASSERT(rw != NULL);
+
+    return rw->writer == thread_current();
+}
+
+/* Removes and returns the highest-priority thread in LIST of
+   threads linked through `elem', the earliest one among those
+   of equal priority.  LIST must not be empty. */
+static struct thread *pop_max_priority(struct list *list) {
+    struct list_elem *e, *max = list_begin(list);
+
+    for (e = list_next(max); e != list_end(list); e = list_next(e))
+        if (list_entry(e, struct thread, elem)->priority >
+            list_entry(max, struct thread, elem)->priority)
+            max = e;
+    list_remove(max);
+    return list_entry(max, struct thread, elem);
+}
+
+/* Initializes SL. */
+void seqlock_init(struct seqlock *sl) {
+    ASSERT(sl != NULL);
+
+    sl->seq = 0;
+}
+
+/* Begins a read of the data protected by SL.  Returns a value to
+   pass to seqlock_read_retry() after reading. */
+unsigned seqlock_read_begin(const struct seqlock *sl) {
+    unsigned seq = sl->seq;
+    barrier();
+    return seq;
+}
+
+/* Returns true if the data protected by SL may have changed
+   since seqlock_read_begin() returned START, in which case the
+   caller must discard what it read and start over. */
+bool seqlock_read_retry(const struct seqlock *sl, unsigned start) {
+    barrier();
+    return (start & 1) != 0 || sl->seq != start;
+}
+
+/* Begins a write of the data protected by SL.  Disables
+   interrupts and returns the previous interrupt level, which
+   must be passed to seqlock_write_end(). */
+enum intr_level seqlock_write_begin(struct seqlock *sl) {
+    enum intr_level old_level = intr_disable();
+
+    sl->seq++;
+    barrier();
+    return old_level;
+}
+
+/* Ends a write of the data protected by SL and restores the
+   interrupt level to OLD_LEVEL. */
+void seqlock_write_end(struct seqlock *sl, enum intr_level old_level) {
+    barrier();
+    sl->seq++;
+    intr_set_level(old_level);
+}
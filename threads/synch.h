@@ -3,6 +3,9 @@
 
 #include <list.h>
 #include <stdbool.h>
+#include <stdint.h>
+
+#include "threads/interrupt.h"
 
 /* A counting semaphore. */
 struct semaphore {
@@ -20,9 +23,19 @@ void sema_self_test(void);
 struct lock {
     struct thread *holder; /* Thread holding lock (for debugging). */
     struct semaphore semaphore; /* Binary semaphore controlling access. */
+    struct lock_class *class; /* Profiling class, or null. */
+    uint64_t acquire_tsc; /* Time-stamp counter when acquired. */
 };
 
-void lock_init(struct lock *);
+/* Initializes LOCK, naming its profiling class after the
+   source location of the call.  Use lock_init_named() to give
+   a more meaningful name.  See threads/lockstat.h. */
+#define lock_init(LOCK) lock_init_named(LOCK, LOCK_CALL_SITE)
+#define LOCK_CALL_SITE __FILE__ ":" LOCK_STRINGIFY(__LINE__)
+#define LOCK_STRINGIFY(X) LOCK_STRINGIFY_(X)
+#define LOCK_STRINGIFY_(X) #X
+
+void lock_init_named(struct lock *, const char *name);
 void lock_acquire(struct lock *);
 bool lock_try_acquire(struct lock *);
 void lock_release(struct lock *);
@@ -35,9 +48,50 @@ struct condition {
 
 void cond_init(struct condition *);
 void cond_wait(struct condition *, struct lock *);
+bool cond_wait_timeout(struct condition *, struct lock *, int64_t ticks);
 void cond_signal(struct condition *, struct lock *);
 void cond_broadcast(struct condition *, struct lock *);
 
+/* Readers-writer lock.
+
+   Any number of readers may hold the lock at once, or a single
+   writer.  New readers wait while a writer is waiting, so a
+   stream of readers cannot starve writers. */
+struct rwlock {
+    unsigned readers; /* Number of readers holding the lock. */
+    struct thread *writer; /* Writer holding the lock, if any. */
+    struct list read_waiters; /* Threads waiting to read. */
+    struct list write_waiters; /* Threads waiting to write. */
+};
+
+void rwlock_init(struct rwlock *);
+void rwlock_acquire_read(struct rwlock *);
+void rwlock_release_read(struct rwlock *);
+void rwlock_acquire_write(struct rwlock *);
+void rwlock_release_write(struct rwlock *);
+bool rwlock_held_for_write(const struct rwlock *);
+
+/* Sequence lock.
+
+   Protects a small piece of data, such as a 64-bit counter, that
+   is read often and written rarely.  Readers never block or
+   disable interrupts: they read the data between
+   seqlock_read_begin() and seqlock_read_retry() and start over
+   if a writer got in the way.  Writers run with interrupts off,
+   so that they exclude each other and cannot be interrupted by a
+   reader.  Readers must copy the data out rather than act on
+   it, because what they read may be inconsistent until
+   seqlock_read_retry() says otherwise. */
+struct seqlock {
+    unsigned seq; /* Odd while a write is in progress. */
+};
+
+void seqlock_init(struct seqlock *);
+unsigned seqlock_read_begin(const struct seqlock *);
+bool seqlock_read_retry(const struct seqlock *, unsigned start);
+enum intr_level seqlock_write_begin(struct seqlock *);
+void seqlock_write_end(struct seqlock *, enum intr_level);
+
 /* Optimization barrier.
 
    The compiler will not reorder operations across an
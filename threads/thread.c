@@ -6,10 +6,13 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "devices/timer.h"
+#include "threads/cpu.h"
 #include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
 #include "threads/palloc.h"
+#include "threads/schedtrace.h"
 #include "threads/switch.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -30,6 +33,19 @@ static struct list ready_list;
    when they are first scheduled and removed when they exit. */
 static struct list all_list;
 
+/* List of real-time threads in THREAD_READY state.  These always
+   run ahead of the threads in READY_LIST, except those that have
+   used up their budget for the current period. */
+static struct list rt_ready_list;
+
+/* List of all real-time threads, linked through `rtelem'. */
+static struct list rt_list;
+
+/* Sum over real-time threads of their budget as a fraction of
+   their period, in thousandths, and the most admitted. */
+static int rt_utilization;
+#define RT_UTILIZATION_MAX 900
+
 /* Idle thread. */
 static struct thread *idle_thread;
 
@@ -39,6 +55,17 @@ static struct thread *initial_thread;
 /* Lock used by allocate_tid(). */
 static struct lock tid_lock;
 
+/* Pages of threads that have exited, kept for reuse by
+   thread_create() so that it can skip the page allocator.  Linked
+   through each dead thread's `allelem'.  Accessed only with
+   interrupts off. */
+static struct list page_cache;
+static size_t page_cache_cnt;
+
+/* Maximum number of pages to keep in PAGE_CACHE.
+   Controlled by kernel command-line option "-tcache=N". */
+size_t thread_cache_max = 8;
+
 /* Stack frame for kernel_thread(). */
 struct kernel_thread_frame {
     void *eip; /* Return address. */
@@ -50,6 +77,19 @@ struct kernel_thread_frame {
 static long long idle_ticks; /* # of timer ticks spent idle. */
 static long long kernel_ticks; /* # of timer ticks in kernel threads. */
 static long long user_ticks; /* # of timer ticks in user programs. */
+static long long create_cnt; /* # of threads created. */
+static long long create_cached_cnt; /* # of those given a cached page. */
+static long long create_cycles; /* Total cycles in thread_create(). */
+static long long create_cycles_max; /* Most cycles in thread_create(). */
+static long long destroy_cnt; /* # of threads destroyed. */
+static long long destroy_cached_cnt; /* # of those whose page was cached. */
+static long long destroy_cycles; /* Total cycles from exit to release. */
+static long long destroy_cycles_max; /* Most cycles from exit to release. */
+static long long rt_period_cnt; /* # of real-time periods completed. */
+static long long rt_miss_cnt; /* # of those that missed their deadline. */
+
+/* Does the CPU have a time-stamp counter for the statistics? */
+static bool have_tsc;
 
 /* Scheduling. */
 #define TIME_SLICE 4 /* # of timer ticks to give each thread. */
@@ -71,6 +111,16 @@ static void *alloc_frame(struct thread *, size_t size);
 static void schedule(void);
 void thread_schedule_tail(struct thread *prev);
 static tid_t allocate_tid(void);
+static struct thread *alloc_thread_page(void);
+static void free_thread_page(struct thread *);
+static uint64_t read_tsc(void);
+static void ready_push(struct thread *);
+static struct thread *rt_next(void);
+static bool rt_before(const struct thread *, const struct thread *);
+static bool rt_should_preempt(struct thread *);
+static void rt_tick(int64_t now);
+static void rt_leave(struct thread *);
+static int rt_share(int64_t budget, int64_t period);
 
 /* Initializes the threading system by transforming the code
    that's currently running into a thread.  This can't work in
@@ -88,9 +138,13 @@ static tid_t allocate_tid(void);
 void thread_init(void) {
     ASSERT(intr_get_level() == INTR_OFF);
 
-    lock_init(&tid_lock);
+    lock_init_named(&tid_lock, "tid");
     list_init(&ready_list);
     list_init(&all_list);
+    list_init(&page_cache);
+    list_init(&rt_ready_list);
+    list_init(&rt_list);
+    have_tsc = cpu_has_features(CPUID_TSC);
 
     /* Set up a thread structure for the running thread. */
     initial_thread = running_thread();
@@ -114,9 +168,10 @@ void thread_start(void) {
     sema_down(&idle_started);
 }
 
-/* Called by the timer interrupt handler at each timer tick.
-   Thus, this function runs in an external interrupt context. */
-void thread_tick(void) {
+/* Called by the timer interrupt handler at each timer tick, with
+   USER true if the tick interrupted user code.  Thus, this
+   function runs in an external interrupt context. */
+void thread_tick(bool user) {
     struct thread *t = thread_current();
 
     /* Update statistics. */
@@ -128,9 +183,25 @@ void thread_tick(void) {
 #endif
     else
         kernel_ticks++;
+    if (t->usage != NULL) {
+        if (user)
+            t->usage->user_ticks++;
+        else
+            t->usage->kernel_ticks++;
+    }
 
-    /* Enforce preemption. */
-    if (++thread_ticks >= TIME_SLICE)
+    /* Charge real-time threads against their budget. */
+    if (t->policy != SCHED_NORMAL && ++t->rt_used >= t->rt_budget) {
+        t->rt_throttled = true;
+        intr_yield_on_return();
+    }
+    rt_tick(timer_ticks());
+
+    /* Enforce preemption.  Real-time threads are not
+       time-sliced, but they do give way to better ones. */
+    if (rt_should_preempt(t))
+        intr_yield_on_return();
+    else if (t->policy == SCHED_NORMAL && ++thread_ticks >= TIME_SLICE)
         intr_yield_on_return();
 }
 
@@ -138,6 +209,17 @@ void thread_tick(void) {
 void thread_print_stats(void) {
     printf("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
            idle_ticks, kernel_ticks, user_ticks);
+    printf("Thread: %lld created (%lld from cache), "
+           "%lld cycles average, %lld max\n",
+           create_cnt, create_cached_cnt,
+           create_cnt ? create_cycles / create_cnt : 0, create_cycles_max);
+    printf("Thread: %lld destroyed (%lld cached), "
+           "%lld cycles average, %lld max\n",
+           destroy_cnt, destroy_cached_cnt,
+           destroy_cnt ? destroy_cycles / destroy_cnt : 0,
+           destroy_cycles_max);
+    printf("Thread: %lld real-time periods, %lld deadlines missed\n",
+           rt_period_cnt, rt_miss_cnt);
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -161,12 +243,14 @@ tid_t thread_create(const char *name, int priority, thread_func *function,
     struct kernel_thread_frame *kf;
     struct switch_entry_frame *ef;
     struct switch_threads_frame *sf;
+    uint64_t start = read_tsc();
+    long long cycles;
     tid_t tid;
 
     ASSERT(function != NULL);
 
     /* Allocate thread. */
-    t = palloc_get_page(PAL_ZERO);
+    t = alloc_thread_page();
     if (t == NULL)
         return TID_ERROR;
 
@@ -192,6 +276,12 @@ tid_t thread_create(const char *name, int priority, thread_func *function,
     /* Add to run queue. */
     thread_unblock(t);
 
+    cycles = read_tsc() - start;
+    create_cnt++;
+    create_cycles += cycles;
+    if (cycles > create_cycles_max)
+        create_cycles_max = cycles;
+
     return tid;
 }
 
@@ -216,7 +306,10 @@ void thread_block(void) {
    This function does not preempt the running thread.  This can
    be important: if the caller had disabled interrupts itself,
    it may expect that it can atomically unblock a thread and
-   update other data. */
+   update other data.  (When called from an interrupt handler,
+   though, a real-time thread that should run ahead of the
+   interrupted thread will do so as soon as the handler
+   returns.) */
 void thread_unblock(struct thread *t) {
     enum intr_level old_level;
 
@@ -224,8 +317,11 @@ void thread_unblock(struct thread *t) {
 
     old_level = intr_disable();
     ASSERT(t->status == THREAD_BLOCKED);
-    list_push_back(&ready_list, &t->elem);
+    ready_push(t);
     t->status = THREAD_READY;
+    schedtrace_record(SCHED_UNBLOCK, t->tid);
+    if (intr_context() && rt_should_preempt(thread_current()))
+        intr_yield_on_return();
     intr_set_level(old_level);
 }
 
@@ -261,6 +357,8 @@ tid_t thread_tid(void) {
 void thread_exit(void) {
     ASSERT(!intr_context());
 
+    thread_current()->exit_tsc = read_tsc();
+
 #ifdef USERPROG
     process_exit();
 #endif
@@ -270,6 +368,8 @@ void thread_exit(void) {
        when it calls thread_schedule_tail(). */
     intr_disable();
     list_remove(&thread_current()->allelem);
+    if (thread_current()->policy != SCHED_NORMAL)
+        rt_leave(thread_current());
     thread_current()->status = THREAD_DYING;
     schedule();
     NOT_REACHED();
@@ -285,7 +385,7 @@ void thread_yield(void) {
 
     old_level = intr_disable();
     if (cur != idle_thread)
-        list_push_back(&ready_list, &cur->elem);
+        ready_push(cur);
     cur->status = THREAD_READY;
     schedule();
     intr_set_level(old_level);
@@ -315,6 +415,69 @@ int thread_get_priority(void) {
     return thread_current()->priority;
 }
 
+/* Sets the scheduling class and parameters of the current
+   thread to ATTR.  Returns true if successful, false if ATTR is
+   invalid or admitting the thread to the real-time class would
+   exceed the real-time utilization limit.  See lib/sched.h. */
+bool thread_set_sched(const struct sched_attr *attr) {
+    struct thread *cur = thread_current();
+    enum intr_level old_level;
+    int share = 0, old_share = 0;
+
+    ASSERT(attr != NULL);
+
+    if (attr->policy == SCHED_FIFO || attr->policy == SCHED_EDF) {
+        if (attr->period <= 0 || attr->budget <= 0 ||
+            attr->budget > attr->period)
+            return false;
+        if (attr->policy == SCHED_FIFO &&
+            (attr->priority < SCHED_PRI_MIN || attr->priority > SCHED_PRI_MAX))
+            return false;
+        share = rt_share(attr->budget, attr->period);
+    } else if (attr->policy != SCHED_NORMAL)
+        return false;
+
+    old_level = intr_disable();
+    if (cur->policy != SCHED_NORMAL)
+        old_share = rt_share(cur->rt_budget, cur->rt_period);
+    if (rt_utilization - old_share + share > RT_UTILIZATION_MAX) {
+        intr_set_level(old_level);
+        return false;
+    }
+    if (cur->policy != SCHED_NORMAL)
+        rt_leave(cur);
+    if (attr->policy != SCHED_NORMAL) {
+        rt_utilization += share;
+        list_push_back(&rt_list, &cur->rtelem);
+        cur->rt_priority = attr->priority;
+        cur->rt_period = attr->period;
+        cur->rt_budget = attr->budget;
+        cur->rt_deadline = timer_ticks() + attr->period;
+        cur->rt_used = 0;
+        cur->rt_throttled = false;
+    }
+    cur->policy = attr->policy;
+    intr_set_level(old_level);
+
+    return true;
+}
+
+/* Blocks the current thread, which must be a real-time thread,
+   until its next period begins.  A periodic thread calls this
+   when it has finished the work for its current period. */
+void thread_wait_period(void) {
+    struct thread *cur = thread_current();
+    enum intr_level old_level;
+
+    ASSERT(!intr_context());
+    ASSERT(cur->policy != SCHED_NORMAL);
+
+    old_level = intr_disable();
+    cur->rt_waiting = true;
+    thread_block();
+    intr_set_level(old_level);
+}
+
 /* Sets the current thread's nice value to NICE. */
 void thread_set_nice(int nice UNUSED) {
     /* Not yet implemented. */
@@ -415,16 +578,6 @@ static void init_thread(struct thread *t, const char *name, int priority) {
     t->priority = priority;
     t->magic = THREAD_MAGIC;
 
-    #ifdef USERPROG
-    /* Initialize file descriptor table */
-    int i;
-    for (i = 0; i < MAX_FILES; i++) {
-        t->files[i] = NULL;
-    }
-    t->next_fd = 2; /* Start at 2 (0=stdin, 1=stdout) */
-    list_init(&t->children);
-    #endif
-
     old_level = intr_disable();
     list_push_back(&all_list, &t->allelem);
     intr_set_level(old_level);
@@ -447,6 +600,12 @@ static void *alloc_frame(struct thread *t, size_t size) {
    will be in the run queue.)  If the run queue is empty, return
    idle_thread. */
 static struct thread *next_thread_to_run(void) {
+    struct thread *rt = rt_next();
+
+    if (rt != NULL) {
+        list_remove(&rt->elem);
+        return rt;
+    }
     if (list_empty(&ready_list))
         return idle_thread;
     else
@@ -492,8 +651,15 @@ void thread_schedule_tail(struct thread *prev) {
        palloc().) */
     if (prev != NULL && prev->status == THREAD_DYING &&
         prev != initial_thread) {
+        long long cycles;
+
         ASSERT(prev != cur);
-        palloc_free_page(prev);
+        cycles = read_tsc() - prev->exit_tsc;
+        destroy_cnt++;
+        destroy_cycles += cycles;
+        if (cycles > destroy_cycles_max)
+            destroy_cycles_max = cycles;
+        free_thread_page(prev);
     }
 }
 
@@ -513,6 +679,22 @@ static void schedule(void) {
     ASSERT(cur->status != THREAD_RUNNING);
     ASSERT(is_thread(next));
 
+    if (cur->status == THREAD_BLOCKED)
+        schedtrace_record(SCHED_BLOCK, cur->tid);
+    else if (cur->status == THREAD_READY)
+        schedtrace_record(SCHED_YIELD, cur->tid);
+    schedtrace_record(SCHED_SWITCH_OUT, cur->tid);
+    schedtrace_record(SCHED_SWITCH_IN, next->tid);
+
+    /* Blocking gives up the CPU voluntarily.  A thread that is
+       still ready to run was preempted or yielded. */
+    if (cur != next && cur->usage != NULL) {
+        if (cur->status == THREAD_BLOCKED)
+            cur->usage->voluntary_switches++;
+        else if (cur->status == THREAD_READY)
+            cur->usage->involuntary_switches++;
+    }
+
     if (cur != next)
         prev = switch_threads(cur, next);
     thread_schedule_tail(prev);
@@ -530,6 +712,146 @@ static tid_t allocate_tid(void) {
     return tid;
 }
 
+/* Returns a page for a new thread, taking one from the cache of
+   dead threads' pages if possible, or a null pointer if no
+   memory is available.  The page is not zeroed: init_thread()
+   clears the `struct thread' at its base, and nothing else in
+   the page needs to start out clear. */
+static struct thread *alloc_thread_page(void) {
+    struct thread *t = NULL;
+    enum intr_level old_level;
+
+    old_level = intr_disable();
+    if (!list_empty(&page_cache)) {
+        t = list_entry(list_pop_front(&page_cache), struct thread, allelem);
+        page_cache_cnt--;
+        create_cached_cnt++;
+    }
+    intr_set_level(old_level);
+
+    if (t == NULL)
+        t = palloc_get_page(0);
+    return t;
+}
+
+/* Releases the page of dead thread T, keeping it in the cache if
+   the cache is below its high-water mark.  Interrupts must be
+   off. */
+static void free_thread_page(struct thread *t) {
+    ASSERT(intr_get_level() == INTR_OFF);
+
+    if (page_cache_cnt < thread_cache_max) {
+        list_push_front(&page_cache, &t->allelem);
+        page_cache_cnt++;
+        destroy_cached_cnt++;
+    } else
+        palloc_free_page(t);
+}
+
+/* Returns the time-stamp counter, or 0 if the CPU doesn't have
+   one. */
+static uint64_t read_tsc(void) {
+    return have_tsc ? rdtsc() : 0;
+}
+
+/* Adds T, which is becoming ready, to the ready list for its
+   scheduling class.  Interrupts must be off. */
+static void ready_push(struct thread *t) {
+    if (t->policy != SCHED_NORMAL)
+        list_push_back(&rt_ready_list, &t->elem);
+    else
+        list_push_back(&ready_list, &t->elem);
+}
+
+/* Returns the real-time thread that should run next, without
+   removing it from RT_READY_LIST, or a null pointer if no
+   real-time thread is ready and within its budget. */
+static struct thread *rt_next(void) {
+    struct thread *best = NULL;
+    struct list_elem *e;
+
+    for (e = list_begin(&rt_ready_list); e != list_end(&rt_ready_list);
+         e = list_next(e)) {
+        struct thread *t = list_entry(e, struct thread, elem);
+        if (!t->rt_throttled && (best == NULL || rt_before(t, best)))
+            best = t;
+    }
+    return best;
+}
+
+/* Returns true if real-time thread A should run before
+   real-time thread B, false if B should run first or they are
+   equivalent. */
+static bool rt_before(const struct thread *a, const struct thread *b) {
+    if (a->policy != b->policy)
+        return a->policy == SCHED_EDF;
+    else if (a->policy == SCHED_EDF)
+        return a->rt_deadline < b->rt_deadline;
+    else
+        return a->rt_priority > b->rt_priority;
+}
+
+/* Returns true if a ready real-time thread should run instead
+   of running thread CUR. */
+static bool rt_should_preempt(struct thread *cur) {
+    struct thread *next = rt_next();
+
+    if (next == NULL)
+        return false;
+    return cur->policy == SCHED_NORMAL || cur->rt_throttled ||
+           rt_before(next, cur);
+}
+
+/* Starts new periods for real-time threads whose deadline has
+   come by tick NOW, counting a missed deadline for each that
+   still wanted to run but had not been given its whole budget.
+   Called by the timer interrupt handler. */
+static void rt_tick(int64_t now) {
+    struct list_elem *e;
+
+    ASSERT(intr_get_level() == INTR_OFF);
+
+    for (e = list_begin(&rt_list); e != list_end(&rt_list);
+         e = list_next(e)) {
+        struct thread *t = list_entry(e, struct thread, rtelem);
+
+        if (now < t->rt_deadline)
+            continue;
+
+        rt_period_cnt++;
+        if (t->status != THREAD_BLOCKED && !t->rt_throttled)
+            rt_miss_cnt++;
+
+        /* Skip any periods that passed entirely while T was
+           blocked. */
+        t->rt_deadline +=
+            ((now - t->rt_deadline) / t->rt_period + 1) * t->rt_period;
+        t->rt_used = 0;
+        t->rt_throttled = false;
+        if (t->rt_waiting) {
+            t->rt_waiting = false;
+            thread_unblock(t);
+        }
+    }
+}
+
+/* Removes real-time thread T from the real-time class, returning
+   its share of the CPU.  Interrupts must be off. */
+static void rt_leave(struct thread *t) {
+    ASSERT(intr_get_level() == INTR_OFF);
+    ASSERT(t->policy != SCHED_NORMAL);
+
+    rt_utilization -= rt_share(t->rt_budget, t->rt_period);
+    list_remove(&t->rtelem);
+    t->policy = SCHED_NORMAL;
+}
+
+/* Returns BUDGET as a fraction of PERIOD, in thousandths,
+   rounded up. */
+static int rt_share(int64_t budget, int64_t period) {
+    return (budget * 1000 + period - 1) / period;
+}
+
 /* Offset of `stack' member within `struct thread'.
    Used by switch.S, which can't figure it out on its own. */
 uint32_t thread_stack_ofs = offsetof(struct thread, stack);
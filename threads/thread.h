@@ -3,17 +3,14 @@
 
 #include <debug.h>
 #include <list.h>
+#include <rusage.h>
+#include <sched.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "threads/fixed-point.h"
 #include "threads/synch.h"
 
-/* Define max file number */
-
-#define MAX_FILES 128
-
-
-
 /* States in a thread's life cycle. */
 enum thread_status {
     THREAD_RUNNING, /* Running thread. */
@@ -89,14 +86,6 @@ typedef int tid_t;
    ready state is on the run queue, whereas only a thread in the
    blocked state is on a semaphore wait list. */
 
-struct child_status {
-      tid_t tid;   // child thread id
-      int exit_code;   // child exit status
-      struct semaphore exit_sema; // child exit semaphore
-      bool waited;  // true if parent already called wait()
-      struct list_elem elem;  // tracks the list of children
-};
-
 struct thread {
     /* Owned by thread.c. */
     tid_t tid; /* Thread identifier. */
@@ -109,31 +98,60 @@ struct thread {
     /* Shared between thread.c and synch.c. */
     struct list_elem elem; /* List element. */
 
+    /* Real-time scheduling.  Owned by thread.c. */
+    int policy; /* SCHED_NORMAL, SCHED_FIFO, or SCHED_EDF. */
+    int rt_priority; /* SCHED_FIFO priority. */
+    int64_t rt_period; /* Period, in timer ticks. */
+    int64_t rt_budget; /* Ticks allowed per period. */
+    int64_t rt_deadline; /* Tick at which the current period ends. */
+    int64_t rt_used; /* Ticks used in the current period. */
+    bool rt_throttled; /* Budget used up until next period? */
+    bool rt_waiting; /* Blocked in thread_wait_period()? */
+    struct list_elem rtelem; /* Element in real-time threads list. */
+
 #ifdef USERPROG
     /* Owned by userprog/process.c. */
-    uint32_t *pagedir; /* Page directory. */
-    struct file *files[MAX_FILES]; /* File descriptor table */
-    int next_fd; /* Next available fd */
-
-    /* Process management */
-    struct list children;         /* List of child_status structures */
-    struct child_status *status_of_child;
+    uint32_t *pagedir; /* Page directory, that of PROCESS if any. */
+    struct process *process; /* Process, or null for a kernel thread. */
+    struct join_status *join_status; /* Process's record of us. */
+    void *ustack; /* Own user stack page, if not the first thread. */
 #endif
 
+    /* Set by its owner, such as userprog/process.c, and updated
+       with interrupts off by anyone, with CHARGE_USAGE. */
+    struct rusage *usage; /* Where to count resource use, or null. */
+
     /* Owned by thread.c. */
+    uint64_t exit_tsc; /* Time-stamp counter at thread_exit(). */
     unsigned magic; /* Detects stack overflow. */
-    struct file *executable;  // Add this field to track the running executable
 };
 
+/* Adds N to MEMBER of the struct rusage that the running
+   thread's resource use is counted in, if any.  Interrupts are
+   turned off because the timer interrupt updates the same
+   counters. */
+#define CHARGE_USAGE(MEMBER, N)                                                \
+    do {                                                                       \
+        enum intr_level old_level_ = intr_disable();                           \
+        struct rusage *usage_ = thread_current()->usage;                       \
+        if (usage_ != NULL)                                                    \
+            usage_->MEMBER += (N);                                             \
+        intr_set_level(old_level_);                                            \
+    } while (0)
+
 /* If false (default), use round-robin scheduler.
    If true, use multi-level feedback queue scheduler.
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* Maximum number of dead threads' pages to keep for reuse.
+   Controlled by kernel command-line option "-tcache=N". */
+extern size_t thread_cache_max;
+
 void thread_init(void);
 void thread_start(void);
 
-void thread_tick(void);
+void thread_tick(bool user);
 void thread_print_stats(void);
 
 typedef void thread_func(void *aux);
@@ -156,6 +174,9 @@ void thread_foreach(thread_action_func *, void *);
 int thread_get_priority(void);
 void thread_set_priority(int);
 
+bool thread_set_sched(const struct sched_attr *);
+void thread_wait_period(void);
+
 int thread_get_nice(void);
 void thread_set_nice(int);
 int thread_get_recent_cpu(void);
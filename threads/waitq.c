@@ -0,0 +1,97 @@
+#include "threads/waitq.h"
+
+#include <debug.h>
+
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+static void wake(struct poller *);
+static void wake_alarm(void *poller);
+
+/* Initializes Q as an empty wait queue. */
+void waitq_init(struct waitq *q) {
+    list_init(&q->entries);
+}
+
+/* Wakes up every poller waiting on Q.  May be called from an
+   interrupt handler. */
+void waitq_wake(struct waitq *q) {
+    enum intr_level old_level = intr_disable();
+    struct list_elem *e;
+
+    for (e = list_begin(&q->entries); e != list_end(&q->entries);
+         e = list_next(e))
+        wake(list_entry(e, struct waitq_entry, queue_elem)->poller);
+    intr_set_level(old_level);
+}
+
+/* Initializes P for the current thread, waiting on no queues. */
+void poller_init(struct poller *p) {
+    p->thread = NULL;
+    p->woken = false;
+    list_init(&p->entries);
+}
+
+/* Adds P to Q, using entry E. */
+void poller_add(struct poller *p, struct waitq *q, struct waitq_entry *e) {
+    enum intr_level old_level = intr_disable();
+
+    e->poller = p;
+    list_push_back(&q->entries, &e->queue_elem);
+    list_push_back(&p->entries, &e->poller_elem);
+    intr_set_level(old_level);
+}
+
+/* Sleeps until one of P's queues is woken, or TICKS timer ticks
+   pass if TICKS is nonnegative.  Returns at once if a queue was
+   woken since the last call, or since poller_init(). */
+void poller_wait(struct poller *p, int64_t ticks) {
+    struct timer_alarm alarm;
+    enum intr_level old_level;
+
+    ASSERT(!intr_context());
+
+    old_level = intr_disable();
+    if (!p->woken && ticks != 0) {
+        if (ticks > 0) {
+            timer_alarm_init(&alarm, wake_alarm, p);
+            timer_alarm_set(&alarm, ticks);
+        }
+        p->thread = thread_current();
+        thread_block();
+        if (ticks > 0)
+            timer_alarm_cancel(&alarm);
+    }
+    p->woken = false;
+    intr_set_level(old_level);
+}
+
+/* Removes P from all of its queues. */
+void poller_done(struct poller *p) {
+    enum intr_level old_level = intr_disable();
+
+    while (!list_empty(&p->entries)) {
+        struct waitq_entry *e = list_entry(list_pop_front(&p->entries),
+                                           struct waitq_entry, poller_elem);
+        list_remove(&e->queue_elem);
+    }
+    intr_set_level(old_level);
+}
+
+/* Wakes up P's thread, if it sleeps, and notes that P was
+   woken.  Interrupts must be off. */
+static void wake(struct poller *p) {
+    ASSERT(intr_get_level() == INTR_OFF);
+
+    p->woken = true;
+    if (p->thread != NULL) {
+        thread_unblock(p->thread);
+        p->thread = NULL;
+    }
+}
+
+/* Alarm function for poller_wait()'s timeout. */
+static void wake_alarm(void *poller) {
+    wake(poller);
+}
@@ -0,0 +1,52 @@
+#ifndef THREADS_WAITQ_H
+#define THREADS_WAITQ_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Wait queues, for sleeping until any of several things becomes
+   ready, as poll() does.
+
+   Each thing that a thread might wait for, such as the input
+   buffer or one end of a pipe, has a wait queue, and calls
+   waitq_wake() whenever it might have become ready.  A thread
+   that wants to wait for several things sets up a poller, adds
+   it to each thing's wait queue with poller_add(), checks
+   whether any is ready already, and if not calls poller_wait().
+   A wakeup that arrives between poller_add() and poller_wait()
+   is not lost: it makes poller_wait() return at once.
+
+   Wait queues are protected by turning interrupts off, so
+   waitq_wake() may be called from an interrupt handler. */
+
+/* A wait queue. */
+struct waitq {
+    struct list entries; /* struct waitq_entry for each poller. */
+};
+
+/* A thread waiting on one or more wait queues. */
+struct poller {
+    struct thread *thread; /* Thread, while it sleeps. */
+    bool woken; /* Woken since the last poller_wait()? */
+    struct list entries; /* struct waitq_entry, one per queue. */
+};
+
+/* A poller's place in one wait queue.  Owned by the poller's
+   thread, which usually keeps it on its stack or in an array,
+   and which must not free it before poller_done(). */
+struct waitq_entry {
+    struct list_elem queue_elem; /* Element in struct waitq. */
+    struct list_elem poller_elem; /* Element in struct poller. */
+    struct poller *poller; /* Poller waiting. */
+};
+
+void waitq_init(struct waitq *);
+void waitq_wake(struct waitq *);
+
+void poller_init(struct poller *);
+void poller_add(struct poller *, struct waitq *, struct waitq_entry *);
+void poller_wait(struct poller *, int64_t ticks);
+void poller_done(struct poller *);
+
+#endif /* threads/waitq.h */
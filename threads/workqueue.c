@@ -0,0 +1,217 @@
+#include "threads/workqueue.h"
+
+#include <debug.h>
+#include <stdio.h>
+
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Number of worker threads. */
+#define WORKER_CNT 2
+
+/* Work submitted but not yet picked up by a worker, as a stack
+   linked through `next', newest first.  Submitters push onto it
+   with an atomic compare-and-exchange, without locking or
+   disabling interrupts, so an interrupt handler can submit work
+   even if it interrupted a kernel thread halfway through
+   submitting its own.  Only workers pop from it, and they take
+   the whole stack at once. */
+static struct work *pending_stack;
+
+/* Work taken off PENDING_STACK by a worker, oldest first. */
+static struct list work_list;
+static struct lock work_lock;
+
+/* Number of items on PENDING_STACK and WORK_LIST combined. */
+static struct semaphore work_cnt;
+
+/* Delayed work that is not yet due, ordered by due time.
+   Accessed only with interrupts off, because the timer interrupt
+   moves due items to PENDING_STACK. */
+static struct list delayed_list = LIST_INITIALIZER(delayed_list);
+
+/* Last tick passed to workqueue_tick(). */
+static int64_t now_ticks;
+
+/* Has workqueue_init() been called? */
+static bool started;
+
+static thread_func worker;
+static void enqueue(struct work *);
+static void take_pending(void);
+static list_less_func due_less;
+
+/* Atomically stores NEW into *P and returns the old value. */
+static inline int atomic_xchg(int *p, int new) {
+    asm volatile("xchgl %0, %1" : "+r"(new), "+m"(*p) : : "memory");
+    return new;
+}
+
+/* Atomically stores NEW into *P and returns the old value. */
+static inline struct work *atomic_xchg_work(struct work **p,
+                                            struct work *new) {
+    asm volatile("xchgl %0, %1" : "+r"(new), "+m"(*p) : : "memory");
+    return new;
+}
+
+/* Atomically stores NEW into *P if *P equals OLD.  Returns the
+   value *P had before, so the store happened if and only if the
+   return value is OLD. */
+static inline struct work *atomic_cmpxchg_work(struct work **p,
+                                               struct work *old,
+                                               struct work *new) {
+    struct work *prev;
+    asm volatile("lock cmpxchgl %2, %1"
+                 : "=a"(prev), "+m"(*p)
+                 : "r"(new), "0"(old)
+                 : "memory");
+    return prev;
+}
+
+/* Starts the worker threads.  Work may not be submitted before
+   this function is called. */
+void workqueue_init(void) {
+    int i;
+
+    list_init(&work_list);
+    lock_init_named(&work_lock, "workqueue");
+    sema_init(&work_cnt, 0);
+    started = true;
+
+    for (i = 0; i < WORKER_CNT; i++) {
+        char name[16];
+
+        snprintf(name, sizeof name, "worker%d", i);
+        if (thread_create(name, PRI_DEFAULT, worker, NULL) == TID_ERROR)
+            PANIC("workqueue: can't create %s", name);
+    }
+}
+
+/* Moves delayed work that is due at tick NOW to the pending
+   stack.  Called by the timer interrupt handler at each timer
+   tick. */
+void workqueue_tick(int64_t now) {
+    ASSERT(intr_get_level() == INTR_OFF);
+
+    now_ticks = now;
+    while (!list_empty(&delayed_list)) {
+        struct work *w =
+            list_entry(list_front(&delayed_list), struct work, elem);
+        if (w->due > now)
+            break;
+        list_pop_front(&delayed_list);
+        enqueue(w);
+    }
+}
+
+/* Initializes W to call FUNCTION with argument AUX when it is
+   run. */
+void work_init(struct work *w, work_func *function, void *aux) {
+    ASSERT(w != NULL);
+    ASSERT(function != NULL);
+
+    w->next = NULL;
+    w->function = function;
+    w->aux = aux;
+    w->due = 0;
+    w->pending = 0;
+}
+
+/* Queues W to be run by a worker thread as soon as possible.
+   Returns true if W was queued, false if it was already pending.
+   W may be queued again once its function has started.
+
+   This function never sleeps, so it may be called from an
+   interrupt handler. */
+bool work_schedule(struct work *w) {
+    ASSERT(started);
+
+    if (atomic_xchg(&w->pending, 1))
+        return false;
+    enqueue(w);
+    return true;
+}
+
+/* Queues W to be run by a worker thread once TICKS timer ticks
+   have passed.  Returns true if W was queued, false if it was
+   already pending.
+
+   This function may be called from an interrupt handler. */
+bool work_schedule_delayed(struct work *w, int64_t ticks) {
+    enum intr_level old_level;
+
+    ASSERT(started);
+
+    if (ticks <= 0)
+        return work_schedule(w);
+    if (atomic_xchg(&w->pending, 1))
+        return false;
+
+    old_level = intr_disable();
+    w->due = now_ticks + ticks;
+    list_insert_ordered(&delayed_list, &w->elem, due_less, NULL);
+    intr_set_level(old_level);
+    return true;
+}
+
+/* Worker thread.  Runs queued work items one at a time, in
+   submission order, forever. */
+static void worker(void *aux UNUSED) {
+    for (;;) {
+        struct work *w;
+        work_func *function;
+        void *w_aux;
+
+        sema_down(&work_cnt);
+
+        lock_acquire(&work_lock);
+        if (list_empty(&work_list))
+            take_pending();
+        ASSERT(!list_empty(&work_list));
+        w = list_entry(list_pop_front(&work_list), struct work, elem);
+        lock_release(&work_lock);
+
+        /* Once W is no longer pending its owner may requeue or
+           reuse it, so fetch what we need first. */
+        function = w->function;
+        w_aux = w->aux;
+        atomic_xchg(&w->pending, 0);
+        function(w_aux);
+    }
+}
+
+/* Pushes W onto the pending stack and wakes up a worker. */
+static void enqueue(struct work *w) {
+    struct work *head;
+
+    do {
+        head = pending_stack;
+        w->next = head;
+    } while (atomic_cmpxchg_work(&pending_stack, head, w) != head);
+    sema_up(&work_cnt);
+}
+
+/* Empties the pending stack onto the end of WORK_LIST.  The
+   stack is newest first, so each item is inserted in front of
+   the one that was pushed after it. */
+static void take_pending(void) {
+    struct work *w = atomic_xchg_work(&pending_stack, NULL);
+    struct list_elem *pos = list_end(&work_list);
+
+    ASSERT(lock_held_by_current_thread(&work_lock));
+
+    for (; w != NULL; w = w->next) {
+        list_insert(pos, &w->elem);
+        pos = &w->elem;
+    }
+}
+
+/* Returns true if delayed work A is due before B. */
+static bool due_less(const struct list_elem *a_, const struct list_elem *b_,
+                     void *aux UNUSED) {
+    const struct work *a = list_entry(a_, struct work, elem);
+    const struct work *b = list_entry(b_, struct work, elem);
+
+    return a->due < b->due;
+}
@@ -0,0 +1,40 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Deferred work.
+
+   A work item is a function to be called later, in the context
+   of one of a small pool of kernel worker threads.  Interrupt
+   handlers use work items to push anything slow out of interrupt
+   context: they may queue work at any time, even with interrupts
+   off.  The work function runs with interrupts on and may sleep,
+   acquire locks, do disk I/O, and so on.
+
+   A work item is owned by its submitter, which usually embeds it
+   in a larger structure, and must stay allocated until its
+   function has started running. */
+
+typedef void work_func(void *aux);
+
+/* A work item. */
+struct work {
+    struct work *next; /* Next item in pending stack. */
+    struct list_elem elem; /* Element in ready or delayed list. */
+    work_func *function; /* Function to call. */
+    void *aux; /* Argument for FUNCTION. */
+    int64_t due; /* Delayed work: tick to run at. */
+    int pending; /* Nonzero while queued and not yet started. */
+};
+
+void workqueue_init(void);
+void workqueue_tick(int64_t now);
+
+void work_init(struct work *, work_func *, void *aux);
+bool work_schedule(struct work *);
+bool work_schedule_delayed(struct work *, int64_t ticks);
+
+#endif /* threads/workqueue.h */
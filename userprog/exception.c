@@ -5,7 +5,11 @@
 
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/vaddr.h"
 #include "userprog/gdt.h"
+#include "userprog/pagedir.h"
+#include "userprog/process.h"
+#include "userprog/uaccess.h"
 
 /* Number of page faults processed. */
 static long long page_fault_cnt;
@@ -84,8 +88,7 @@ static void kill(struct intr_frame *f) {
         printf("%s: dying due to interrupt %#04x (%s).\n", thread_name(),
                f->vec_no, intr_name(f->vec_no));
         intr_dump_frame(f);
-        thread_exit();
-      //   process_exit(-1);
+        process_terminate(-1);
 
     case SEL_KCSEG:
         /* Kernel's code segment, which indicates a kernel bug.
@@ -137,15 +140,29 @@ static void page_fault(struct intr_frame *f) {
 
     /* Count page faults. */
     page_fault_cnt++;
+    CHARGE_USAGE(page_faults, 1);
 
     /* Determine cause. */
     not_present = (f->error_code & PF_P) == 0;
     write = (f->error_code & PF_W) != 0;
     user = (f->error_code & PF_U) != 0;
-    if (user) {
-        printf("%s: exit(-1)\n", thread_current()->name);
-        thread_exit();
-    }
+
+    /* A write to a page shared copy-on-write since a fork(), by
+       the process or by the kernel on its behalf.  Once the
+       page is the process's own, the write can be retried. */
+    if (!not_present && write && is_user_vaddr(fault_addr) &&
+        thread_current()->pagedir != NULL &&
+        pagedir_copy_on_write(thread_current()->pagedir,
+                              pg_round_down(fault_addr)))
+        return;
+
+    /* A bad user address passed to the kernel.  Make the copy
+       routine that touched it return an error. */
+    if (!user && uaccess_fixup(f, fault_addr))
+        return;
+
+    if (user)
+        process_terminate(-1);
     /* To implement virtual memory, delete the rest of the function
        body, and replace it with code that brings in the page to
        which fault_addr refers. */
@@ -0,0 +1,290 @@
+#include "userprog/fdtable.h"
+
+#include <bitmap.h>
+#include <debug.h>
+
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "userprog/pipe.h"
+#include "userprog/shm.h"
+
+/* Number of fds a table has room for when first allocated. */
+#define FDTABLE_MIN 16
+
+/* Most fds a process may have.  Bounds how much kernel memory a
+   process can tie up in open files. */
+#define FDTABLE_MAX 1024
+
+static int alloc(struct fdtable *, const struct fd_entry *);
+static bool install(struct fdtable *, int fd, const struct fd_entry *);
+static void entry_dup(struct fd_entry *dst, const struct fd_entry *src);
+static void entry_close(struct fd_entry *);
+static bool grow(struct fdtable *, int min_size);
+
+/* Initializes T as an empty table. */
+void fdtable_init(struct fdtable *t) {
+    int fd;
+
+    t->entries = NULL;
+    t->used = NULL;
+    t->size = 0;
+    for (fd = 0; fd < FD_FIRST; fd++)
+        t->console_flags[fd] = 0;
+}
+
+/* Closes everything open in T and frees T's memory, leaving T
+   empty. */
+void fdtable_destroy(struct fdtable *t) {
+    int fd;
+
+    for (fd = FD_FIRST; fd < t->size; fd++)
+        entry_close(&t->entries[fd]);
+    free(t->entries);
+    if (t->used != NULL)
+        bitmap_destroy(t->used);
+    fdtable_init(t);
+}
+
+/* Initializes DST as a copy of SRC, in which each fd refers to
+   the same thing as the same fd in SRC, as if by
+   fdtable_dup2(), and has the same flags.  Returns true if
+   successful, false if memory is exhausted, in which case DST is
+   left empty. */
+bool fdtable_copy(struct fdtable *dst, const struct fdtable *src) {
+    int fd;
+
+    fdtable_init(dst);
+    for (fd = 0; fd < FD_FIRST; fd++)
+        dst->console_flags[fd] = src->console_flags[fd];
+    if (src->size == 0)
+        return true;
+    if (!grow(dst, src->size))
+        return false;
+
+    for (fd = FD_FIRST; fd < src->size; fd++)
+        if (bitmap_test(src->used, fd)) {
+            entry_dup(&dst->entries[fd], &src->entries[fd]);
+            bitmap_mark(dst->used, fd);
+        }
+    return true;
+}
+
+/* Adds FILE to T under the lowest fd not in use and returns the
+   fd.  Returns -1 if T is full or memory is exhausted. */
+int fdtable_alloc(struct fdtable *t, struct file *file) {
+    struct fd_entry e = {.file = file};
+
+    ASSERT(file != NULL);
+    return alloc(t, &e);
+}
+
+/* Adds the read end of PIPE, or its write end if WRITER is true,
+   to T under the lowest fd not in use and returns the fd.  The
+   fd takes over the caller's reference to that end.  Returns -1
+   if T is full or memory is exhausted. */
+int fdtable_alloc_pipe(struct fdtable *t, struct pipe *pipe, bool writer) {
+    struct fd_entry e = {.pipe = pipe, .writer = writer};
+
+    ASSERT(pipe != NULL);
+    return alloc(t, &e);
+}
+
+/* Adds SHM to T under the lowest fd not in use and returns the
+   fd.  The fd takes over the caller's reference to SHM.  Returns
+   -1 if T is full or memory is exhausted. */
+int fdtable_alloc_shm(struct fdtable *t, struct shm *shm) {
+    struct fd_entry e = {.shm = shm};
+
+    ASSERT(shm != NULL);
+    return alloc(t, &e);
+}
+
+/* Returns the file open as FD in T, or a null pointer if FD is
+   not in use or does not refer to a file. */
+struct file *fdtable_get(const struct fdtable *t, int fd) {
+    return fd >= FD_FIRST && fd < t->size ? t->entries[fd].file : NULL;
+}
+
+/* Returns what FD refers to in T, or a null pointer if FD is not
+   in use. */
+const struct fd_entry *fdtable_lookup(const struct fdtable *t, int fd) {
+    if (fd < FD_FIRST || fd >= t->size || !bitmap_test(t->used, fd))
+        return NULL;
+    return &t->entries[fd];
+}
+
+/* Removes FD from T and closes whatever it referred to.
+   Returns true if successful, false if FD was not in use. */
+bool fdtable_close(struct fdtable *t, int fd) {
+    if (fdtable_lookup(t, fd) == NULL)
+        return false;
+
+    entry_close(&t->entries[fd]);
+    bitmap_reset(t->used, fd);
+    return true;
+}
+
+/* Duplicates FD onto the lowest fd not in use in T and returns
+   the new fd.  Both fds then refer to the same open file, sharing
+   its position, to the same end of the same pipe, or to the same
+   shared memory segment.  The new fd starts out with a copy of
+   FD's flags.  Returns -1 if FD is not in use, T is full, or
+   memory is exhausted. */
+int fdtable_dup(struct fdtable *t, int fd) {
+    const struct fd_entry *e = fdtable_lookup(t, fd);
+    struct fd_entry copy;
+    int new_fd;
+
+    if (e == NULL)
+        return -1;
+    entry_dup(&copy, e);
+    new_fd = alloc(t, &copy);
+    if (new_fd < 0)
+        entry_close(&copy);
+    return new_fd;
+}
+
+/* Duplicates OLD_FD onto NEW_FD in T, as in fdtable_dup(), first
+   closing whatever NEW_FD referred to.  Returns NEW_FD if
+   successful, -1 if OLD_FD is not in use, NEW_FD is out of
+   range, or memory is exhausted. */
+int fdtable_dup2(struct fdtable *t, int old_fd, int new_fd) {
+    const struct fd_entry *e = fdtable_lookup(t, old_fd);
+    struct fd_entry copy;
+
+    if (e == NULL || new_fd < FD_FIRST)
+        return -1;
+    if (new_fd == old_fd)
+        return new_fd;
+
+    entry_dup(&copy, e);
+    fdtable_close(t, new_fd);
+    if (!install(t, new_fd, &copy)) {
+        entry_close(&copy);
+        return -1;
+    }
+    return new_fd;
+}
+
+/* Returns FD's O_* flags in T, or -1 if FD is not in use.  The
+   console fds are always in use. */
+int fdtable_get_flags(const struct fdtable *t, int fd) {
+    const struct fd_entry *e;
+
+    if (fd >= 0 && fd < FD_FIRST)
+        return t->console_flags[fd];
+    e = fdtable_lookup(t, fd);
+    return e != NULL ? e->flags : -1;
+}
+
+/* Sets FD's O_* flags in T to FLAGS.  Returns true if
+   successful, false if FD is not in use. */
+bool fdtable_set_flags(struct fdtable *t, int fd, int flags) {
+    if (fd >= 0 && fd < FD_FIRST)
+        t->console_flags[fd] = flags;
+    else if (fdtable_lookup(t, fd) != NULL)
+        t->entries[fd].flags = flags;
+    else
+        return false;
+    return true;
+}
+
+/* Adds E to T under the lowest fd not in use and returns the
+   fd, or -1 if T is full or memory is exhausted. */
+static int alloc(struct fdtable *t, const struct fd_entry *e) {
+    size_t fd = BITMAP_ERROR;
+
+    if (t->used != NULL)
+        fd = bitmap_scan(t->used, FD_FIRST, 1, false);
+    if (fd == BITMAP_ERROR) {
+        fd = t->size > FD_FIRST ? t->size : FD_FIRST;
+        if (!grow(t, fd + 1))
+            return -1;
+    }
+
+    bitmap_mark(t->used, fd);
+    t->entries[fd] = *e;
+    return fd;
+}
+
+/* Adds E to T under FD, which must not be in use.  Returns true
+   if successful, false if FD is out of range or memory is
+   exhausted. */
+static bool install(struct fdtable *t, int fd, const struct fd_entry *e) {
+    ASSERT(fdtable_lookup(t, fd) == NULL);
+
+    if (fd < FD_FIRST || (fd >= t->size && !grow(t, fd + 1)))
+        return false;
+
+    bitmap_mark(t->used, fd);
+    t->entries[fd] = *e;
+    return true;
+}
+
+/* Makes DST refer to the same thing as SRC, taking a new
+   reference to it. */
+static void entry_dup(struct fd_entry *dst, const struct fd_entry *src) {
+    *dst = *src;
+    if (src->file != NULL)
+        dst->file = file_dup(src->file);
+    else if (src->pipe != NULL)
+        dst->pipe = pipe_dup(src->pipe, src->writer);
+    else
+        dst->shm = shm_dup(src->shm);
+}
+
+/* Drops E's reference to whatever it refers to, if anything,
+   and clears E. */
+static void entry_close(struct fd_entry *e) {
+    if (e->file != NULL)
+        file_close(e->file);
+    else if (e->pipe != NULL)
+        pipe_close(e->pipe, e->writer);
+    else if (e->shm != NULL)
+        shm_close(e->shm);
+    e->file = NULL;
+    e->pipe = NULL;
+    e->shm = NULL;
+}
+
+/* Enlarges T to have room for at least MIN_SIZE fds, at least
+   doubling its size.  Returns true if successful, false if
+   MIN_SIZE is too big or memory is exhausted. */
+static bool grow(struct fdtable *t, int min_size) {
+    struct fd_entry *entries;
+    struct bitmap *used;
+    int size, fd;
+
+    if (min_size > FDTABLE_MAX)
+        return false;
+    size = t->size > 0 ? t->size * 2 : FDTABLE_MIN;
+    if (size < min_size)
+        size = min_size;
+    if (size > FDTABLE_MAX)
+        size = FDTABLE_MAX;
+
+    entries = calloc(size, sizeof *entries);
+    used = bitmap_create(size);
+    if (entries == NULL || used == NULL) {
+        free(entries);
+        if (used != NULL)
+            bitmap_destroy(used);
+        return false;
+    }
+
+    /* The console fds are never free. */
+    bitmap_set_multiple(used, 0, FD_FIRST, true);
+    for (fd = FD_FIRST; fd < t->size; fd++)
+        if (bitmap_test(t->used, fd)) {
+            entries[fd] = t->entries[fd];
+            bitmap_mark(used, fd);
+        }
+
+    free(t->entries);
+    if (t->used != NULL)
+        bitmap_destroy(t->used);
+    t->entries = entries;
+    t->used = used;
+    t->size = size;
+    return true;
+}
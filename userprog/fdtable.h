@@ -0,0 +1,51 @@
+#ifndef USERPROG_FDTABLE_H
+#define USERPROG_FDTABLE_H
+
+#include <stdbool.h>
+
+struct file;
+struct pipe;
+struct shm;
+
+/* File descriptors 0 and 1 are the console and never appear in
+   the table.  Files get descriptors starting from here. */
+#define FD_FIRST 2
+
+/* What a file descriptor refers to: an open file, one end of a
+   pipe, or a shared memory segment.  Exactly one of FILE, PIPE,
+   and SHM is non-null in an fd that is in use. */
+struct fd_entry {
+    struct file *file; /* Open file, or null. */
+    struct pipe *pipe; /* Pipe, or null. */
+    bool writer; /* For a pipe, true for the write end. */
+    struct shm *shm; /* Shared memory segment, or null. */
+    int flags; /* O_* flags, from <fcntl.h>. */
+};
+
+/* A process's table of open files, indexed by file descriptor.
+   The arrays are allocated on the heap when the first file is
+   opened and grow as needed, so the table takes up no space in
+   the thread's page. */
+struct fdtable {
+    struct fd_entry *entries; /* What each fd refers to. */
+    struct bitmap *used; /* Bit set for each fd in use. */
+    int size; /* Number of fds the arrays have room for. */
+    int console_flags[FD_FIRST]; /* O_* flags of the console fds. */
+};
+
+void fdtable_init(struct fdtable *);
+void fdtable_destroy(struct fdtable *);
+bool fdtable_copy(struct fdtable *dst, const struct fdtable *src);
+
+int fdtable_alloc(struct fdtable *, struct file *);
+int fdtable_alloc_pipe(struct fdtable *, struct pipe *, bool writer);
+int fdtable_alloc_shm(struct fdtable *, struct shm *);
+struct file *fdtable_get(const struct fdtable *, int fd);
+const struct fd_entry *fdtable_lookup(const struct fdtable *, int fd);
+bool fdtable_close(struct fdtable *, int fd);
+int fdtable_dup(struct fdtable *, int fd);
+int fdtable_dup2(struct fdtable *, int old_fd, int new_fd);
+int fdtable_get_flags(const struct fdtable *, int fd);
+bool fdtable_set_flags(struct fdtable *, int fd, int flags);
+
+#endif /* userprog/fdtable.h */
@@ -0,0 +1,237 @@
+#include "userprog/futex.h"
+
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <stdint.h>
+
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+#include "userprog/process.h"
+#include "userprog/shm.h"
+#include "userprog/uaccess.h"
+
+/* Fast user-space mutexes.
+
+   A futex is just an int in user memory.  User code manipulates
+   it with atomic instructions and only calls into the kernel to
+   sleep when it finds the int in a state that says it must wait,
+   or to wake sleepers when it finds the int in a state that says
+   someone is waiting.  The kernel keeps a queue of sleepers for
+   each int that has any.
+
+   An int in a shared memory segment is keyed by its physical
+   address, so that processes mapping the segment at different
+   virtual addresses still meet on the same queue.  Any other int
+   is private to its process and is keyed by the process and its
+   virtual address instead.  Its frame is no fixed point: after a
+   fork() it is shared copy-on-write, and the first write to it
+   moves it to a new frame, which would strand any sleepers keyed
+   by the old one. */
+
+/* Identifies a futex. */
+struct futex_key {
+    struct process *process; /* Owner if private, else null. */
+    uintptr_t addr; /* User address if private, else physical. */
+};
+
+/* Threads waiting on one futex. */
+struct futex_queue {
+    struct hash_elem elem; /* Element in QUEUES. */
+    struct futex_key key; /* The futex. */
+    struct list waiters; /* struct futex_waiter, oldest first. */
+};
+
+/* One thread waiting on a futex. */
+struct futex_waiter {
+    struct list_elem elem; /* Element in struct futex_queue. */
+    struct semaphore sema; /* Upped to wake the thread. */
+    struct process *process; /* Waiting thread's process. */
+    bool cancelled; /* Woken by futex_cancel()? */
+};
+
+/* Queues by key, and a lock that protects the table, every queue
+   in it, and the check of a futex's value against what a waiter
+   expects. */
+static struct hash queues;
+static struct lock futex_lock;
+
+static hash_hash_func queue_hash;
+static hash_less_func queue_less;
+static bool get_key(const int *uaddr, struct futex_key *);
+static struct futex_queue *find_queue(const struct futex_key *);
+
+/* Initializes the futex subsystem. */
+void futex_init(void) {
+    hash_init(&queues, queue_hash, queue_less, NULL);
+    lock_init_named(&futex_lock, "futex");
+}
+
+/* If the int at UADDR equals EXPECTED, sleeps until another
+   thread calls futex_wake() on the same int and returns 0.
+   Otherwise returns -1 at once.  The comparison and going to
+   sleep are atomic with respect to futex_wake(), so a wakeup
+   that follows a change to the int cannot be missed.  Also
+   returns -1 if UADDR is not aligned or not mapped, memory is
+   exhausted, or the process is exiting, in which case
+   futex_cancel() cuts short any wait. */
+int futex_wait(int *uaddr, int expected) {
+    struct futex_queue *q;
+    struct futex_waiter w;
+    struct futex_key key;
+    int value;
+
+    if (!get_key(uaddr, &key))
+        return -1;
+
+    /* Read the int through its user address, with a copy routine
+       that fails instead of faulting if another thread has
+       unmapped it meanwhile. */
+    lock_acquire(&futex_lock);
+    if (!copy_from_user(&value, uaddr, sizeof value) || value != expected ||
+        thread_current()->process->exiting) {
+        lock_release(&futex_lock);
+        return -1;
+    }
+    q = find_queue(&key);
+    if (q == NULL) {
+        q = malloc(sizeof *q);
+        if (q == NULL) {
+            lock_release(&futex_lock);
+            return -1;
+        }
+        q->key = key;
+        list_init(&q->waiters);
+        hash_insert(&queues, &q->elem);
+    }
+    sema_init(&w.sema, 0);
+    w.process = thread_current()->process;
+    w.cancelled = false;
+    list_push_back(&q->waiters, &w.elem);
+    lock_release(&futex_lock);
+
+    sema_down(&w.sema);
+    return w.cancelled ? -1 : 0;
+}
+
+/* Wakes up to N threads sleeping in futex_wait() on the int at
+   UADDR, oldest first, and returns the number woken.  Returns -1
+   if UADDR is not aligned or not mapped. */
+int futex_wake(int *uaddr, int n) {
+    struct futex_queue *q;
+    struct futex_key key;
+    int woken = 0;
+
+    if (!get_key(uaddr, &key))
+        return -1;
+
+    lock_acquire(&futex_lock);
+    q = find_queue(&key);
+    if (q != NULL) {
+        while (woken < n && !list_empty(&q->waiters)) {
+            struct futex_waiter *w = list_entry(list_pop_front(&q->waiters),
+                                                struct futex_waiter, elem);
+            sema_up(&w->sema);
+            woken++;
+        }
+        if (list_empty(&q->waiters)) {
+            hash_delete(&queues, &q->elem);
+            free(q);
+        }
+    }
+    lock_release(&futex_lock);
+    return woken;
+}
+
+/* Wakes every thread of process P sleeping in futex_wait(), whose
+   calls then return -1.  Used to let the threads of a process
+   that is exiting notice. */
+void futex_cancel(struct process *p) {
+    struct hash_iterator i;
+    bool again = true;
+
+    lock_acquire(&futex_lock);
+    while (again) {
+        /* Deleting an empty queue spoils the iterator, so start
+           over after each one. */
+        again = false;
+        hash_first(&i, &queues);
+        while (!again && hash_next(&i)) {
+            struct futex_queue *q =
+                hash_entry(hash_cur(&i), struct futex_queue, elem);
+            struct list_elem *e = list_begin(&q->waiters);
+
+            while (e != list_end(&q->waiters)) {
+                struct futex_waiter *w =
+                    list_entry(e, struct futex_waiter, elem);
+                e = list_next(e);
+                if (w->process == p) {
+                    list_remove(&w->elem);
+                    w->cancelled = true;
+                    sema_up(&w->sema);
+                }
+            }
+            if (list_empty(&q->waiters)) {
+                hash_delete(&queues, &q->elem);
+                free(q);
+                again = true;
+            }
+        }
+    }
+    lock_release(&futex_lock);
+}
+
+/* Stores the key for the int at UADDR in the current process
+   into *KEY.  Returns false if UADDR is not aligned or not
+   mapped.  Looks up the page under the process's lock, because
+   another thread of the process may be unmapping it. */
+static bool get_key(const int *uaddr, struct futex_key *key) {
+    struct process *p = thread_current()->process;
+    void *kaddr;
+
+    if ((uintptr_t) uaddr % sizeof *uaddr != 0)
+        return false;
+
+    lock_acquire(&p->lock);
+    kaddr = pagedir_get_page(p->pagedir, uaddr);
+    if (kaddr != NULL && shm_is_mapped(p, pg_round_down(uaddr))) {
+        key->process = NULL;
+        key->addr = vtop(kaddr);
+    } else {
+        key->process = p;
+        key->addr = (uintptr_t) uaddr;
+    }
+    lock_release(&p->lock);
+    return kaddr != NULL;
+}
+
+/* Returns the queue for KEY, or a null pointer if no thread is
+   waiting on it.  The caller must hold FUTEX_LOCK. */
+static struct futex_queue *find_queue(const struct futex_key *key) {
+    struct futex_queue q;
+    struct hash_elem *e;
+
+    q.key = *key;
+    e = hash_find(&queues, &q.elem);
+    return e != NULL ? hash_entry(e, struct futex_queue, elem) : NULL;
+}
+
+/* Returns a hash of queue E's key. */
+static unsigned queue_hash(const struct hash_elem *e, void *aux UNUSED) {
+    const struct futex_key *key = &hash_entry(e, struct futex_queue, elem)->key;
+    return hash_bytes(key, sizeof *key);
+}
+
+/* Returns true if queue A's key is less than queue B's. */
+static bool queue_less(const struct hash_elem *a, const struct hash_elem *b,
+                       void *aux UNUSED) {
+    const struct futex_key *ka = &hash_entry(a, struct futex_queue, elem)->key;
+    const struct futex_key *kb = &hash_entry(b, struct futex_queue, elem)->key;
+
+    if (ka->process != kb->process)
+        return ka->process < kb->process;
+    return ka->addr < kb->addr;
+}
@@ -0,0 +1,12 @@
+#ifndef USERPROG_FUTEX_H
+#define USERPROG_FUTEX_H
+
+struct process;
+
+void futex_init(void);
+
+int futex_wait(int *uaddr, int expected);
+int futex_wake(int *uaddr, int n);
+void futex_cancel(struct process *);
+
+#endif /* userprog/futex.h */
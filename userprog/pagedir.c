@@ -1,29 +1,123 @@
 #include "userprog/pagedir.h"
 
+#include <round.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/palloc.h"
 #include "threads/pte.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Largest number of pages that pagedir_invalidate_range()
+   invalidates one at a time with INVLPG.  Beyond this, reloading
+   CR3 and refilling the TLB on demand is cheaper. */
+#define INVLPG_CEILING 32
+
+/* Statistics. */
+static long long cr3_load_cnt; /* # of page directory loads. */
+static long long cr3_skip_cnt; /* # of redundant loads avoided. */
+static long long full_flush_cnt; /* # of whole-TLB invalidations. */
+static long long page_flush_cnt; /* # of single-page invalidations. */
+static long long cow_share_cnt; /* # of pages shared by pagedir_fork(). */
+static long long cow_copy_cnt; /* # of shared pages copied on write. */
+static long long reap_cnt; /* # of page directories reaped. */
+static long long reap_sync_cnt; /* # destroyed at once, queue full. */
+
+/* Sharing user pages between page directories.
+
+   pagedir_fork() lets a new page directory map the same frames
+   as an existing one instead of copying them.  A page that was
+   writable becomes read-only and PTE_COW in both, so that the
+   first write to it faults, and pagedir_copy_on_write() then
+   gives the writer a copy of its own.
+
+   SHARE_CNT counts, for each frame of physical memory, how many
+   page directories map it besides the first.  A frame is freed
+   only when the last of them lets go of it, and a copy-on-write
+   fault in the last of them just makes the page writable again
+   instead of copying it. */
+static uint16_t *share_cnt;
+static struct lock share_lock;
 
 static uint32_t *active_pd(void);
+static void load_pd(uint32_t *);
 static void invalidate_pagedir(uint32_t *);
+static void invalidate_page(uint32_t *, const void *);
+static uint32_t *lookup_page(uint32_t *pd, const void *vaddr, bool create);
+static uint16_t *share_cnt_of(const void *kpage);
+static bool unshare_page(void *kpage);
+static void release_page(void *kpage);
+static thread_func reaper NO_RETURN;
+static void reap(uint32_t *pd);
+
+/* Deferred teardown.
+
+   Destroying a page directory means walking every user page
+   table and freeing each frame, which is too slow to do on the
+   way out of an exiting process, whose parent is waiting for it.
+   pagedir_destroy_later() instead queues the page directory for
+   the reaper thread, which runs at the lowest priority and hands
+   frames back to the page allocator in batches of REAP_BATCH.
+
+   At most REAP_MAX page directories wait at once.  Past that,
+   pagedir_destroy_later() does the work itself, so that exiting
+   processes can't pile up memory faster than it is reclaimed.
+   Anyone who runs out of memory can wait for the queue to drain
+   with pagedir_reap_wait() before giving up. */
+#define REAP_MAX 32
+#define REAP_BATCH 64
+static uint32_t *reap_queue[REAP_MAX]; /* Ring of pds to destroy. */
+static size_t reap_head; /* Index of the oldest in REAP_QUEUE. */
+static size_t reap_cnt_queued; /* Number in REAP_QUEUE. */
+static bool reap_busy; /* Is the reaper destroying one? */
+static struct lock reap_lock; /* Protects the above. */
+static struct condition reap_ready; /* Signaled when work is queued. */
+static struct condition reap_idle; /* Signaled when the queue drains. */
+
+/* Initializes page sharing. */
+void pagedir_init(void) {
+    size_t page_cnt = DIV_ROUND_UP(init_ram_pages * sizeof *share_cnt, PGSIZE);
+
+    share_cnt = palloc_get_multiple(PAL_ASSERT | PAL_ZERO, page_cnt);
+    lock_init_named(&share_lock, "pagedir");
+    lock_init_named(&reap_lock, "reaper");
+    cond_init(&reap_ready);
+    cond_init(&reap_idle);
+}
+
+/* Starts the reaper thread.  Page directories may not be
+   destroyed with pagedir_destroy_later() before this function is
+   called. */
+void pagedir_start_reaper(void) {
+    if (thread_create("reaper", PRI_MIN, reaper, NULL) == TID_ERROR)
+        PANIC("pagedir: can't create reaper");
+}
 
 /* Creates a new page directory that has mappings for kernel
    virtual addresses, but none for user virtual addresses.
    Returns the new page directory, or a null pointer if memory
-   allocation fails. */
+   allocation fails.
+
+   The kernel half of the new directory points to the same page
+   tables as init_page_dir, whose entries paging_init() marked
+   PTE_G, so switching to the new directory does not evict
+   kernel translations from the TLB. */
 uint32_t *pagedir_create(void) {
     uint32_t *pd = palloc_get_page(0);
+    if (pd == NULL && pagedir_reap_wait())
+        pd = palloc_get_page(0);
     if (pd != NULL)
         memcpy(pd, init_page_dir, PGSIZE);
     return pd;
 }
 
 /* Destroys page directory PD, freeing all the pages it
-   references. */
+   references that no other page directory shares. */
 void pagedir_destroy(uint32_t *pd) {
     uint32_t *pde;
 
@@ -31,6 +125,7 @@ void pagedir_destroy(uint32_t *pd) {
         return;
 
     ASSERT(pd != init_page_dir);
+    lock_acquire(&share_lock);
     for (pde = pd; pde < pd + pd_no(PHYS_BASE); pde++)
         if (*pde & PTE_P) {
             uint32_t *pt = pde_get_pt(*pde);
@@ -38,12 +133,221 @@ void pagedir_destroy(uint32_t *pd) {
 
             for (pte = pt; pte < pt + PGSIZE / sizeof *pte; pte++)
                 if (*pte & PTE_P)
-                    palloc_free_page(pte_get_page(*pte));
+                    release_page(pte_get_page(*pte));
             palloc_free_page(pt);
         }
+    lock_release(&share_lock);
+    palloc_free_page(pd);
+}
+
+/* Destroys page directory PD, like pagedir_destroy(), but in the
+   reaper thread, if it has room for more work, instead of the
+   caller.  PD must not be active in any thread. */
+void pagedir_destroy_later(uint32_t *pd) {
+    if (pd == NULL)
+        return;
+
+    ASSERT(pd != init_page_dir);
+    lock_acquire(&reap_lock);
+    if (reap_cnt_queued < REAP_MAX) {
+        reap_queue[(reap_head + reap_cnt_queued++) % REAP_MAX] = pd;
+        cond_signal(&reap_ready, &reap_lock);
+        pd = NULL;
+    } else
+        reap_sync_cnt++;
+    lock_release(&reap_lock);
+
+    if (pd != NULL)
+        pagedir_destroy(pd);
+}
+
+/* Waits until the reaper has destroyed every page directory
+   queued so far.  Returns true if there were any, so that memory
+   may have been freed, false if there was nothing to wait for.
+   The caller must not hold any lock that the page allocator or
+   this file's functions acquire. */
+bool pagedir_reap_wait(void) {
+    bool waited;
+
+    lock_acquire(&reap_lock);
+    waited = reap_cnt_queued > 0 || reap_busy;
+    while (reap_cnt_queued > 0 || reap_busy)
+        cond_wait(&reap_idle, &reap_lock);
+    lock_release(&reap_lock);
+    return waited;
+}
+
+/* The reaper thread's function.  Destroys queued page
+   directories, oldest first. */
+static void reaper(void *aux UNUSED) {
+    for (;;) {
+        uint32_t *pd;
+
+        lock_acquire(&reap_lock);
+        while (reap_cnt_queued == 0) {
+            reap_busy = false;
+            cond_broadcast(&reap_idle, &reap_lock);
+            cond_wait(&reap_ready, &reap_lock);
+        }
+        pd = reap_queue[reap_head];
+        reap_head = (reap_head + 1) % REAP_MAX;
+        reap_cnt_queued--;
+        reap_busy = true;
+        reap_cnt++;
+        lock_release(&reap_lock);
+
+        reap(pd);
+    }
+}
+
+/* Frees page directory PD, its page tables, and the frames that
+   it alone maps, REAP_BATCH pages at a time.  Holds share_lock
+   only while gathering each batch, so that other processes can
+   fork and copy on write meanwhile. */
+static void reap(uint32_t *pd) {
+    void *batch[REAP_BATCH];
+    size_t batch_cnt = 0;
+    uint32_t *pde;
+
+    for (pde = pd; pde < pd + pd_no(PHYS_BASE); pde++)
+        if (*pde & PTE_P) {
+            uint32_t *pt = pde_get_pt(*pde);
+            uint32_t *pte;
+
+            lock_acquire(&share_lock);
+            for (pte = pt; pte < pt + PGSIZE / sizeof *pte; pte++)
+                if ((*pte & PTE_P) && unshare_page(pte_get_page(*pte))) {
+                    if (batch_cnt == REAP_BATCH) {
+                        lock_release(&share_lock);
+                        palloc_free_pages(batch, batch_cnt);
+                        batch_cnt = 0;
+                        lock_acquire(&share_lock);
+                    }
+                    batch[batch_cnt++] = pte_get_page(*pte);
+                }
+            lock_release(&share_lock);
+
+            if (batch_cnt == REAP_BATCH) {
+                palloc_free_pages(batch, batch_cnt);
+                batch_cnt = 0;
+            }
+            batch[batch_cnt++] = pt;
+        }
+    palloc_free_pages(batch, batch_cnt);
     palloc_free_page(pd);
 }
 
+/* Maps into DST, which must be a new page directory, the same
+   frames that SRC maps at the same user addresses, except for
+   pages for which SHAREABLE, passed each page and AUX, returns
+   false and pages that DST already maps.  Pages that are
+   writable in SRC become copy-on-write in both, so that each
+   page directory sees only its own writes.  Returns true if
+   successful, false if memory is exhausted, in which case DST
+   may have received some of the pages and should be
+   destroyed. */
+bool pagedir_fork(uint32_t *dst, uint32_t *src,
+                  bool (*shareable)(const void *upage, void *aux),
+                  void *aux) {
+    uint32_t *pde;
+    bool success = true;
+
+    ASSERT(dst != init_page_dir && src != init_page_dir);
+
+    lock_acquire(&share_lock);
+    for (pde = src; success && pde < src + pd_no(PHYS_BASE); pde++) {
+        uint32_t *pt;
+        size_t i;
+
+        if ((*pde & PTE_P) == 0)
+            continue;
+        pt = pde_get_pt(*pde);
+        for (i = 0; i < PGSIZE / sizeof *pt; i++) {
+            void *upage =
+                (void *) ((uintptr_t) (pde - src) << PDSHIFT | i << PTSHIFT);
+            uint32_t *dst_pte;
+
+            if ((pt[i] & PTE_P) == 0 || !shareable(upage, aux))
+                continue;
+            dst_pte = lookup_page(dst, upage, true);
+            if (dst_pte == NULL) {
+                success = false;
+                break;
+            }
+            if (*dst_pte & PTE_P)
+                continue;
+
+            /* Another thread of SRC's process may be running, so
+               it must not write through a stale TLB entry once
+               the page is shared. */
+            if (pt[i] & PTE_W) {
+                enum intr_level old_level = intr_disable();
+                pt[i] = (pt[i] & ~(uint32_t) PTE_W) | PTE_COW;
+                invalidate_page(src, upage);
+                intr_set_level(old_level);
+            }
+            *dst_pte = pt[i] & ~(uint32_t) (PTE_A | PTE_D);
+            (*share_cnt_of(pte_get_page(pt[i])))++;
+            cow_share_cnt++;
+        }
+    }
+    lock_release(&share_lock);
+    return success;
+}
+
+/* Called on a write fault at user page UPAGE in PD.  If UPAGE is
+   a copy-on-write page, makes it writable, first copying it into
+   a frame of its own if other page directories still share its
+   frame, and returns true.  Also returns true if UPAGE is
+   already writable, as it may be if another thread got there
+   first.  Returns false if UPAGE is not mapped writable or
+   copy-on-write, or if memory is exhausted. */
+bool pagedir_copy_on_write(uint32_t *pd, const void *upage) {
+    uint32_t *pte;
+    bool success = false;
+
+    ASSERT(pg_ofs(upage) == 0);
+    ASSERT(is_user_vaddr(upage));
+
+    lock_acquire(&share_lock);
+    pte = lookup_page(pd, upage, false);
+    if (pte != NULL && (*pte & PTE_P) != 0) {
+        if (*pte & PTE_W)
+            success = true;
+        else if (*pte & PTE_COW) {
+            void *kpage = pte_get_page(*pte);
+            uint16_t *cnt = share_cnt_of(kpage);
+
+            if (*cnt > 0) {
+                void *copy = palloc_get_page(PAL_USER);
+                if (copy != NULL) {
+                    memcpy(copy, kpage, PGSIZE);
+                    (*cnt)--;
+                    *pte = vtop(copy) | (*pte & PTE_FLAGS);
+                    cow_copy_cnt++;
+                }
+                kpage = copy;
+            }
+            if (kpage != NULL) {
+                *pte = (*pte & ~(uint32_t) PTE_COW) | PTE_W;
+                invalidate_page(pd, upage);
+                success = true;
+            }
+        }
+    }
+    lock_release(&share_lock);
+    return success;
+}
+
+/* Gives up a page directory's claim on user page KPAGE, which
+   the caller has already unmapped from it, and frees KPAGE
+   unless another page directory shares it. */
+void pagedir_release_page(void *kpage) {
+    lock_acquire(&share_lock);
+    release_page(kpage);
+    lock_release(&share_lock);
+}
+
 /* Returns the address of the page table entry for virtual
    address VADDR in page directory PD.
    If PD does not have a page table for VADDR, behavior depends
@@ -72,6 +376,14 @@ static uint32_t *lookup_page(uint32_t *pd, const void *vaddr, bool create) {
             return NULL;
     }
 
+    /* A 4 MB page has no page table entry to return.  paging_init()
+       uses them only for the kernel's direct map, which is never
+       looked up here. */
+    if (*pde & PTE_PS) {
+        ASSERT(!create);
+        return NULL;
+    }
+
     /* Return the page table entry. */
     pt = pde_get_pt(*pde);
     return &pt[pt_no(vaddr)];
@@ -135,10 +447,68 @@ void pagedir_clear_page(uint32_t *pd, void *upage) {
     pte = lookup_page(pd, upage, false);
     if (pte != NULL && (*pte & PTE_P) != 0) {
         *pte &= ~PTE_P;
-        invalidate_pagedir(pd);
+        invalidate_page(pd, upage);
     }
 }
 
+/* Marks the PAGE_CNT user virtual pages starting at UPAGE "not
+   present" in page directory PD, as if by pagedir_clear_page()
+   on each of them, but invalidates the TLB only once at the end
+   with pagedir_invalidate_range().
+   None of the pages need be mapped. */
+void pagedir_clear_range(uint32_t *pd, void *upage, size_t page_cnt) {
+    uint8_t *page = upage;
+    size_t cleared = 0;
+    size_t i;
+
+    ASSERT(pg_ofs(upage) == 0);
+    ASSERT(is_user_vaddr(upage));
+    ASSERT(page_cnt <= pg_no(PHYS_BASE) - pg_no(upage));
+
+    for (i = 0; i < page_cnt; i++) {
+        uint32_t *pte = lookup_page(pd, page + i * PGSIZE, false);
+        if (pte != NULL && (*pte & PTE_P) != 0) {
+            *pte &= ~PTE_P;
+            cleared++;
+        }
+    }
+
+    if (cleared > 0)
+        pagedir_invalidate_range(pd, upage, page_cnt);
+}
+
+/* Invalidates any TLB entries for the PAGE_CNT user virtual
+   pages starting at UPAGE, for callers that modified several
+   PTEs in PD and want to pay for a single invalidation.
+   Does nothing if PD is not the active page directory.
+
+   Small ranges are invalidated page by page, so that the rest of
+   the process's translations stay cached; ranges of more than
+   INVLPG_CEILING pages flush the whole TLB instead. */
+void pagedir_invalidate_range(uint32_t *pd, const void *upage,
+                              size_t page_cnt) {
+    const uint8_t *page = upage;
+    size_t i;
+
+    ASSERT(pg_ofs(upage) == 0);
+
+    if (active_pd() != pd)
+        return;
+
+    if (page_cnt > INVLPG_CEILING)
+        invalidate_pagedir(pd);
+    else
+        for (i = 0; i < page_cnt; i++)
+            invalidate_page(pd, page + i * PGSIZE);
+}
+
+/* Returns true if virtual page VPAGE is mapped writable in PD,
+   false if it is mapped read-only or not mapped at all. */
+bool pagedir_is_writable(uint32_t *pd, const void *vpage) {
+    uint32_t *pte = lookup_page(pd, vpage, false);
+    return pte != NULL && (*pte & (PTE_P | PTE_W)) == (PTE_P | PTE_W);
+}
+
 /* Returns true if the PTE for virtual page VPAGE in PD is dirty,
    that is, if the page has been modified since the PTE was
    installed.
@@ -157,7 +527,7 @@ void pagedir_set_dirty(uint32_t *pd, const void *vpage, bool dirty) {
             *pte |= PTE_D;
         else {
             *pte &= ~(uint32_t) PTE_D;
-            invalidate_pagedir(pd);
+            invalidate_page(pd, vpage);
         }
     }
 }
@@ -180,23 +550,35 @@ void pagedir_set_accessed(uint32_t *pd, const void *vpage, bool accessed) {
             *pte |= PTE_A;
         else {
             *pte &= ~(uint32_t) PTE_A;
-            invalidate_pagedir(pd);
+            invalidate_page(pd, vpage);
         }
     }
 }
 
 /* Loads page directory PD into the CPU's page directory base
-   register. */
+   register.  If PD is null, loads the kernel-only page
+   directory.  Does nothing if PD is already active, because
+   writing CR3 flushes every non-global TLB entry. */
 void pagedir_activate(uint32_t *pd) {
     if (pd == NULL)
         pd = init_page_dir;
 
-    /* Store the physical address of the page directory into CR3
-       aka PDBR (page directory base register).  This activates our
-       new page tables immediately.  See [IA32-v2a] "MOV--Move
-       to/from Control Registers" and [IA32-v3a] 3.7.5 "Base
-       Address of the Page Directory". */
-    asm volatile("movl %0, %%cr3" : : "r"(vtop(pd)) : "memory");
+    if (active_pd() == pd)
+        cr3_skip_cnt++;
+    else
+        load_pd(pd);
+}
+
+/* Prints page directory statistics. */
+void pagedir_print_stats(void) {
+    printf("Paging: %lld page directory loads, %lld skipped\n", cr3_load_cnt,
+           cr3_skip_cnt);
+    printf("Paging: %lld full TLB flushes, %lld single-page flushes\n",
+           full_flush_cnt, page_flush_cnt);
+    printf("Paging: %lld pages shared by fork, %lld copied on write\n",
+           cow_share_cnt, cow_copy_cnt);
+    printf("Paging: %lld page directories reaped, %lld destroyed at once\n",
+           reap_cnt, reap_sync_cnt);
 }
 
 /* Returns the currently active page directory. */
@@ -210,6 +592,18 @@ static uint32_t *active_pd(void) {
     return ptov(pd);
 }
 
+/* Unconditionally loads PD into CR3.  This also flushes all of
+   the TLB entries that are not marked global. */
+static void load_pd(uint32_t *pd) {
+    /* Store the physical address of the page directory into CR3
+       aka PDBR (page directory base register).  This activates our
+       new page tables immediately.  See [IA32-v2a] "MOV--Move
+       to/from Control Registers" and [IA32-v3a] 3.7.5 "Base
+       Address of the Page Directory". */
+    asm volatile("movl %0, %%cr3" : : "r"(vtop(pd)) : "memory");
+    cr3_load_cnt++;
+}
+
 /* Seom page table changes can cause the CPU's translation
    lookaside buffer (TLB) to become out-of-sync with the page
    table.  When this happens, we have to "invalidate" the TLB by
@@ -220,8 +614,46 @@ static uint32_t *active_pd(void) {
    the TLB, so there is no need to invalidate anything.) */
 static void invalidate_pagedir(uint32_t *pd) {
     if (active_pd() == pd) {
-        /* Re-activating PD clears the TLB.  See [IA32-v3a] 3.12
-           "Translation Lookaside Buffers (TLBs)". */
-        pagedir_activate(pd);
+        /* Re-loading PD clears the TLB.  See [IA32-v3a] 3.12
+           "Translation Lookaside Buffers (TLBs)".  User mappings
+           are never global, so they are all flushed. */
+        load_pd(pd);
+        full_flush_cnt++;
     }
 }
+
+/* Invalidates the TLB entry for VADDR if PD is the active page
+   directory, leaving the rest of the TLB intact.  See
+   [IA32-v2a] "INVLPG". */
+static void invalidate_page(uint32_t *pd, const void *vaddr) {
+    if (active_pd() == pd) {
+        asm volatile("invlpg (%0)" : : "r"(vaddr) : "memory");
+        page_flush_cnt++;
+    }
+}
+
+/* Returns KPAGE's entry in share_cnt. */
+static uint16_t *share_cnt_of(const void *kpage) {
+    return &share_cnt[vtop(kpage) >> PGBITS];
+}
+
+/* Drops a claim on user page KPAGE.  Returns true if it was the
+   last, so that the caller should free KPAGE, false if other
+   page directories still map it.  The caller must hold
+   share_lock. */
+static bool unshare_page(void *kpage) {
+    uint16_t *cnt = share_cnt_of(kpage);
+
+    ASSERT(lock_held_by_current_thread(&share_lock));
+    if (*cnt == 0)
+        return true;
+    (*cnt)--;
+    return false;
+}
+
+/* Drops a reference to KPAGE, freeing it if there was only one.
+   The caller must hold share_lock. */
+static void release_page(void *kpage) {
+    if (unshare_page(kpage))
+        palloc_free_page(kpage);
+}
@@ -0,0 +1,400 @@
+#include "userprog/pipe.h"
+
+#include <debug.h>
+#include <list.h>
+#include <poll.h>
+#include <stdint.h>
+
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "threads/waitq.h"
+#include "userprog/pagedir.h"
+#include "userprog/process.h"
+#include "userprog/uaccess.h"
+
+/* Size of a pipe's ring buffer. */
+#define PIPE_SIZE PGSIZE
+
+/* Most whole pages a pipe holds at once, besides its ring. */
+#define PIPE_PAGE_MAX 8
+
+/* A pipe.
+
+   Writes go into a one-page ring buffer, except that each whole,
+   page-aligned page of a write is copied into a page of its own,
+   which is queued on PAGES.  A whole, page-aligned read of a
+   queued page then maps it into the reader's address space in
+   place of the reader's own page, instead of copying it, so that
+   big transfers copy the data once instead of twice.
+
+   To keep the bytes in order, data goes into the ring only while
+   PAGES is empty and onto PAGES only while the ring is empty, so
+   at most one of them holds data at any time. */
+struct pipe {
+    struct lock lock;
+    struct waitq pollers; /* Woken whenever the state below changes. */
+    int readers; /* Open read ends. */
+    int writers; /* Open write ends. */
+
+    uint8_t *ring; /* PIPE_SIZE-byte ring buffer. */
+    size_t head; /* Total bytes ever taken out of the ring. */
+    size_t tail; /* Total bytes ever put into the ring. */
+
+    struct list pages; /* Queued struct pipe_page, oldest first. */
+    size_t page_cnt; /* Number of pages on PAGES. */
+};
+
+/* A whole page written to a pipe. */
+struct pipe_page {
+    struct list_elem elem; /* Element in struct pipe's PAGES. */
+    uint8_t *kpage; /* Data, in a page from the user pool. */
+    size_t ofs; /* Bytes already read. */
+};
+
+static int put_bytes(struct pipe *, const uint8_t *, size_t);
+static int put_page(struct pipe *, const uint8_t *);
+static int take_bytes(struct pipe *, uint8_t *, size_t);
+static int take_page(struct pipe *, uint8_t *, size_t);
+static bool swap_page(uint8_t *upage, void *kpage);
+static bool wait_change(struct pipe *);
+
+/* Creates a new, empty pipe with one open read end and one open
+   write end.  Returns the pipe, or a null pointer if memory is
+   exhausted. */
+struct pipe *pipe_create(void) {
+    struct pipe *p = malloc(sizeof *p);
+
+    if (p == NULL)
+        return NULL;
+    p->ring = palloc_get_page(0);
+    if (p->ring == NULL) {
+        free(p);
+        return NULL;
+    }
+
+    lock_init_named(&p->lock, "pipe");
+    waitq_init(&p->pollers);
+    p->readers = p->writers = 1;
+    p->head = p->tail = 0;
+    list_init(&p->pages);
+    p->page_cnt = 0;
+    return p;
+}
+
+/* Opens another reference to P's read end, or its write end if
+   WRITER is true, and returns P. */
+struct pipe *pipe_dup(struct pipe *p, bool writer) {
+    lock_acquire(&p->lock);
+    if (writer)
+        p->writers++;
+    else
+        p->readers++;
+    lock_release(&p->lock);
+    return p;
+}
+
+/* Closes a reference to P's read end, or its write end if
+   WRITER is true.  Closing the last write end lets readers see
+   end of file; closing the last read end makes writes fail.  P
+   is freed once both ends are closed. */
+void pipe_close(struct pipe *p, bool writer) {
+    bool dead;
+
+    lock_acquire(&p->lock);
+    if (writer) {
+        ASSERT(p->writers > 0);
+        if (--p->writers == 0)
+            waitq_wake(&p->pollers);
+    } else {
+        ASSERT(p->readers > 0);
+        if (--p->readers == 0)
+            waitq_wake(&p->pollers);
+    }
+    dead = p->readers == 0 && p->writers == 0;
+    lock_release(&p->lock);
+
+    if (dead) {
+        while (!list_empty(&p->pages)) {
+            struct pipe_page *pp =
+                list_entry(list_pop_front(&p->pages), struct pipe_page, elem);
+            palloc_free_page(pp->kpage);
+            free(pp);
+        }
+        palloc_free_page(p->ring);
+        free(p);
+    }
+}
+
+/* Reads up to SIZE bytes from P into user buffer BUFFER.  Waits
+   until P holds some data or has no open write ends, then
+   returns what is there without waiting for more, so the result
+   may be short.  Returns the number of bytes read, which is 0 at
+   end of file.  If NONBLOCK is true and P is empty but still has
+   writers, returns -1 at once instead of waiting.  Also returns
+   -1 if the process is told to exit while it waits.  Returns
+   PIPE_BAD_BUFFER if BUFFER turns out not to be mapped
+   writable. */
+int pipe_read(struct pipe *p, void *buffer_, size_t size, bool nonblock) {
+    uint8_t *buffer = buffer_;
+    size_t bytes_read = 0;
+    bool bad = false;
+
+    lock_acquire(&p->lock);
+    while (size > 0 && p->tail == p->head && list_empty(&p->pages) &&
+           p->writers > 0) {
+        if (nonblock || !wait_change(p)) {
+            lock_release(&p->lock);
+            return -1;
+        }
+    }
+
+    while (bytes_read < size) {
+        uint8_t *dst = buffer + bytes_read;
+        size_t left = size - bytes_read;
+        int n = list_empty(&p->pages) ? take_bytes(p, dst, left)
+                                      : take_page(p, dst, left);
+        if (n < 0)
+            bad = true;
+        if (n <= 0)
+            break;
+        bytes_read += n;
+    }
+    if (bytes_read > 0)
+        waitq_wake(&p->pollers);
+    lock_release(&p->lock);
+    return bad ? PIPE_BAD_BUFFER : (int) bytes_read;
+}
+
+/* Writes the SIZE bytes in user buffer BUFFER to P, waiting for
+   room as needed.  Returns the number of bytes written, which is
+   short only if the last read end is closed or the process is
+   told to exit partway through, or -1 if that happens before
+   anything is written.  Returns PIPE_BAD_BUFFER if BUFFER turns
+   out not to be mapped.
+
+   If NONBLOCK is true, writes only as much as fits without
+   waiting, and returns -1 if nothing fits. */
+int pipe_write(struct pipe *p, const void *buffer_, size_t size,
+               bool nonblock) {
+    const uint8_t *buffer = buffer_;
+    size_t written = 0;
+    bool bad = false;
+    bool stopped = false;
+    int result;
+
+    lock_acquire(&p->lock);
+    while (written < size && p->readers > 0) {
+        const uint8_t *src = buffer + written;
+        size_t left = size - written;
+        int n = pg_ofs(src) == 0 && left >= PGSIZE ? put_page(p, src)
+                                                   : put_bytes(p, src, left);
+
+        /* A page that can't be queued can still go into the ring
+           if we may not wait for the ring to empty. */
+        if (n == 0 && nonblock)
+            n = put_bytes(p, src, left);
+        if (n < 0) {
+            bad = true;
+            break;
+        } else if (n > 0) {
+            written += n;
+            waitq_wake(&p->pollers);
+        } else if (nonblock || !wait_change(p)) {
+            stopped = true;
+            break;
+        }
+    }
+    if (bad)
+        result = PIPE_BAD_BUFFER;
+    else if (written == 0 && (p->readers == 0 || stopped))
+        result = -1;
+    else
+        result = written;
+    lock_release(&p->lock);
+    return result;
+}
+
+/* Returns the POLL* events that are ready on P's read end, or
+   its write end if WRITER is true.  If POLLER is non-null, first
+   adds POLLER to P's pollers, using entry E, so that it is woken
+   whenever P's state changes.  The caller must keep its own
+   reference to that end of P until it is done with POLLER. */
+unsigned pipe_poll(struct pipe *p, bool writer, struct poller *poller,
+                   struct waitq_entry *e) {
+    unsigned events = 0;
+
+    lock_acquire(&p->lock);
+    if (poller != NULL)
+        poller_add(poller, &p->pollers, e);
+    if (writer) {
+        if (p->readers == 0)
+            events |= POLLERR;
+        else if ((list_empty(&p->pages) && p->tail - p->head < PIPE_SIZE) ||
+                 (p->tail == p->head && p->page_cnt < PIPE_PAGE_MAX))
+            events |= POLLOUT;
+    } else {
+        if (p->tail != p->head || !list_empty(&p->pages))
+            events |= POLLIN;
+        if (p->writers == 0)
+            events |= POLLHUP;
+    }
+    lock_release(&p->lock);
+    return events;
+}
+
+/* Copies up to SIZE bytes from user address SRC into P's ring,
+   if no pages are queued.  Returns the number of bytes copied,
+   which is 0 if the ring is full or pages are queued, or -1 if
+   SRC is bad. */
+static int put_bytes(struct pipe *p, const uint8_t *src, size_t size) {
+    size_t ofs = p->tail % PIPE_SIZE;
+    size_t n = PIPE_SIZE - (p->tail - p->head);
+    size_t first;
+
+    if (!list_empty(&p->pages))
+        return 0;
+    if (n > size)
+        n = size;
+    first = n < PIPE_SIZE - ofs ? n : PIPE_SIZE - ofs;
+    if (!copy_from_user(p->ring + ofs, src, first) ||
+        !copy_from_user(p->ring, src + first, n - first))
+        return -1;
+    p->tail += n;
+    return n;
+}
+
+/* Copies the page at user address SRC into a new page and queues
+   it on P, if the ring is empty and P has room for another page.
+   Returns PGSIZE if successful, 0 if there is no room, or -1 if
+   SRC is bad.  Falls back to the ring if no page can be
+   allocated. */
+static int put_page(struct pipe *p, const uint8_t *src) {
+    struct pipe_page *pp;
+
+    if (p->tail != p->head || p->page_cnt >= PIPE_PAGE_MAX)
+        return 0;
+
+    pp = malloc(sizeof *pp);
+    if (pp != NULL)
+        pp->kpage = palloc_get_page(PAL_USER);
+    if (pp == NULL || pp->kpage == NULL) {
+        free(pp);
+        return put_bytes(p, src, PGSIZE);
+    }
+
+    if (!copy_from_user(pp->kpage, src, PGSIZE)) {
+        palloc_free_page(pp->kpage);
+        free(pp);
+        return -1;
+    }
+    pp->ofs = 0;
+    list_push_back(&p->pages, &pp->elem);
+    p->page_cnt++;
+    return PGSIZE;
+}
+
+/* Copies up to SIZE bytes out of P's ring into user address DST.
+   Returns the number of bytes copied, or -1 if DST is bad, in
+   which case the bytes stay in the ring. */
+static int take_bytes(struct pipe *p, uint8_t *dst, size_t size) {
+    size_t ofs = p->head % PIPE_SIZE;
+    size_t n = p->tail - p->head;
+    size_t first;
+
+    if (n > size)
+        n = size;
+    first = n < PIPE_SIZE - ofs ? n : PIPE_SIZE - ofs;
+    if (!copy_to_user(dst, p->ring + ofs, first) ||
+        !copy_to_user(dst + first, p->ring, n - first))
+        return -1;
+    p->head += n;
+    return n;
+}
+
+/* Reads up to SIZE bytes from the page at the front of P's queue
+   into user buffer DST, handing over the page itself if the
+   whole of it goes to a page-aligned DST.  Frees the page once
+   it has been read completely.  Returns the number of bytes
+   read, or -1 if DST is bad. */
+static int take_page(struct pipe *p, uint8_t *dst, size_t size) {
+    struct pipe_page *pp =
+        list_entry(list_front(&p->pages), struct pipe_page, elem);
+    size_t n = PGSIZE - pp->ofs;
+
+    if (n > size)
+        n = size;
+    if (n == PGSIZE && swap_page(dst, pp->kpage))
+        pp->kpage = NULL;
+    else if (!copy_to_user(dst, pp->kpage + pp->ofs, n))
+        return -1;
+
+    pp->ofs += n;
+    if (pp->ofs == PGSIZE) {
+        list_remove(&pp->elem);
+        p->page_cnt--;
+        if (pp->kpage != NULL)
+            palloc_free_page(pp->kpage);
+        free(pp);
+    }
+    return n;
+}
+
+/* Maps KPAGE at user page UPAGE in the current process in place
+   of the writable page mapped there now, and frees the page it
+   replaces.  Returns true if successful, false without doing
+   anything if UPAGE is not page-aligned, not mapped writable, or
+   not the process's alone to give up.  Holds the process's lock
+   throughout, so that no other thread can unmap UPAGE between
+   the checks and the swap. */
+static bool swap_page(uint8_t *upage, void *kpage) {
+    struct process *p = thread_current()->process;
+    uint32_t *pd = thread_current()->pagedir;
+    void *old = NULL;
+
+    if (pg_ofs(upage) != 0)
+        return false;
+
+    lock_acquire(&p->lock);
+    if (process_owns_page(upage) && pagedir_is_writable(pd, upage))
+        old = pagedir_get_page(pd, upage);
+    if (old != NULL) {
+        /* UPAGE already has a page table, so this can't fail. */
+        pagedir_clear_page(pd, upage);
+        if (!pagedir_set_page(pd, upage, kpage, true))
+            PANIC("pipe: can't remap user page %p", upage);
+    }
+    lock_release(&p->lock);
+
+    if (old == NULL)
+        return false;
+    pagedir_release_page(old);
+    return true;
+}
+
+/* Releases P's lock, sleeps until P's state changes, and then
+   reacquires the lock.  P's lock must be held, and the caller
+   must have found P not ready while holding it.  Returns false
+   without sleeping if the current process is exiting, and also
+   wakes up early if it is told to exit meanwhile. */
+static bool wait_change(struct pipe *p) {
+    struct poller poller;
+    struct waitq_entry pipe_entry, exit_entry;
+    bool exiting;
+
+    ASSERT(lock_held_by_current_thread(&p->lock));
+
+    /* Every change to P wakes P's pollers while holding P's lock,
+       so one that comes after the caller's check wakes us. */
+    poller_init(&poller);
+    poller_add(&poller, &p->pollers, &pipe_entry);
+    exiting = process_poll_exit(&poller, &exit_entry);
+    lock_release(&p->lock);
+    if (!exiting)
+        poller_wait(&poller, -1);
+    poller_done(&poller);
+    lock_acquire(&p->lock);
+    return !exiting;
+}
@@ -0,0 +1,24 @@
+#ifndef USERPROG_PIPE_H
+#define USERPROG_PIPE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct pipe;
+struct poller;
+struct waitq_entry;
+
+/* Returned by pipe_read() and pipe_write() if the user buffer
+   turns out to be bad. */
+#define PIPE_BAD_BUFFER (-2)
+
+struct pipe *pipe_create(void);
+struct pipe *pipe_dup(struct pipe *, bool writer);
+void pipe_close(struct pipe *, bool writer);
+
+int pipe_read(struct pipe *, void *, size_t, bool nonblock);
+int pipe_write(struct pipe *, const void *, size_t, bool nonblock);
+unsigned pipe_poll(struct pipe *, bool writer, struct poller *,
+                   struct waitq_entry *);
+
+#endif /* userprog/pipe.h */
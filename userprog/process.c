@@ -1,43 +1,126 @@
 #include "userprog/process.h"
 
 #include <debug.h>
+#include <exec.h>
 #include <inttypes.h>
 #include <round.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "devices/timer.h"
 #include "filesys/directory.h"
 #include "filesys/file.h"
 #include "filesys/filesys.h"
 #include "threads/flags.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
+#include "userprog/futex.h"
 #include "userprog/gdt.h"
 #include "userprog/pagedir.h"
+#include "userprog/shm.h"
+#include "userprog/syscall.h"
 #include "userprog/tss.h"
+#include "userprog/uring.h"
 
 // static struct semaphore temporary;
 static thread_func start_process NO_RETURN;
+static thread_func start_thread NO_RETURN;
+static thread_func start_fork NO_RETURN;
 static bool load(const char *cmdline, void (**eip)(void), void **esp);
 static bool setup_arguments(const char *cmd_line, void **esp);
-
+static bool setup_thread_stack(void *func, void *aux, void **esp);
+static struct process *process_create(struct child_status *);
+static void process_free(struct process *);
+static struct process *parent_process(void);
+static void attach(struct process *, struct join_status *);
+static bool fork_shares(const void *upage, void *parent);
+static struct child_status *status_create(struct process *parent);
+static void status_release(struct child_status *);
+static void report_loaded(struct child_status *, bool success);
+static void notify_parent(struct child_status *);
+static struct child_status *find_child(struct process *, tid_t);
+static bool wait_loaded(struct child_status *);
+static void print_exit(struct process *, const char *name, int status);
+static void usage_add(struct rusage *dst, const struct rusage *src);
+
+/* Starting state for a process created by process_execute(),
+   freed by the new process once it has read it. */
 struct pargs {
     char *fn_copy;
-    struct child_status *child;
-    struct semaphore load_sema;
-    bool load_success;
+    struct process *process; /* Process to start. */
+};
+
+/* Starting state for a thread created by process_thread_create(),
+   which waits on STARTED until the thread is done with it. */
+struct tstart {
+    struct process *process; /* Process the thread joins. */
+    struct join_status *join_status; /* Process's record of it. */
+    void *start; /* User function to start at. */
+    void *func, *aux; /* Arguments to START. */
+    struct semaphore started; /* Upped once the thread is set up. */
+    bool success; /* Did it get a stack? */
 };
 
+/* Starting state for a process created by process_fork(), whose
+   creator waits on STARTED until the new process is done with
+   it. */
+struct fstart {
+    struct process *parent; /* Process to copy. */
+    struct process *process; /* New process. */
+    struct intr_frame frame; /* Where to start in user mode. */
+    void *ustack; /* Forking thread's stack, if not the first. */
+    struct semaphore started; /* Upped once the process is set up. */
+    bool success; /* Was it set up? */
+};
+
+/* Stands in for the process of a kernel thread, which has none,
+   when it starts and waits for processes.  Only its LOCK and
+   CHILDREN are used. */
+static struct process kernel_process;
+
+/* Print resource usage along with each process's exit status? */
+bool process_print_usage;
+
+/* Protects the members of every struct child_status marked "S",
+   and goes with every process's CHILD_CHANGED.  Children report
+   to their parents under this lock, rather than their parents'
+   locks, because a parent may exit at any time. */
+static struct lock status_lock;
+
+/* Initializes the process subsystem. */
+void process_init(void) {
+    lock_init_named(&status_lock, "child_status");
+    lock_init_named(&kernel_process.lock, "process");
+    list_init(&kernel_process.children);
+    cond_init(&kernel_process.child_changed);
+    waitq_init(&kernel_process.exit_waiters);
+}
+
 /* Starts a new thread running a user program loaded from
    FILENAME.  The new thread may be scheduled (and may even exit)
    before process_execute() returns.  Returns the new process's
-   thread id, or TID_ERROR if the thread cannot be created. */
-tid_t process_execute(const char *file_name) {
+   thread id, or TID_ERROR if the thread cannot be created.
+
+   If FLAGS includes EXEC_INHERIT_FDS, the new process starts out
+   with a copy of the current process's fd table, so that each of
+   its fds refers to the same thing as in the current process.
+   Otherwise it starts with no open files.
+
+   Unless FLAGS includes EXEC_ASYNC, waits for the new process to
+   load its program and returns TID_ERROR if it fails to.  With
+   EXEC_ASYNC, returns as soon as the thread exists, and the
+   caller can learn whether the load succeeded later with
+   process_load_status() or, once the process has exited, with
+   process_wait(). */
+tid_t process_execute(const char *file_name, int flags) {
+    struct process *parent = parent_process();
+    struct process *p;
     char *fn_copy;
     tid_t tid;
 
@@ -60,7 +143,7 @@ tid_t process_execute(const char *file_name) {
     char *save_ptr;
     char *prog_name = strtok_r(prog_name_copy, " ", &save_ptr);
 
-    struct child_status *child = palloc_get_page(0);
+    struct child_status *child = status_create(parent);
     if (child == NULL) {
         palloc_free_page(fn_copy);
         palloc_free_page(prog_name_copy);
@@ -75,16 +158,33 @@ tid_t process_execute(const char *file_name) {
         return TID_ERROR;
     }
 
-    child->tid = TID_ERROR; // Will be updated if thread_create succeeds
-    child->exit_code = -1;
-    child->waited = false;
-    sema_init(&child->exit_sema, 0);
-    list_push_back(&thread_current()->children, &child->elem); // Add to parent's list
+    p = process_create(child);
+    if (p != NULL && (flags & EXEC_INHERIT_FDS) &&
+        thread_current()->process != NULL) {
+        bool copied;
+
+        lock_acquire(&filesys_lock);
+        copied = fdtable_copy(&p->fds, &thread_current()->process->fds);
+        lock_release(&filesys_lock);
+        if (!copied) {
+            process_free(p);
+            p = NULL;
+        }
+    }
+    if (p == NULL) {
+        palloc_free_page(fn_copy);
+        palloc_free_page(prog_name_copy);
+        palloc_free_page(child);
+        palloc_free_page(args);
+        return TID_ERROR;
+    }
+
+    lock_acquire(&parent->lock);
+    list_push_back(&parent->children, &child->elem); // Add to parent's list
+    lock_release(&parent->lock);
 
     args->fn_copy = fn_copy;
-    args->child = child;
-    sema_init(&args->load_sema, 0);
-    args->load_success = false;
+    args->process = p;
 
     /* Create a new thread to execute FILE_NAME. */
     tid = thread_create(prog_name, PRI_DEFAULT, start_process, args);
@@ -92,8 +192,14 @@ tid_t process_execute(const char *file_name) {
     palloc_free_page(prog_name_copy); // prog_name_copy is no longer needed
     
     if (tid == TID_ERROR) {
+        lock_acquire(&filesys_lock);
+        fdtable_destroy(&p->fds);
+        lock_release(&filesys_lock);
+        process_free(p);
         palloc_free_page(fn_copy); // Child won't free it
+        lock_acquire(&parent->lock);
         list_remove(&child->elem); // Remove from parent's list
+        lock_release(&parent->lock);
         palloc_free_page(child);   // Free child_status struct
         palloc_free_page(args);    // Free pargs struct
         return TID_ERROR;
@@ -102,13 +208,10 @@ tid_t process_execute(const char *file_name) {
     // Thread creation was successful
     child->tid = tid; // Update TID in child_status
 
-    sema_down(&args->load_sema); // Wait for child process to finish loading
-
-    bool load_success = args->load_success;
-    palloc_free_page(args); // Free pargs struct, it's no longer needed by parent
-
-    if (!load_success) {
-        // Child failed to load. process_wait will handle cleanup of child_status.
+    if (!(flags & EXEC_ASYNC) && !wait_loaded(child)) {
+        // Child failed to load.  Reap it, so that the caller never
+        // sees it again, e.g. from wait_any().
+        process_wait(tid);
         return TID_ERROR;
     }
 
@@ -120,23 +223,27 @@ tid_t process_execute(const char *file_name) {
 static void start_process(void *args) {
     struct pargs *pargs = args;
     char *file_name = pargs->fn_copy;
-    thread_current()->status_of_child = pargs->child;
+    struct process *p = pargs->process;
     struct intr_frame if_;
     bool success;
 
+    palloc_free_page(pargs);
+    attach(p, list_entry(list_front(&p->threads), struct join_status, elem));
+
     /* Initialize interrupt frame and load executable. */
     memset(&if_, 0, sizeof if_);
     if_.gs = if_.fs = if_.es = if_.ds = if_.ss = SEL_UDSEG;
     if_.cs = SEL_UCSEG;
     if_.eflags = FLAG_IF | FLAG_MBS;
     success = load(file_name, &if_.eip, &if_.esp);
-    pargs->load_success = success;
-    sema_up(&pargs->load_sema); // signal completion of loading
+    report_loaded(p->status, success);
 
-    /* If load failed, quit. */
+    /* If load failed, quit, leaving the exit code at -1. */
     palloc_free_page(file_name);
-    if (!success)
+    if (!success) {
+        p->exiting = true;
         thread_exit();
+    }
 
     /* Start the user process by simulating a return from an
        interrupt, implemented by intr_exit (in
@@ -153,95 +260,328 @@ static void start_process(void *args) {
    exception), returns -1.  If TID is invalid or if it was not a
    child of the calling process, or if process_wait() has already
    been successfully called for the given TID, returns -1
-   immediately, without waiting.
-
-   This function will be implemented in problem 2-2.  For now, it
-   does nothing. */
+   immediately, without waiting.  Also returns -1 if the calling
+   process is told to exit while waiting. */
 int process_wait(tid_t child_tid) {
-    struct thread *cur = thread_current();
-    struct list_elem *e;
-    struct child_status *child_to_wait_on = NULL;
+    struct process *parent = parent_process();
+    struct child_status *child_to_wait_on;
 
-    // Find the child in the current thread's children list
-    for (e = list_begin(&cur->children); e != list_end(&cur->children); e = list_next(e)) {
-        struct child_status *cs = list_entry(e, struct child_status, elem);
-        if (cs->tid == child_tid) {
-            child_to_wait_on = cs;
-            break;
-        }
-    }
+    // Find the child in the current process's children list
+    lock_acquire(&parent->lock);
+    child_to_wait_on = find_child(parent, child_tid);
 
     // If child not found, or already waited on (which implies it would have been removed), return -1.
     // The original check `child->waited` handles if wait is called multiple times on a found child before it's removed.
     if (child_to_wait_on == NULL || child_to_wait_on->waited) {
+        lock_release(&parent->lock);
         return -1;
     }
 
     child_to_wait_on->waited = true; // Mark as being waited on (or that waiting has started)
-    sema_down(&child_to_wait_on->exit_sema); // Wait for the child to exit
+    lock_release(&parent->lock);
+
+    // Wait for the child to exit, unless we are told to exit first.
+    // process_terminate() signals child_changed to wake us then.
+    lock_acquire(&status_lock);
+    while (!child_to_wait_on->exited && !parent->exiting)
+        cond_wait(&parent->child_changed, &status_lock);
+    bool exited = child_to_wait_on->exited;
+    lock_release(&status_lock);
+    if (!exited)
+        return -1;
 
     int exit_code = child_to_wait_on->exit_code;
 
     // Child has exited, remove its status structure from parent's list and free it.
+    lock_acquire(&parent->lock);
     list_remove(&child_to_wait_on->elem);
-    palloc_free_page(child_to_wait_on);
+    lock_release(&parent->lock);
+    status_release(child_to_wait_on);
 
     return exit_code;
 }
 
-/* Free the current process's resources. */
+/* Waits for whichever child process of the calling process
+   exits first, among those it has yet to wait for, and returns
+   its thread id, storing its exit status in *STATUS.  Children
+   that have already exited count first.  Returns TID_ERROR
+   immediately if there are no such children, or 0 if TICKS is
+   nonnegative and that many timer ticks pass before one exits,
+   or TID_ERROR if the calling process is told to exit while it
+   waits.  Children returned by this function cannot be waited
+   for again, and those being waited for by process_wait() are
+   not returned. */
+tid_t process_wait_any(int *status, int64_t ticks) {
+    struct process *parent = parent_process();
+    int64_t deadline = timer_ticks() + ticks;
+    struct child_status *found;
+    tid_t tid;
+
+    for (;;) {
+        struct list_elem *e;
+        bool any = false;
+
+        /* Look for an exited child, holding on to status_lock so
+           that no child can exit unseen before we sleep. */
+        found = NULL;
+        lock_acquire(&parent->lock);
+        lock_acquire(&status_lock);
+        for (e = list_begin(&parent->children);
+             e != list_end(&parent->children); e = list_next(e)) {
+            struct child_status *cs = list_entry(e, struct child_status, elem);
+            if (!cs->waited) {
+                any = true;
+                if (cs->exited) {
+                    found = cs;
+                    break;
+                }
+            }
+        }
+        if (found != NULL) {
+            found->waited = true;
+            list_remove(&found->elem);
+        }
+        lock_release(&parent->lock);
+
+        if (found != NULL || !any || parent->exiting) {
+            lock_release(&status_lock);
+            break;
+        }
+        if (ticks < 0)
+            cond_wait(&parent->child_changed, &status_lock);
+        else if (!cond_wait_timeout(&parent->child_changed, &status_lock,
+                                    deadline - timer_ticks())) {
+            lock_release(&status_lock);
+            return 0;
+        }
+        lock_release(&status_lock);
+    }
+    if (found == NULL)
+        return TID_ERROR;
+
+    tid = found->tid;
+    *status = found->exit_code;
+    status_release(found);
+    return tid;
+}
+
+/* Stores in *USAGE the resources used by the calling process, if
+   WHO is RUSAGE_SELF, or by its children that have exited, and
+   theirs, if WHO is RUSAGE_CHILDREN.  Returns false if WHO is
+   neither. */
+bool process_get_usage(int who, struct rusage *usage) {
+    struct process *p = parent_process();
+    enum intr_level old_level;
+
+    if (who == RUSAGE_SELF) {
+        old_level = intr_disable();
+        *usage = p->usage;
+        intr_set_level(old_level);
+    } else if (who == RUSAGE_CHILDREN) {
+        lock_acquire(&status_lock);
+        *usage = p->child_usage;
+        lock_release(&status_lock);
+    } else
+        return false;
+    return true;
+}
+
+/* Waits for child process TID to finish loading its program, if
+   it has not already, and returns 1 if it loaded successfully or
+   0 if it did not.  Returns -1 immediately if TID is not a child
+   of the calling process, or has already been waited for. */
+int process_load_status(tid_t child_tid) {
+    struct process *parent = parent_process();
+    struct child_status *cs;
+    bool success;
+
+    /* Hold a reference, in case another of our threads waits for
+       the child meanwhile. */
+    lock_acquire(&parent->lock);
+    cs = find_child(parent, child_tid);
+    if (cs != NULL) {
+        lock_acquire(&status_lock);
+        cs->ref_cnt++;
+        lock_release(&status_lock);
+    }
+    lock_release(&parent->lock);
+    if (cs == NULL)
+        return -1;
+
+    success = wait_loaded(cs);
+    status_release(cs);
+    return success;
+}
+
+/* Detaches the current thread from its process, if it has one.
+   The last thread to leave frees the process's resources.  If
+   every thread left by way of thread_exit(), rather than the
+   process being ended by process_terminate(), the process exits
+   with status 0. */
 void process_exit(void) {
     struct thread *cur = thread_current();
-    uint32_t *pd;
+    struct process *p = cur->process;
+    uint32_t *pd = cur->pagedir;
+    bool last;
+
+    /* Kernel threads have no process. */
+    if (p == NULL)
+        return;
+
+    /* Give back this thread's own stack, if it has one. */
+    if (cur->ustack != NULL) {
+        void *kpage = pagedir_get_page(pd, cur->ustack);
+
+        lock_acquire(&p->lock);
+        pagedir_clear_page(pd, cur->ustack);
+        lock_release(&p->lock);
+        pagedir_release_page(kpage);
+        cur->ustack = NULL;
+    }
 
-    // If this thread was created by a parent process (i.e., it's a child),
-    // signal its parent that it's exiting.
-    // cur->status_of_child is set in start_process.
-    if (cur->status_of_child != NULL) {
-        // The exit code should have been set by SYS_EXIT or remains -1 for abnormal termination.
-        sema_up(&cur->status_of_child->exit_sema);
+    /* Stop using the page directory before dropping our
+       reference to the process, after which the last thread may
+       destroy it.  Correct ordering here is crucial.  We must set
+       cur->pagedir to NULL before switching page directories, so
+       that a timer interrupt can't switch back to the process
+       page directory. */
+    cur->pagedir = NULL;
+    pagedir_activate(NULL);
+
+    lock_acquire(&p->lock);
+    sema_up(&cur->join_status->done);
+    last = --p->ref_cnt == 0;
+    if (last && !p->exiting) {
+        p->exiting = true;
+        if (p->status != NULL)
+            p->status->exit_code = 0;
+        print_exit(p, cur->name, 0);
     }
 
-    /* Close all open files */
-    int i;
-    for (i = 2; i < MAX_FILES; i++) {
-        if (cur->files[i] != NULL) {
-            file_close(cur->files[i]);
-            cur->files[i] = NULL;
-        }
+    /* The last thread frees P as soon as we let go of it. */
+    if (!last)
+        cur->usage = NULL;
+    lock_release(&p->lock);
+    if (!last) {
+        cur->process = NULL;
+        cur->join_status = NULL;
+        return;
     }
 
+    /* We are the last thread, so nothing else uses the process
+       any longer.  Stop a uring polling thread from using the fd
+       table and page directory, then close all open files and
+       unmap shared memory, whose pages the page directory must
+       not free.  Open files may be shared with other processes,
+       through fds inherited across exec or fork(), so closing
+       them needs the file system lock like any other change to
+       a shared file. */
+    uring_exit();
+    lock_acquire(&filesys_lock);
+    fdtable_destroy(&p->fds);
+
     /* Re-allow write access to the executable and close it */
-    if (cur->executable != NULL) {
-        file_allow_write(cur->executable);
-        file_close(cur->executable);
-        cur->executable = NULL;
+    if (p->executable != NULL) {
+        file_allow_write(p->executable);
+        file_close(p->executable);
+        p->executable = NULL;
     }
-
-    /* Free child_status structures for children that were not waited for. */
-    while (!list_empty(&cur->children)) {
-        struct list_elem *e = list_pop_front(&cur->children);
+    lock_release(&filesys_lock);
+    shm_exit();
+
+    /* Drop child_status structures for children that were not
+       waited for.  Children still running hold on to theirs, but
+       must no longer report to us. */
+    while (!list_empty(&p->children)) {
+        struct list_elem *e = list_pop_front(&p->children);
         struct child_status *cs = list_entry(e, struct child_status, elem);
-        palloc_free_page(cs);
+        lock_acquire(&status_lock);
+        cs->parent = NULL;
+        lock_release(&status_lock);
+        status_release(cs);
+    }
+
+    /* Hand the process's page directory, which no thread has
+       active any longer, to the reaper, so that our parent need
+       not wait for it to be torn down. */
+    pagedir_destroy_later(p->pagedir);
+
+    // If this process was started by a parent process, signal its
+    // parent that it's exiting, now that its files are closed, and
+    // add its resource usage to the parent's totals for children.
+    cur->usage = NULL;
+    if (p->status != NULL) {
+        // The exit code was set by process_terminate() or above,
+        // or remains -1 after a failed load.
+        lock_acquire(&status_lock);
+        p->status->exited = true;
+        if (p->status->parent != NULL) {
+            usage_add(&p->status->parent->child_usage, &p->usage);
+            usage_add(&p->status->parent->child_usage, &p->child_usage);
+        }
+        notify_parent(p->status);
+        lock_release(&status_lock);
+        status_release(p->status);
     }
 
-    /* Destroy the current process's page directory and switch back
-       to the kernel-only page directory. */
-    pd = cur->pagedir;
-    if (pd != NULL) {
-        /* Correct ordering here is crucial.  We must set
-           cur->pagedir to NULL before switching page directories,
-           so that a timer interrupt can't switch back to the
-           process page directory.  We must activate the base page
-           directory before destroying the process's page
-           directory, or our active page directory will be one
-           that's been freed (and cleared). */
-        cur->pagedir = NULL;
-        pagedir_activate(NULL);
-        pagedir_destroy(pd);
+    cur->process = NULL;
+    cur->join_status = NULL;
+    process_free(p);
+}
+
+/* Ends the current process with exit code STATUS.  The first
+   thread to end the process prints its exit message and reports
+   STATUS to the parent.  The process's other threads exit the
+   next time they return to user mode.  Any asleep in a wait
+   that could last indefinitely, such as futex_wait(), a pipe
+   read or write, poll(), a console read, or wait(), are woken up
+   to do so, and their system calls fail.  Exits the current
+   thread. */
+void process_terminate(int status) {
+    struct thread *cur = thread_current();
+    struct process *p = cur->process;
+
+    lock_acquire(&p->lock);
+    if (!p->exiting) {
+        p->exiting = true;
+        if (p->status != NULL)
+            p->status->exit_code = status;
+        print_exit(p, cur->name, status);
+    }
+    lock_release(&p->lock);
+
+    waitq_wake(&p->exit_waiters);
+    lock_acquire(&status_lock);
+    cond_broadcast(&p->child_changed, &status_lock);
+    lock_release(&status_lock);
+    futex_cancel(p);
+    thread_exit();
+}
+
+/* Exits the current thread if its process is exiting.  Called
+   on each return to user mode. */
+void process_check_exit(void) {
+    struct process *p = thread_current()->process;
+
+    if (p != NULL && p->exiting) {
+        intr_enable();
+        thread_exit();
     }
-    // sema_up(&temporary);
-    sema_up(&cur->status_of_child->exit_sema); // signal child has exited
+}
+
+/* Returns true if the current thread's process is exiting.  If P
+   is non-null, first adds P to the process's exit waiters, using
+   entry E, so that P is woken when process_terminate() tells the
+   process to exit.  Kernel threads have no process, so for them
+   this always returns false and adds P to nothing. */
+bool process_poll_exit(struct poller *p, struct waitq_entry *e) {
+    struct process *proc = thread_current()->process;
+
+    if (proc == NULL)
+        return false;
+    if (p != NULL)
+        poller_add(p, &proc->exit_waiters, e);
+    return proc->exiting;
 }
 
 /* Sets up the CPU for running user code in the current
@@ -250,14 +590,445 @@ void process_exit(void) {
 void process_activate(void) {
     struct thread *t = thread_current();
 
-    /* Activate thread's page tables. */
-    pagedir_activate(t->pagedir);
+    /* Activate thread's page tables.  A kernel thread never
+       touches user memory, so it just borrows whatever address
+       space is already loaded: the kernel half of every page
+       directory is the same.  This avoids flushing the TLB on a
+       switch to a kernel thread and again on the switch back.
+       Borrowing is safe because process_exit() loads the
+       kernel-only page directory itself before it destroys a
+       process's page directory. */
+    if (t->pagedir != NULL)
+        pagedir_activate(t->pagedir);
 
     /* Set thread's kernel stack for use in processing
        interrupts. */
     tss_update();
 }
 
+/* Creates a child of the current process that is a copy of it,
+   with one thread that starts in user mode from F, the frame of
+   the current thread's fork() system call, as if fork() had
+   returned 0 there.  The child's fds refer to the same things as
+   the current process's, it maps the same shared memory, and it
+   shares the rest of the current process's memory copy-on-write.
+   Returns the child's thread id, or TID_ERROR if resources are
+   exhausted. */
+tid_t process_fork(const struct intr_frame *f) {
+    struct thread *cur = thread_current();
+    struct process *parent = cur->process;
+    struct child_status *child;
+    struct fstart fs;
+    tid_t tid;
+
+    child = status_create(parent);
+    if (child == NULL)
+        return TID_ERROR;
+    fs.process = process_create(child);
+    if (fs.process == NULL) {
+        palloc_free_page(child);
+        return TID_ERROR;
+    }
+
+    lock_acquire(&parent->lock);
+    list_push_back(&parent->children, &child->elem);
+    lock_release(&parent->lock);
+
+    fs.parent = parent;
+    fs.frame = *f;
+    fs.frame.eax = 0;
+    fs.ustack = cur->ustack;
+    sema_init(&fs.started, 0);
+    fs.success = false;
+    tid = thread_create(cur->name, PRI_DEFAULT, start_fork, &fs);
+    if (tid == TID_ERROR) {
+        process_free(fs.process);
+        lock_acquire(&parent->lock);
+        list_remove(&child->elem);
+        lock_release(&parent->lock);
+        palloc_free_page(child);
+        return TID_ERROR;
+    }
+    child->tid = tid;
+
+    /* The child copies what it needs from us while we wait.  If
+       it fails, it has already exited, and waiting for it just
+       collects its status. */
+    sema_down(&fs.started);
+    if (!fs.success) {
+        process_wait(tid);
+        return TID_ERROR;
+    }
+    return tid;
+}
+
+/* A thread function that sets up a process created by
+   process_fork() and starts it running in user mode. */
+static void start_fork(void *fs_) {
+    struct fstart *fs = fs_;
+    struct thread *cur = thread_current();
+    struct process *p = fs->process;
+    struct process *parent = fs->parent;
+    struct intr_frame if_ = fs->frame;
+    bool success;
+
+    attach(p, list_entry(list_front(&p->threads), struct join_status, elem));
+
+    /* Map shared memory before the rest of the address space,
+       which pagedir_fork() then leaves alone.  Hold the parent's
+       lock throughout, so that none of its other threads can map
+       or unmap a segment in between. */
+    p->pagedir = cur->pagedir = pagedir_create();
+    if (p->pagedir != NULL) {
+        lock_acquire(&parent->lock);
+        success = shm_fork(parent) && pagedir_fork(p->pagedir,
+                                                   parent->pagedir,
+                                                   fork_shares, parent);
+        lock_release(&parent->lock);
+    } else
+        success = false;
+
+    if (success) {
+        lock_acquire(&filesys_lock);
+        success = fdtable_copy(&p->fds, &parent->fds);
+        if (success && parent->executable != NULL) {
+            p->executable = file_reopen(parent->executable);
+            if (p->executable != NULL)
+                file_deny_write(p->executable);
+            else
+                success = false;
+        }
+        lock_release(&filesys_lock);
+    }
+    if (success)
+        cur->ustack = fs->ustack;
+
+    /* FS goes away once the creator wakes up. */
+    report_loaded(p->status, success);
+    fs->success = success;
+    sema_up(&fs->started);
+    if (!success) {
+        p->exiting = true;
+        thread_exit();
+    }
+
+    process_activate();
+    asm volatile("movl %0, %%esp; jmp intr_exit" : : "g"(&if_) : "memory");
+    NOT_REACHED();
+}
+
+/* Starts a new thread in the current process, running user
+   function START with arguments FUNC and AUX on a user stack of
+   its own.  Returns the new thread's id, or TID_ERROR if the
+   process is exiting or resources are exhausted. */
+tid_t process_thread_create(void *start, void *func, void *aux) {
+    struct thread *cur = thread_current();
+    struct process *p = cur->process;
+    struct join_status *js;
+    struct tstart ts;
+    tid_t tid;
+
+    js = malloc(sizeof *js);
+    if (js == NULL)
+        return TID_ERROR;
+    js->tid = TID_ERROR;
+    js->value = -1;
+    sema_init(&js->done, 0);
+    js->joined = false;
+
+    lock_acquire(&p->lock);
+    if (p->exiting) {
+        lock_release(&p->lock);
+        free(js);
+        return TID_ERROR;
+    }
+    p->ref_cnt++;
+    list_push_back(&p->threads, &js->elem);
+    lock_release(&p->lock);
+
+    ts.process = p;
+    ts.join_status = js;
+    ts.start = start;
+    ts.func = func;
+    ts.aux = aux;
+    sema_init(&ts.started, 0);
+    ts.success = false;
+    tid = thread_create(cur->name, PRI_DEFAULT, start_thread, &ts);
+    if (tid == TID_ERROR) {
+        /* We still hold a reference, so REF_CNT can't reach 0. */
+        lock_acquire(&p->lock);
+        p->ref_cnt--;
+        list_remove(&js->elem);
+        lock_release(&p->lock);
+        free(js);
+        return TID_ERROR;
+    }
+
+    sema_down(&ts.started);
+    if (!ts.success) {
+        process_thread_join(tid);
+        return TID_ERROR;
+    }
+    return tid;
+}
+
+/* A thread function that starts a thread created by
+   process_thread_create() running in user mode. */
+static void start_thread(void *ts_) {
+    struct tstart *ts = ts_;
+    struct intr_frame if_;
+    bool success;
+
+    attach(ts->process, ts->join_status);
+    process_activate();
+
+    memset(&if_, 0, sizeof if_);
+    if_.gs = if_.fs = if_.es = if_.ds = if_.ss = SEL_UDSEG;
+    if_.cs = SEL_UCSEG;
+    if_.eflags = FLAG_IF | FLAG_MBS;
+    if_.eip = (void (*)(void)) ts->start;
+    success = ts->success = setup_thread_stack(ts->func, ts->aux, &if_.esp);
+
+    /* TS goes away once the creator wakes up. */
+    sema_up(&ts->started);
+    if (!success)
+        thread_exit();
+
+    asm volatile("movl %0, %%esp; jmp intr_exit" : : "g"(&if_) : "memory");
+    NOT_REACHED();
+}
+
+/* Waits for thread TID of the current process to exit and
+   returns the value it passed to thread_exit(), or -1 if it
+   ended some other way.  Returns -1 at once if TID is not
+   another thread of the current process or has already been
+   joined. */
+int process_thread_join(tid_t tid) {
+    struct thread *cur = thread_current();
+    struct process *p = cur->process;
+    struct join_status *js = NULL;
+    struct list_elem *e;
+    int value;
+
+    if (tid == cur->tid || tid == TID_ERROR)
+        return -1;
+
+    lock_acquire(&p->lock);
+    for (e = list_begin(&p->threads); e != list_end(&p->threads);
+         e = list_next(e)) {
+        struct join_status *s = list_entry(e, struct join_status, elem);
+        if (s->tid == tid) {
+            js = s;
+            break;
+        }
+    }
+    if (js == NULL || js->joined) {
+        lock_release(&p->lock);
+        return -1;
+    }
+    js->joined = true;
+    lock_release(&p->lock);
+
+    sema_down(&js->done);
+
+    lock_acquire(&p->lock);
+    list_remove(&js->elem);
+    lock_release(&p->lock);
+    value = js->value;
+    free(js);
+    return value;
+}
+
+/* Exits the current thread, leaving VALUE for a thread that
+   joins it.  The process goes on as long as it has other
+   threads. */
+void process_thread_exit(int value) {
+    thread_current()->join_status->value = value;
+    thread_exit();
+}
+
+/* Returns a new process, without threads, page directory, or
+   open files, whose parent keeps its exit status in CHILD.  The
+   process is set up to receive one thread, with start_process().
+   Returns a null pointer if memory is exhausted. */
+static struct process *process_create(struct child_status *child) {
+    struct process *p = calloc(1, sizeof *p);
+    struct join_status *js = malloc(sizeof *js);
+
+    if (p == NULL || js == NULL) {
+        free(p);
+        free(js);
+        return NULL;
+    }
+
+    js->tid = TID_ERROR;
+    js->value = -1;
+    sema_init(&js->done, 0);
+    js->joined = false;
+
+    lock_init_named(&p->lock, "process");
+    p->ref_cnt = 1;
+    p->exiting = false;
+    waitq_init(&p->exit_waiters);
+    list_init(&p->threads);
+    list_push_back(&p->threads, &js->elem);
+    list_init(&p->children);
+    cond_init(&p->child_changed);
+    p->status = child;
+    fdtable_init(&p->fds);
+    list_init(&p->shm_maps);
+    return p;
+}
+
+/* Frees P and its threads' join statuses. */
+static void process_free(struct process *p) {
+    while (!list_empty(&p->threads))
+        free(list_entry(list_pop_front(&p->threads), struct join_status,
+                        elem));
+    free(p);
+}
+
+/* Returns the current thread's process, or KERNEL_PROCESS if it
+   is a kernel thread. */
+static struct process *parent_process(void) {
+    struct process *p = thread_current()->process;
+    return p != NULL ? p : &kernel_process;
+}
+
+/* Returns a new status for a child of PARENT, with one
+   reference for PARENT and one for the child, or a null pointer
+   if memory is exhausted.  If the child never starts, the parent
+   may simply free it with palloc_free_page(). */
+static struct child_status *status_create(struct process *parent) {
+    struct child_status *cs = palloc_get_page(0);
+
+    if (cs == NULL)
+        return NULL;
+    cs->tid = TID_ERROR; // Will be updated if thread_create succeeds
+    cs->parent = parent;
+    cs->exit_code = -1;
+    cs->exited = false;
+    cs->waited = false;
+    cs->loaded = false;
+    cs->load_success = false;
+    cs->ref_cnt = 2;
+    return cs;
+}
+
+/* Drops a reference to CS, freeing it if that was the last. */
+static void status_release(struct child_status *cs) {
+    bool last;
+
+    lock_acquire(&status_lock);
+    last = --cs->ref_cnt == 0;
+    lock_release(&status_lock);
+    if (last)
+        palloc_free_page(cs);
+}
+
+/* Reports through CS that its child has finished loading, and
+   whether it succeeded. */
+static void report_loaded(struct child_status *cs, bool success) {
+    lock_acquire(&status_lock);
+    cs->load_success = success;
+    cs->loaded = true;
+    notify_parent(cs);
+    lock_release(&status_lock);
+}
+
+/* Wakes up the threads of CS's parent, if it has not exited, to
+   look at CS again.  The caller must hold status_lock and have
+   just changed CS. */
+static void notify_parent(struct child_status *cs) {
+    ASSERT(lock_held_by_current_thread(&status_lock));
+    if (cs->parent != NULL)
+        cond_broadcast(&cs->parent->child_changed, &status_lock);
+}
+
+/* Returns PARENT's record of its child TID, or a null pointer if
+   it has none.  The caller must hold PARENT's lock. */
+static struct child_status *find_child(struct process *parent, tid_t tid) {
+    struct list_elem *e;
+
+    ASSERT(lock_held_by_current_thread(&parent->lock));
+    for (e = list_begin(&parent->children); e != list_end(&parent->children);
+         e = list_next(e)) {
+        struct child_status *cs = list_entry(e, struct child_status, elem);
+        if (cs->tid == tid)
+            return cs;
+    }
+    return NULL;
+}
+
+/* Waits for the child that reports to CS to finish loading and
+   returns whether it succeeded.  Must be called by a thread of
+   the child's parent. */
+static bool wait_loaded(struct child_status *cs) {
+    bool success;
+
+    lock_acquire(&status_lock);
+    while (!cs->loaded)
+        cond_wait(&cs->parent->child_changed, &status_lock);
+    success = cs->load_success;
+    lock_release(&status_lock);
+    return success;
+}
+
+/* Makes the current thread a thread of P, which has already
+   counted it in its REF_CNT and which records it in JS. */
+static void attach(struct process *p, struct join_status *js) {
+    struct thread *cur = thread_current();
+
+    ASSERT(cur->process == NULL);
+    js->tid = cur->tid;
+    cur->process = p;
+    cur->join_status = js;
+    cur->pagedir = p->pagedir;
+    cur->usage = &p->usage;
+}
+
+/* Prints the exit message for process P, whose thread NAME is
+   ending it with STATUS, followed by P's resource usage if
+   process_print_usage is true.  The caller must hold P's lock. */
+static void print_exit(struct process *p, const char *name, int status) {
+    const struct rusage *u = &p->usage;
+    unsigned syscall_cnt = 0;
+    int i;
+
+    printf("%s: exit(%d)\n", name, status);
+    if (!process_print_usage)
+        return;
+
+    for (i = 0; i < RUSAGE_SYSCALL_CNT; i++)
+        syscall_cnt += u->syscalls[i];
+    printf("%s: usage: %" PRId64 " user ticks, %" PRId64 " kernel ticks, "
+           "%" PRIu32 " voluntary and %" PRIu32 " involuntary switches, "
+           "%" PRIu32 " page faults, %" PRIu64 " bytes read, %" PRIu64
+           " written, %" PRIu32 " sectors read, %" PRIu32 " written, "
+           "%u system calls\n",
+           name, u->user_ticks, u->kernel_ticks, u->voluntary_switches,
+           u->involuntary_switches, u->page_faults, u->bytes_read,
+           u->bytes_written, u->sectors_read, u->sectors_written,
+           syscall_cnt);
+}
+
+/* Adds the counts in SRC to those in DST. */
+static void usage_add(struct rusage *dst, const struct rusage *src) {
+    int i;
+
+    dst->user_ticks += src->user_ticks;
+    dst->kernel_ticks += src->kernel_ticks;
+    dst->voluntary_switches += src->voluntary_switches;
+    dst->involuntary_switches += src->involuntary_switches;
+    dst->page_faults += src->page_faults;
+    dst->bytes_read += src->bytes_read;
+    dst->bytes_written += src->bytes_written;
+    dst->sectors_read += src->sectors_read;
+    dst->sectors_written += src->sectors_written;
+    for (i = 0; i < RUSAGE_SYSCALL_CNT; i++)
+        dst->syscalls[i] += src->syscalls[i];
+}
+
 /* We load ELF binaries.  The following definitions are taken
    from the ELF specification, [ELF1], more-or-less verbatim.  */
 
@@ -350,7 +1121,7 @@ bool load(const char *file_name, void (**eip)(void), void **esp) {
     char *actual_program_name = strtok_r(file_name_for_parsing, " ", &save_ptr_load);
 
     /* Allocate and activate page directory. */
-    t->pagedir = pagedir_create();
+    t->process->pagedir = t->pagedir = pagedir_create();
     if (t->pagedir == NULL) {
         palloc_free_page(file_name_for_parsing);
         goto done;
@@ -368,8 +1139,8 @@ bool load(const char *file_name, void (**eip)(void), void **esp) {
     /* Deny write access to the executable file */
     file_deny_write(file);
     
-    /* Store the executable file in the thread structure */
-    t->executable = file;
+    /* Store the executable file in the process structure */
+    t->process->executable = file;
     
     /* Read and verify executable header. */
     if (file_read(file, &ehdr, sizeof ehdr) != sizeof ehdr ||
@@ -455,7 +1226,7 @@ done:
        to maintain write protection */
     if (!success && file != NULL) {
         file_close(file);
-        t->executable = NULL;
+        t->process->executable = NULL;
     }
     return success;
 }
@@ -463,6 +1234,7 @@ done:
 /* load() helpers. */
 
 static bool install_page(void *upage, void *kpage, bool writable);
+static void *get_user_page(enum palloc_flags);
 
 /* Checks whether PHDR describes a valid, loadable segment in
    FILE and returns true if so, false otherwise. */
@@ -537,7 +1309,7 @@ static bool load_segment(struct file *file, off_t ofs, uint8_t *upage,
         size_t page_zero_bytes = PGSIZE - page_read_bytes;
 
         /* Get a page of memory. */
-        uint8_t *kpage = palloc_get_page(PAL_USER);
+        uint8_t *kpage = get_user_page(0);
         if (kpage == NULL)
             return false;
 
@@ -568,7 +1340,7 @@ static bool setup_stack(void **esp) {
     uint8_t *kpage;
     bool success = false;
 
-    kpage = palloc_get_page(PAL_USER | PAL_ZERO);
+    kpage = get_user_page(PAL_ZERO);
     if (kpage != NULL) {
         success = install_page(((uint8_t *) PHYS_BASE) - PGSIZE, kpage, true);
         if (success)
@@ -697,3 +1469,140 @@ static bool install_page(void *upage, void *kpage, bool writable) {
     return (pagedir_get_page(t->pagedir, upage) == NULL &&
             pagedir_set_page(t->pagedir, upage, kpage, writable));
 }
+
+/* Obtains a page from the user pool, as palloc_get_page(PAL_USER
+   | FLAGS) would.  If the pool is empty, first waits for the
+   reaper to free the pages of processes that have exited.
+   Returns a null pointer if memory is still exhausted. */
+static void *get_user_page(enum palloc_flags flags) {
+    void *kpage = palloc_get_page(PAL_USER | flags);
+    if (kpage == NULL && pagedir_reap_wait())
+        kpage = palloc_get_page(PAL_USER | flags);
+    return kpage;
+}
+
+/* Lowest and highest addresses at which process_find_range()
+   picks pages.  The range lies well clear of the code and data,
+   which are linked at 0x08048000, and of the stack at the top of
+   user memory. */
+#define MAP_BASE ((uint8_t *) 0x40000000)
+#define MAP_LIMIT ((uint8_t *) PHYS_BASE - 0x01000000)
+
+/* Each thread's user stack is the top page of a slot of its own,
+   STACK_SLOT_SIZE bytes long, counting down from the top of user
+   memory, so that unmapped pages separate the stacks.  The first
+   thread's stack, set up by setup_stack(), is in slot 0.  The
+   slots fill the space above MAP_LIMIT. */
+#define STACK_SLOT_SIZE (64 * 1024)
+#define STACK_SLOT_CNT (((uint8_t *) PHYS_BASE - MAP_LIMIT) / STACK_SLOT_SIZE)
+
+/* Gives the current thread, which must belong to a process, a
+   user stack of its own in the lowest-numbered free slot and
+   pushes arguments FUNC and AUX and a null return address onto
+   it, as if calling a function of two arguments.  Stores the
+   initial stack pointer into *ESP.  Returns true if successful,
+   false if no slot is free or memory is exhausted. */
+static bool setup_thread_stack(void *func, void *aux, void **esp) {
+    struct thread *cur = thread_current();
+    struct process *p = cur->process;
+    uint8_t *kpage = get_user_page(PAL_ZERO);
+    uint32_t *frame;
+    int slot;
+
+    if (kpage == NULL)
+        return false;
+
+    lock_acquire(&p->lock);
+    for (slot = 1; slot < STACK_SLOT_CNT; slot++) {
+        uint8_t *upage =
+            (uint8_t *) PHYS_BASE - slot * STACK_SLOT_SIZE - PGSIZE;
+        if (pagedir_get_page(p->pagedir, upage) == NULL) {
+            if (pagedir_set_page(p->pagedir, upage, kpage, true))
+                cur->ustack = upage;
+            break;
+        }
+    }
+    lock_release(&p->lock);
+    if (cur->ustack == NULL) {
+        palloc_free_page(kpage);
+        return false;
+    }
+
+    /* Lay out the arguments so that, as at the start of main(),
+       the stack is 16-byte aligned just above the return
+       address. */
+    frame = (uint32_t *) (kpage + PGSIZE) - 5;
+    frame[0] = 0;
+    frame[1] = (uint32_t) func;
+    frame[2] = (uint32_t) aux;
+    *esp = (uint8_t *) cur->ustack + PGSIZE - 5 * sizeof *frame;
+    return true;
+}
+
+/* Returns true if PAGE_CNT pages starting at UPAGE are all in
+   user memory and none of them is mapped in the current
+   process.  UPAGE must be page-aligned and non-null. */
+bool process_range_free(const void *upage, size_t page_cnt) {
+    const uint8_t *page = upage;
+    size_t i;
+
+    if (page == NULL || pg_ofs(page) != 0 || !is_user_vaddr(page) ||
+        page_cnt > pg_no(PHYS_BASE) - pg_no(page))
+        return false;
+    for (i = 0; i < page_cnt; i++)
+        if (pagedir_get_page(thread_current()->pagedir, page + i * PGSIZE) !=
+            NULL)
+            return false;
+    return true;
+}
+
+/* Returns the lowest address between MAP_BASE and MAP_LIMIT at
+   which PAGE_CNT pages are free in the current process, or a
+   null pointer if there is no such run of pages. */
+void *process_find_range(size_t page_cnt) {
+    uint8_t *upage;
+
+    for (upage = MAP_BASE;
+         page_cnt <= (size_t) (MAP_LIMIT - upage) / PGSIZE;
+         upage += PGSIZE)
+        if (process_range_free(upage, page_cnt))
+            return upage;
+    return NULL;
+}
+
+/* Maps KPAGE into the current process's address space at an
+   address picked by process_find_range(), writable if WRITABLE
+   is true.  Returns the user address of the mapping, or a null
+   pointer if no page is free or memory is exhausted.  If
+   successful, KPAGE belongs to the process's page directory and
+   will be freed along with it. */
+void *process_map_page(void *kpage, bool writable) {
+    uint8_t *upage = process_find_range(1);
+
+    return upage != NULL && install_page(upage, kpage, writable) ? upage
+                                                                 : NULL;
+}
+
+/* Returns true if fork() should share user page UPAGE with the
+   child copy-on-write.  Pages mapped with process_map_page()
+   belong to kernel objects, such as a uring, that the child does
+   not inherit.  Nor are shared memory segments, which the child
+   maps itself with shm_fork(): sharing their frames
+   copy-on-write would let the child's copies outlive the
+   segment.  The caller must hold PARENT_'s lock. */
+static bool fork_shares(const void *upage, void *parent_) {
+    struct process *parent = parent_;
+    const uint8_t *page = upage;
+    return (page < MAP_BASE || page >= MAP_LIMIT) &&
+           !shm_is_mapped(parent, upage);
+}
+
+/* Returns true if user page UPAGE of the current process is the
+   process's alone, so that its frame may be replaced or freed
+   without anyone else noticing.  Pages mapped with
+   process_map_page() are not, because the kernel keeps using
+   them, and neither are shared memory segments.  The caller must
+   hold the process's lock. */
+bool process_owns_page(const void *upage) {
+    return fork_shares(upage, thread_current()->process);
+}
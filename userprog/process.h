@@ -1,11 +1,97 @@
 #ifndef USERPROG_PROCESS_H
 #define USERPROG_PROCESS_H
 
+#include <list.h>
+#include <stdbool.h>
+
+#include "threads/synch.h"
 #include "threads/thread.h"
+#include "threads/waitq.h"
+#include "userprog/fdtable.h"
+
+struct intr_frame;
+
+/* A parent's record of one of its child processes, shared with
+   the child, which reports to it.  Freed by whichever of the two
+   lets go of it last.  Members marked with "S" are protected by
+   the status lock in process.c, and the parent's CHILD_CHANGED
+   is signaled whenever LOADED or EXITED becomes true. */
+struct child_status {
+    tid_t tid; /* Child's thread id. */
+    struct process *parent; /* S: Parent, or null once it exits. */
+    int exit_code; /* Child's exit status. */
+    bool exited; /* S: Has the child exited? */
+    bool waited; /* Has the parent already called wait()? */
+    bool loaded; /* S: Has the child finished loading? */
+    bool load_success; /* Did the child load successfully? */
+    int ref_cnt; /* S: References from parent and child. */
+    struct list_elem elem; /* Element in the parent's CHILDREN. */
+};
+
+/* A process's record of one of its threads, kept until another
+   thread joins it or the process exits. */
+struct join_status {
+    tid_t tid; /* Thread's id. */
+    int value; /* Value passed to thread_exit(). */
+    struct semaphore done; /* Upped when the thread exits. */
+    bool joined; /* Has another thread already joined it? */
+    struct list_elem elem; /* Element in struct process's THREADS. */
+};
+
+/* A user process: an address space, and the open files and
+   other resources that go with it, shared by one or more
+   threads.  Each thread holds a reference to its process.  The
+   last thread to exit tears the process down. */
+struct process {
+    struct lock lock; /* Protects the members below, except as noted. */
+    int ref_cnt; /* Number of threads in the process. */
+    bool exiting; /* Has the process been told to exit? */
+    struct waitq exit_waiters; /* Woken when EXITING becomes true. */
+    struct list threads; /* struct join_status for each thread. */
+    struct list children; /* struct child_status for each child. */
+    struct condition child_changed; /* A child loaded or exited. */
+    struct child_status *status; /* Parent's record of us, or null. */
 
-tid_t process_execute(const char *file_name);
+    /* Owned by the process's threads as a group.  The fd table
+       is protected by filesys_lock, and the rest are changed
+       only under LOCK or by the last thread as it exits. */
+    uint32_t *pagedir; /* Page directory. */
+    struct fdtable fds; /* Open files. */
+    struct uring_ctx *uring; /* Shared syscall ring, if any. */
+    struct list shm_maps; /* Mapped shared memory segments. */
+    struct file *executable; /* Running program, denied writes. */
+
+    /* Resource usage.  USAGE is charged by the process's threads
+       with interrupts off (see CHARGE_USAGE in thread.h).
+       CHILD_USAGE is protected by the status lock in process.c. */
+    struct rusage usage; /* Resources used by the process itself. */
+    struct rusage child_usage; /* Used by exited children, and theirs. */
+};
+
+/* Print resource usage along with each process's exit status?
+   Set by the "-ru" kernel command-line option. */
+extern bool process_print_usage;
+
+void process_init(void);
+tid_t process_execute(const char *file_name, int flags);
 int process_wait(tid_t);
+tid_t process_wait_any(int *status, int64_t ticks);
+int process_load_status(tid_t);
+bool process_get_usage(int who, struct rusage *);
 void process_exit(void);
+void process_terminate(int status) NO_RETURN;
+void process_check_exit(void);
+bool process_poll_exit(struct poller *, struct waitq_entry *);
 void process_activate(void);
+tid_t process_fork(const struct intr_frame *);
+
+tid_t process_thread_create(void *start, void *func, void *aux);
+int process_thread_join(tid_t);
+void process_thread_exit(int value) NO_RETURN;
+
+bool process_range_free(const void *upage, size_t page_cnt);
+void *process_find_range(size_t page_cnt);
+void *process_map_page(void *kpage, bool writable);
+bool process_owns_page(const void *upage);
 
 #endif /* userprog/process.h */
@@ -0,0 +1,273 @@
+#include "userprog/shm.h"
+
+#include <debug.h>
+#include <list.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+#include "userprog/process.h"
+
+/* Shared memory segments.
+
+   A segment is a run of zeroed pages that any number of
+   processes may map.  A process gets hold of a segment through
+   an fd from shm_create(), which either creates a segment or,
+   given the name of an existing one, opens that.  An anonymous
+   segment reaches other processes only as an fd inherited
+   across exec.
+
+   Each fd and each mapping holds a reference to its segment.
+   The segment's pages are freed along with the segment when the
+   last reference goes away, so they outlive any one process
+   that maps them.  Mapped pages are never freed by
+   pagedir_destroy(), because shm_exit() unmaps them first. */
+
+/* Longest segment name. */
+#define SHM_NAME_MAX 31
+
+/* Most pages in a segment. */
+#define SHM_PAGE_MAX 1024
+
+/* A shared memory segment. */
+struct shm {
+    struct list_elem elem; /* Element in NAMED_LIST, if named. */
+    char name[SHM_NAME_MAX + 1]; /* Name, or empty if anonymous. */
+    int ref_cnt; /* Number of fds and mappings. */
+    size_t page_cnt; /* Number of pages. */
+    void **pages; /* Kernel virtual address of each page. */
+};
+
+/* A segment mapped into a process. */
+struct shm_mapping {
+    struct list_elem elem; /* Element in struct process's shm_maps. */
+    struct shm *shm; /* Segment mapped. */
+    uint8_t *upage; /* User virtual address of first page. */
+};
+
+/* Named segments, and a lock that protects this list and every
+   segment's reference count. */
+static struct list named_list;
+static struct lock shm_lock;
+
+static void free_shm(struct shm *);
+static struct shm_mapping *find_mapping(struct process *,
+                                        const void *upage);
+
+/* Initializes the shared memory subsystem. */
+void shm_init(void) {
+    list_init(&named_list);
+    lock_init_named(&shm_lock, "shm");
+}
+
+/* Returns a new segment of PAGE_CNT zeroed pages, named NAME, or
+   anonymous if NAME is a null pointer.  If a segment named NAME
+   already exists, returns that instead, provided that PAGE_CNT
+   is 0 or the segment's size.  Either way the caller gets a
+   reference to the segment, which it must drop with
+   shm_close().  Returns a null pointer if NAME is too long,
+   PAGE_CNT is out of range, or memory is exhausted. */
+struct shm *shm_create(const char *name, size_t page_cnt) {
+    struct shm *shm;
+    struct list_elem *e;
+    size_t i;
+
+    if (name != NULL && strlen(name) > SHM_NAME_MAX)
+        return NULL;
+
+    lock_acquire(&shm_lock);
+    if (name != NULL)
+        for (e = list_begin(&named_list); e != list_end(&named_list);
+             e = list_next(e)) {
+            shm = list_entry(e, struct shm, elem);
+            if (!strcmp(shm->name, name)) {
+                if (page_cnt != 0 && page_cnt != shm->page_cnt)
+                    shm = NULL;
+                else
+                    shm->ref_cnt++;
+                lock_release(&shm_lock);
+                return shm;
+            }
+        }
+
+    shm = NULL;
+    if (page_cnt > 0 && page_cnt <= SHM_PAGE_MAX)
+        shm = calloc(1, sizeof *shm);
+    if (shm != NULL) {
+        shm->page_cnt = page_cnt;
+        shm->pages = calloc(page_cnt, sizeof *shm->pages);
+        for (i = 0; shm->pages != NULL && i < page_cnt; i++)
+            if ((shm->pages[i] = palloc_get_page(PAL_USER | PAL_ZERO)) == NULL)
+                break;
+        if (shm->pages == NULL || i < page_cnt) {
+            free_shm(shm);
+            shm = NULL;
+        } else {
+            strlcpy(shm->name, name != NULL ? name : "", sizeof shm->name);
+            shm->ref_cnt = 1;
+            if (name != NULL)
+                list_push_back(&named_list, &shm->elem);
+        }
+    }
+    lock_release(&shm_lock);
+    return shm;
+}
+
+/* Takes another reference to SHM and returns SHM. */
+struct shm *shm_dup(struct shm *shm) {
+    lock_acquire(&shm_lock);
+    ASSERT(shm->ref_cnt > 0);
+    shm->ref_cnt++;
+    lock_release(&shm_lock);
+    return shm;
+}
+
+/* Drops a reference to SHM, freeing it and its pages if it was
+   the last.  A named segment's name becomes free at the same
+   time. */
+void shm_close(struct shm *shm) {
+    bool dead;
+
+    lock_acquire(&shm_lock);
+    ASSERT(shm->ref_cnt > 0);
+    dead = --shm->ref_cnt == 0;
+    if (dead && shm->name[0] != '\0')
+        list_remove(&shm->elem);
+    lock_release(&shm_lock);
+
+    if (dead)
+        free_shm(shm);
+}
+
+/* Maps all of SHM into the current process, read/write, starting
+   at UPAGE, or at an address of the kernel's choosing if UPAGE
+   is a null pointer.  Returns the address of the mapping, or a
+   null pointer if UPAGE is not page-aligned, any page in the
+   range is already mapped or not in user memory, or memory is
+   exhausted.  The mapping holds its own reference to SHM. */
+void *shm_map(struct shm *shm, void *upage_) {
+    struct process *p = thread_current()->process;
+    uint8_t *upage = upage_;
+    struct shm_mapping *m;
+    size_t i;
+
+    m = malloc(sizeof *m);
+    if (m == NULL)
+        return NULL;
+
+    lock_acquire(&p->lock);
+    if (upage == NULL)
+        upage = process_find_range(shm->page_cnt);
+    else if (!process_range_free(upage, shm->page_cnt))
+        upage = NULL;
+    for (i = 0; upage != NULL && i < shm->page_cnt; i++)
+        if (!pagedir_set_page(p->pagedir, upage + i * PGSIZE, shm->pages[i],
+                              true)) {
+            pagedir_clear_range(p->pagedir, upage, i);
+            upage = NULL;
+        }
+    if (upage != NULL) {
+        m->shm = shm_dup(shm);
+        m->upage = upage;
+        list_push_back(&p->shm_maps, &m->elem);
+    }
+    lock_release(&p->lock);
+
+    if (upage == NULL)
+        free(m);
+    return upage;
+}
+
+/* Unmaps the segment mapped at UPAGE in the current process.
+   Returns true if successful, false if no segment mapping starts
+   at UPAGE. */
+bool shm_unmap(void *upage) {
+    struct process *p = thread_current()->process;
+    struct shm_mapping *m;
+
+    lock_acquire(&p->lock);
+    m = find_mapping(p, upage);
+    if (m == NULL || m->upage != upage) {
+        lock_release(&p->lock);
+        return false;
+    }
+    pagedir_clear_range(p->pagedir, m->upage, m->shm->page_cnt);
+    list_remove(&m->elem);
+    lock_release(&p->lock);
+
+    shm_close(m->shm);
+    free(m);
+    return true;
+}
+
+/* Returns true if user page UPAGE lies within a segment mapped
+   into process P.  The caller must hold P's lock, since the
+   answer may change as soon as it is released. */
+bool shm_is_mapped(struct process *p, const void *upage) {
+    ASSERT(lock_held_by_current_thread(&p->lock));
+    return find_mapping(p, upage) != NULL;
+}
+
+/* Unmaps every segment mapped into the current process.  Called
+   by process_exit() before it destroys the page directory. */
+void shm_exit(void) {
+    struct list *maps = &thread_current()->process->shm_maps;
+
+    while (!list_empty(maps)) {
+        struct shm_mapping *m =
+            list_entry(list_front(maps), struct shm_mapping, elem);
+        shm_unmap(m->upage);
+    }
+}
+
+/* Maps each segment mapped into PARENT into the current process
+   as well, at the same address, for fork().  The caller must
+   hold PARENT's lock.  The current process must be new, so that
+   no one else can be holding its lock while we hold PARENT's.
+   Returns true if successful, false if memory is exhausted, in
+   which case some of the segments may have been mapped. */
+bool shm_fork(struct process *parent) {
+    struct list_elem *e;
+    bool success = true;
+
+    ASSERT(lock_held_by_current_thread(&parent->lock));
+    for (e = list_begin(&parent->shm_maps);
+         success && e != list_end(&parent->shm_maps); e = list_next(e)) {
+        struct shm_mapping *m = list_entry(e, struct shm_mapping, elem);
+        success = shm_map(m->shm, m->upage) != NULL;
+    }
+    return success;
+}
+
+/* Frees SHM, which no one references any longer, and whatever
+   pages it has. */
+static void free_shm(struct shm *shm) {
+    size_t i;
+
+    if (shm->pages != NULL)
+        for (i = 0; i < shm->page_cnt; i++)
+            palloc_free_page(shm->pages[i]);
+    free(shm->pages);
+    free(shm);
+}
+
+/* Returns process P's mapping that contains UPAGE, or a null
+   pointer if there is none.  The caller must hold P's lock. */
+static struct shm_mapping *find_mapping(struct process *p,
+                                        const void *upage) {
+    struct list *maps = &p->shm_maps;
+    const uint8_t *page = upage;
+    struct list_elem *e;
+
+    for (e = list_begin(maps); e != list_end(maps); e = list_next(e)) {
+        struct shm_mapping *m = list_entry(e, struct shm_mapping, elem);
+        if (page >= m->upage && page < m->upage + m->shm->page_cnt * PGSIZE)
+            return m;
+    }
+    return NULL;
+}
@@ -0,0 +1,22 @@
+#ifndef USERPROG_SHM_H
+#define USERPROG_SHM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct process;
+struct shm;
+
+void shm_init(void);
+
+struct shm *shm_create(const char *name, size_t page_cnt);
+struct shm *shm_dup(struct shm *);
+void shm_close(struct shm *);
+
+void *shm_map(struct shm *, void *upage);
+bool shm_unmap(void *upage);
+bool shm_is_mapped(struct process *, const void *upage);
+void shm_exit(void);
+bool shm_fork(struct process *parent);
+
+#endif /* userprog/shm.h */
@@ -1,333 +1,1238 @@
 #include "userprog/syscall.h"
 
+#include <exec.h>
+#include <fcntl.h>
+#include <iovec.h>
+#include <limits.h>
+#include <poll.h>
+#include <round.h>
+#include <rusage.h>
 #include <stdio.h>
+#include <string.h>
 #include <syscall-nr.h>
 
+#include "devices/input.h"
+#include "devices/shutdown.h"
+#include "devices/timer.h"
+#include "filesys/file.h"
+#include "filesys/filesys.h"
+#include "lib/kernel/stdio.h"
 #include "threads/interrupt.h"
+#include "threads/lockstat.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
-#include "threads/synch.h"
-#include "filesys/filesys.h"
-#include "filesys/file.h"
-
-#include "lib/kernel/stdio.h"
-#include "devices/input.h"
+#include "threads/waitq.h"
+#include "userprog/futex.h"
+#include "userprog/pipe.h"
+#include "userprog/process.h"
+#include "userprog/shm.h"
+#include "userprog/uaccess.h"
+#include "userprog/uring.h"
 
 static void syscall_handler(struct intr_frame *);
-static int get_user (const uint8_t *uaddr);
-static bool put_user (uint8_t *udst, uint8_t byte);
-static void check_valid_ptr(const void *ptr); 
-static void check_valid_string(const char *str);
-static void check_valid_buffer(const void *buffer, unsigned size);
-
-static struct lock filesys_lock;
-
-/* Reads a byte at user virtual address UADDR.
-UADDR must be below PHYS_BASE.
-Returns the byte value if successful, -1 if a segfault
-occurred. */
-static int get_user (const uint8_t *uaddr){
+static void charge_bytes(int nr, int result);
+static uint8_t *get_xfer_buffer(uint8_t *small, size_t size,
+                                size_t *buf_size);
+static void put_xfer_buffer(uint8_t *buf, uint8_t *small);
+
+/* Serializes file system operations and changes to fd tables. */
+struct lock filesys_lock;
+
+/* Number of 32-bit arguments taken by each system call.  The
+   handler copies exactly this many words off the user stack, so
+   that a call whose arguments run off the end of user memory
+   kills the process no matter which call it is. */
+static const uint8_t arg_cnt[] = {
+    [SYS_HALT] = 0,         [SYS_EXIT] = 1,
+    [SYS_EXEC] = 1,         [SYS_WAIT] = 1,
+    [SYS_CREATE] = 2,       [SYS_REMOVE] = 1,
+    [SYS_OPEN] = 1,         [SYS_FILESIZE] = 1,
+    [SYS_READ] = 3,         [SYS_WRITE] = 3,
+    [SYS_SEEK] = 2,         [SYS_TELL] = 1,
+    [SYS_CLOSE] = 1,        [SYS_INCREMENT] = 1,
+    [SYS_LOCKSTAT] = 2,     [SYS_SCHED_SETATTR] = 1,
+    [SYS_SCHED_WAIT_PERIOD] = 0, [SYS_DUP] = 1,
+    [SYS_DUP2] = 2,         [SYS_PREAD] = 4,
+    [SYS_PWRITE] = 4,       [SYS_READV] = 3,
+    [SYS_WRITEV] = 3,       [SYS_URING_SETUP] = 1,
+    [SYS_URING_ENTER] = 2,  [SYS_COPY_FILE_RANGE] = 5,
+    [SYS_PIPE] = 1,         [SYS_EXEC_FLAGS] = 2,
+    [SYS_SHM_CREATE] = 2,   [SYS_SHM_MAP] = 2,
+    [SYS_SHM_UNMAP] = 1,    [SYS_FUTEX_WAIT] = 2,
+    [SYS_FUTEX_WAKE] = 2,   [SYS_THREAD_CREATE] = 3,
+    [SYS_THREAD_JOIN] = 1,  [SYS_THREAD_EXIT] = 1,
+    [SYS_FORK] = 0,         [SYS_FCNTL] = 3,
+    [SYS_POLL] = 3,         [SYS_EXEC_STATUS] = 1,
+    [SYS_SPAWN_MANY] = 4,   [SYS_WAIT_ANY] = 2,
+    [SYS_GETRUSAGE] = 2,
+};
+
+/* Most arguments any system call takes. */
+#define ARG_MAX 5
+
+void syscall_init(void) {
+    intr_register_int(0x30, 3, INTR_ON, syscall_handler, "syscall");
+    lock_init_named(&filesys_lock, "filesys");
+}
+
+/* Terminates the current process for passing a bad argument. */
+static void NO_RETURN kill_process(void) {
+    process_terminate(-1);
+}
+
+/* Copies the null-terminated string at user address USTR into
+   a newly allocated page and returns it.  The caller must free
+   the page with palloc_free_page().  Returns a null pointer if
+   the string does not fit in a page or memory is exhausted.
+   Kills the process if USTR is a bad pointer. */
+static char *copy_in_string(const char *ustr) {
+    char *kstr = palloc_get_page(0);
+    int len;
+
+    if (kstr == NULL)
+        return NULL;
+    len = strncpy_from_user(kstr, ustr, PGSIZE);
+    if (len < 0) {
+        palloc_free_page(kstr);
+        kill_process();
+    }
+    if (len == PGSIZE) {
+        palloc_free_page(kstr);
+        return NULL;
+    }
+    return kstr;
+}
+
+/* Moving data to and from user buffers.
+
+   Read and write calls check their buffers page by page with
+   user_range_ok() on the way in, so that a plainly bad buffer
+   kills the process at once.  The data itself then moves through
+   a kernel buffer by way of the fault-handling copy routines,
+   never directly, because another thread of the process may
+   unmap part of the buffer at any time. */
+
+/* Transfers of up to this many bytes, and bigger ones when no
+   page is free, go through a buffer on the stack. */
+#define XFER_SMALL 128
+
+/* Reads up to SIZE bytes from FILE into user buffer UBUFFER,
+   starting at offset POS, or at FILE's position, which advances,
+   if POS is negative.  Returns the number of bytes read, or
+   SYSCALL_BAD_BUFFER if UBUFFER turns out to be bad.  The caller
+   must hold filesys_lock. */
+int syscall_read_file(struct file *file, void *ubuffer, size_t size,
+                      off_t pos) {
+    uint8_t small[XFER_SMALL];
+    size_t buf_size;
+    uint8_t *buf = get_xfer_buffer(small, size, &buf_size);
+    uint8_t *dst = ubuffer;
+    size_t done = 0;
     int result;
-    asm ("movl $1f, %0; movzbl %1, %0; 1:"
-        : "=&a" (result) : "m" (*uaddr));
+
+    ASSERT(lock_held_by_current_thread(&filesys_lock));
+    for (;;) {
+        off_t chunk = size - done < buf_size ? size - done : buf_size;
+        off_t n = pos < 0 ? file_read(file, buf, chunk)
+                          : file_read_at(file, buf, chunk, pos + done);
+
+        if (n > 0 && !copy_to_user(dst + done, buf, n)) {
+            result = SYSCALL_BAD_BUFFER;
+            break;
+        }
+        done += n;
+        if (n < chunk || done == size) {
+            result = done;
+            break;
+        }
+    }
+    put_xfer_buffer(buf, small);
     return result;
 }
-/* Writes BYTE to user address UDST.
-UDST must be below PHYS_BASE.
-Returns true if successful, false if a segfault occurred. */
-static bool put_user (uint8_t *udst, uint8_t byte){
-    int error_code;
-    asm ("movl $1f, %0; movb %b2, %1; 1:" 
-        : "=&a" (error_code), "=m" (*udst) : "q" (byte));
-    return error_code != -1;
+
+/* Writes the SIZE bytes in user buffer UBUFFER to FILE, starting
+   at offset POS, or at FILE's position, which advances, if POS
+   is negative.  Returns the number of bytes written, which is
+   short if FILE can't grow, or SYSCALL_BAD_BUFFER if UBUFFER
+   turns out to be bad.  The caller must hold filesys_lock. */
+int syscall_write_file(struct file *file, const void *ubuffer, size_t size,
+                       off_t pos) {
+    uint8_t small[XFER_SMALL];
+    size_t buf_size;
+    uint8_t *buf = get_xfer_buffer(small, size, &buf_size);
+    const uint8_t *src = ubuffer;
+    size_t done = 0;
+    int result;
+
+    ASSERT(lock_held_by_current_thread(&filesys_lock));
+    for (;;) {
+        off_t chunk = size - done < buf_size ? size - done : buf_size;
+        off_t n;
+
+        if (!copy_from_user(buf, src + done, chunk)) {
+            result = SYSCALL_BAD_BUFFER;
+            break;
+        }
+        n = pos < 0 ? file_write(file, buf, chunk)
+                    : file_write_at(file, buf, chunk, pos + done);
+        done += n;
+        if (n < chunk || done == size) {
+            result = done;
+            break;
+        }
+    }
+    put_xfer_buffer(buf, small);
+    return result;
 }
 
-static void check_valid_ptr(const void *ptr) {
-    if (ptr == NULL || !is_user_vaddr(ptr) || pagedir_get_page(thread_current()->pagedir, ptr) == NULL) {
-        printf("%s: exit(-1)\n", thread_current()->name);
-        thread_exit();
+/* Writes the SIZE bytes in user buffer UBUFFER to the console.
+   Returns SIZE, or SYSCALL_BAD_BUFFER if UBUFFER turns out to be
+   bad.  Writes of up to a page are not interleaved with other
+   console output. */
+int syscall_write_console(const void *ubuffer, size_t size) {
+    uint8_t small[XFER_SMALL];
+    size_t buf_size;
+    uint8_t *buf = get_xfer_buffer(small, size, &buf_size);
+    const uint8_t *src = ubuffer;
+    size_t done;
+    int result = size;
+
+    for (done = 0; done < size; done += buf_size) {
+        size_t chunk = size - done < buf_size ? size - done : buf_size;
+
+        if (!copy_from_user(buf, src + done, chunk)) {
+            result = SYSCALL_BAD_BUFFER;
+            break;
+        }
+        putbuf((const char *) buf, chunk);
     }
+    put_xfer_buffer(buf, small);
+    return result;
 }
 
-static void check_valid_string(const char *str) {
-    if (str == NULL) {
-        printf("%s: exit(-1)\n", thread_current()->name);
-        thread_exit();
+/* Returns a buffer for moving SIZE bytes between the kernel and
+   user memory and stores its size in *BUF_SIZE.  That is SMALL,
+   which must have room for XFER_SMALL bytes, if SIZE fits in it
+   or no page is free, otherwise a new page.  The caller must
+   release the buffer with put_xfer_buffer(). */
+static uint8_t *get_xfer_buffer(uint8_t *small, size_t size,
+                                size_t *buf_size) {
+    uint8_t *page = size > XFER_SMALL ? palloc_get_page(0) : NULL;
+
+    *buf_size = page != NULL ? PGSIZE : XFER_SMALL;
+    return page != NULL ? page : small;
+}
+
+/* Releases BUF, obtained from get_xfer_buffer() along with
+   SMALL. */
+static void put_xfer_buffer(uint8_t *buf, uint8_t *small) {
+    if (buf != small)
+        palloc_free_page(buf);
+}
+
+/* Returns the number of timer ticks in MS milliseconds, rounded
+   up. */
+static int64_t ms_to_ticks(int ms) {
+    return DIV_ROUND_UP((int64_t) ms * TIMER_FREQ, 1000);
+}
+
+/* Returns the file open as FD in the current process, or a null
+   pointer if FD is not an open file.  The fd table may be
+   changed by a uring worker (see uring.c) as well as by the
+   process itself, so the caller must hold filesys_lock for as
+   long as it uses the returned file. */
+static struct file *lookup_fd(int fd) {
+    ASSERT(lock_held_by_current_thread(&filesys_lock));
+    return fdtable_get(&thread_current()->process->fds, fd);
+}
+
+/* Returns the pipe whose read end, or write end if WRITER is
+   true, is open as FD in the current process, or a null pointer
+   if FD is not that end of a pipe.  The caller gets its own
+   reference to the pipe end, which it must drop with
+   pipe_close(), so that it can use the pipe without holding
+   filesys_lock: reading or writing a pipe may block for as long
+   as the process at the other end likes.  Sets *NONBLOCK to
+   true if FD has O_NONBLOCK set. */
+static struct pipe *get_pipe(int fd, bool writer, bool *nonblock) {
+    const struct fd_entry *e;
+    struct pipe *pipe = NULL;
+
+    lock_acquire(&filesys_lock);
+    e = fdtable_lookup(&thread_current()->process->fds, fd);
+    if (e != NULL && e->pipe != NULL && e->writer == writer) {
+        pipe = pipe_dup(e->pipe, writer);
+        *nonblock = (e->flags & O_NONBLOCK) != 0;
     }
-    while (true) {
-        check_valid_ptr(str);
-        if (*str == '\0')
-            break;
-        str++;
+    lock_release(&filesys_lock);
+    return pipe;
+}
+
+/* Starts a process running UCMD_LINE, with EXEC_* FLAGS. */
+static tid_t sys_exec(const char *ucmd_line, int flags) {
+    char *cmd_line;
+    tid_t tid;
+
+    if ((flags & ~(EXEC_INHERIT_FDS | EXEC_ASYNC)) != 0)
+        return TID_ERROR;
+    cmd_line = copy_in_string(ucmd_line);
+    if (cmd_line == NULL)
+        return TID_ERROR;
+    tid = process_execute(cmd_line, flags);
+    palloc_free_page(cmd_line);
+    return tid;
+}
+
+/* Starts a process running each of the CNT command lines in
+   UCMD_LINES, with EXEC_* FLAGS, and stores their pids in UPIDS.
+   Starts them all before waiting for any to load, so that their
+   loads overlap.  Stores PID_ERROR for each that could not be
+   started or failed to load, having already reaped it.  Returns
+   the number that loaded, or -1 if CNT is out of range. */
+static int sys_spawn_many(const char **ucmd_lines, int cnt, int flags,
+                          tid_t *upids) {
+    const char *cmd_lines[SPAWN_MAX];
+    tid_t tids[SPAWN_MAX];
+    int i, loaded = 0;
+
+    if (cnt < 0 || cnt > SPAWN_MAX)
+        return -1;
+    if (!copy_from_user(cmd_lines, ucmd_lines, cnt * sizeof *cmd_lines))
+        kill_process();
+
+    for (i = 0; i < cnt; i++)
+        tids[i] = sys_exec(cmd_lines[i], flags | EXEC_ASYNC);
+    for (i = 0; i < cnt; i++) {
+        if (tids[i] == TID_ERROR)
+            continue;
+        if (process_load_status(tids[i]) == 1)
+            loaded++;
+        else {
+            process_wait(tids[i]);
+            tids[i] = TID_ERROR;
+        }
     }
+
+    if (!copy_to_user(upids, tids, cnt * sizeof *tids))
+        kill_process();
+    return loaded;
 }
 
-static void check_valid_buffer(const void *buffer, unsigned size) {
-    const uint8_t *buf = buffer;
-    for (unsigned i = 0; i < size; i++) {
-        check_valid_ptr(buf + i);
+/* Copies the resources used by the current process, or its
+   children, according to WHO, to *UUSAGE.  Returns false if WHO
+   is not RUSAGE_SELF or RUSAGE_CHILDREN or memory is
+   exhausted. */
+static bool sys_getrusage(int who, struct rusage *uusage) {
+    struct rusage *usage = malloc(sizeof *usage);
+    bool success;
+
+    if (usage == NULL)
+        return false;
+    success = process_get_usage(who, usage);
+    if (success && !copy_to_user(uusage, usage, sizeof *usage)) {
+        free(usage);
+        kill_process();
     }
+    free(usage);
+    return success;
 }
-void syscall_init(void) {
-    intr_register_int(0x30, 3, INTR_ON, syscall_handler, "syscall");
-    lock_init(&filesys_lock);
+
+/* Waits for whichever child exits first, giving up after
+   TIMEOUT_MS milliseconds unless TIMEOUT_MS is negative, and
+   returns its pid, storing its exit status in *USTATUS if USTATUS
+   is nonnull.  Returns 0 if the time runs out, or -1 if there are
+   no children to wait for. */
+static tid_t sys_wait_any(int *ustatus, int timeout_ms) {
+    int64_t ticks = timeout_ms < 0 ? -1 : ms_to_ticks(timeout_ms);
+    int status;
+    tid_t tid;
+
+    tid = process_wait_any(&status, ticks);
+    if (tid > 0 && ustatus != NULL &&
+        !copy_to_user(ustatus, &status, sizeof status))
+        kill_process();
+    return tid;
+}
+
+static bool sys_create(const char *ufile, unsigned initial_size) {
+    char *file = copy_in_string(ufile);
+    bool success;
+
+    if (file == NULL)
+        return false;
+    lock_acquire(&filesys_lock);
+    success = filesys_create(file, initial_size);
+    lock_release(&filesys_lock);
+    palloc_free_page(file);
+    return success;
 }
 
-static void syscall_handler(struct intr_frame *f UNUSED) {
-    check_valid_ptr(f->esp);
-    uint32_t *args = ((uint32_t *) f->esp);
-    check_valid_ptr(args);    
-    check_valid_ptr(args+1);
+static bool sys_remove(const char *ufile) {
+    char *file = copy_in_string(ufile);
+    bool success;
 
+    if (file == NULL)
+        return false;
+    lock_acquire(&filesys_lock);
+    success = filesys_remove(file);
+    lock_release(&filesys_lock);
+    palloc_free_page(file);
+    return success;
+}
 
-    /*
-     * The following print statement, if uncommented, will print out the syscall
-     * number whenever a process enters a system call. You might find it useful
-     * when debugging. It will cause tests to fail, however, so you should not
-     * include it in your final submission.
-     */
+static int sys_open(const char *ufile) {
+    char *file = copy_in_string(ufile);
+    struct file *opened;
+    int fd = -1;
 
-    /* printf("System call number: %d\n", args[0]); */
+    if (file == NULL)
+        return -1;
+    lock_acquire(&filesys_lock);
+    opened = filesys_open(file);
+    if (opened != NULL) {
+        fd = fdtable_alloc(&thread_current()->process->fds, opened);
+        if (fd < 0)
+            file_close(opened);
+    }
+    lock_release(&filesys_lock);
+    palloc_free_page(file);
+    return fd;
+}
 
-    switch (args[0]) {
-        case SYS_EXIT:
-            f->eax = args[1];
-            thread_current()->status_of_child->exit_code = args[1];
-            printf("%s: exit(%d)\n", thread_current()->name, args[1]);
-            thread_exit();
-            break;
+static int sys_filesize(int fd) {
+    struct file *file;
+    int size = -1;
 
-        case SYS_INCREMENT:
-            f->eax = ++args[1];
-            printf("%s: exit(%d)\n", thread_current()->name, args[1]);
-            thread_exit();
+    lock_acquire(&filesys_lock);
+    file = lookup_fd(fd);
+    if (file != NULL)
+        size = file_length(file);
+    lock_release(&filesys_lock);
+    return size;
+}
+
+/* Waits for a key and stores it in *KEY.  Returns true if
+   successful, false if the process is told to exit first. */
+static bool wait_key(uint8_t *key) {
+    struct poller poller;
+    struct waitq_entry input_entry, exit_entry;
+    bool got_key = false;
+
+    poller_init(&poller);
+    input_poll(&poller, &input_entry);
+    if (!process_poll_exit(&poller, &exit_entry))
+        while (!(got_key = input_trygetc(key)) &&
+               !process_poll_exit(NULL, NULL))
+            poller_wait(&poller, -1);
+    poller_done(&poller);
+    return got_key;
+}
+
+/* Reads keyboard input into the SIZE bytes at user buffer
+   BUFFER, stopping early after a new-line.  Returns the number of
+   bytes read.  If the console has O_NONBLOCK set, stops early
+   instead of waiting for a key, and returns -1 if no key was
+   waiting at all.  Also stops early if the process is told to
+   exit while waiting, returning -1 if nothing was read.  Kills
+   the process if BUFFER turns out to be bad. */
+static int read_console(uint8_t *buffer, size_t size) {
+    bool nonblock;
+    size_t i;
+
+    lock_acquire(&filesys_lock);
+    nonblock =
+        (fdtable_get_flags(&thread_current()->process->fds, 0) & O_NONBLOCK) !=
+        0;
+    lock_release(&filesys_lock);
+
+    for (i = 0; i < size;) {
+        uint8_t c;
+
+        if (!(nonblock ? input_trygetc(&c) : wait_key(&c)))
+            break;
+        if (c == '\r')
+            c = '\n';
+        if (!copy_to_user(buffer + i++, &c, 1))
+            kill_process();
+        if (c == '\n')
             break;
+    }
+    return i == 0 && size > 0 ? -1 : (int) i;
+}
 
-        case SYS_WRITE:
-            {
-                // check_valid_ptr((void *)args[1]);
-                // check_valid_ptr((void *)args[2]);
-                // check_valid_ptr((void *)args[3]);
-
-                int fd = args[1];
-                const void *buffer = (const void *)args[2];
-                unsigned size = args[3];
-
-                check_valid_ptr(buffer);
-                check_valid_buffer(buffer, size);
-                
-                struct thread *cur = thread_current();
-                
-                if (fd == 1) { 
-                    // Write to stdout
-                    putbuf((const char *)buffer, size); 
-                    f->eax = size; // return number of bytes written
-                } else if (fd < 2 || fd >= MAX_FILES || cur->files[fd] == NULL) {
-                    f->eax = -1; // Invalid file descriptor or file not open
-                } else {
-                    // Write to file
-                    lock_acquire(&filesys_lock);
-                    f->eax = file_write(cur->files[fd], buffer, size);
-                    lock_release(&filesys_lock);
-                }
+/* Writes the SIZE bytes at user buffer BUFFER to the console and
+   returns SIZE.  Kills the process if BUFFER turns out to be
+   bad. */
+static int write_console(const void *buffer, size_t size) {
+    int result = syscall_write_console(buffer, size);
+    if (result == SYSCALL_BAD_BUFFER)
+        kill_process();
+    return result;
+}
+
+static int sys_read(int fd, void *buffer, unsigned size) {
+    struct file *file;
+    struct pipe *pipe;
+    bool nonblock;
+    int bytes_read = -1;
+
+    if (!user_range_ok(buffer, size, true))
+        kill_process();
+
+    if (fd == 0)
+        return read_console(buffer, size);
+
+    lock_acquire(&filesys_lock);
+    file = lookup_fd(fd);
+    if (file != NULL)
+        bytes_read = syscall_read_file(file, buffer, size, -1);
+    lock_release(&filesys_lock);
+
+    if (file == NULL && (pipe = get_pipe(fd, false, &nonblock)) != NULL) {
+        bytes_read = pipe_read(pipe, buffer, size, nonblock);
+        pipe_close(pipe, false);
+        if (bytes_read == PIPE_BAD_BUFFER)
+            kill_process();
+    }
+    if (bytes_read == SYSCALL_BAD_BUFFER)
+        kill_process();
+    return bytes_read;
+}
+
+static int sys_write(int fd, const void *buffer, unsigned size) {
+    struct file *file;
+    struct pipe *pipe;
+    bool nonblock;
+    int bytes_written = -1;
+
+    if (!user_range_ok(buffer, size, false))
+        kill_process();
+
+    if (fd == 1)
+        return write_console(buffer, size);
+
+    lock_acquire(&filesys_lock);
+    file = lookup_fd(fd);
+    if (file != NULL)
+        bytes_written = syscall_write_file(file, buffer, size, -1);
+    lock_release(&filesys_lock);
+
+    if (file == NULL && (pipe = get_pipe(fd, true, &nonblock)) != NULL) {
+        bytes_written = pipe_write(pipe, buffer, size, nonblock);
+        pipe_close(pipe, true);
+        if (bytes_written == PIPE_BAD_BUFFER)
+            kill_process();
+    }
+    if (bytes_written == SYSCALL_BAD_BUFFER)
+        kill_process();
+    return bytes_written;
+}
+
+/* Positional reads and writes don't use or move the file
+   position, so unlike a seek followed by a read or write they
+   need the file system lock only once. */
+static int sys_pread(int fd, void *buffer, unsigned size, unsigned position) {
+    struct file *file;
+    int bytes_read = -1;
+
+    if (!user_range_ok(buffer, size, true))
+        kill_process();
+    if ((int) position < 0)
+        return -1;
+
+    lock_acquire(&filesys_lock);
+    file = lookup_fd(fd);
+    if (file != NULL)
+        bytes_read = syscall_read_file(file, buffer, size, position);
+    lock_release(&filesys_lock);
+    if (bytes_read == SYSCALL_BAD_BUFFER)
+        kill_process();
+    return bytes_read;
+}
+
+static int sys_pwrite(int fd, const void *buffer, unsigned size,
+                      unsigned position) {
+    struct file *file;
+    int bytes_written = -1;
+
+    if (!user_range_ok(buffer, size, false))
+        kill_process();
+    if ((int) position < 0)
+        return -1;
+
+    lock_acquire(&filesys_lock);
+    file = lookup_fd(fd);
+    if (file != NULL)
+        bytes_written = syscall_write_file(file, buffer, size, position);
+    lock_release(&filesys_lock);
+    if (bytes_written == SYSCALL_BAD_BUFFER)
+        kill_process();
+    return bytes_written;
+}
+
+/* Copies the IOV_CNT buffer descriptors at user address UIOV
+   into IOV and checks that every buffer is mapped, and writable
+   if WRITABLE is true.  Returns the total size of the buffers,
+   or -1 if IOV_CNT is out of range or the total doesn't fit in
+   an int.  Kills the process if any pointer is bad. */
+static int copy_in_iovecs(struct iovec iov[IOV_MAX],
+                          const struct iovec *uiov, int iov_cnt,
+                          bool writable) {
+    size_t total = 0;
+    int i;
+
+    if (iov_cnt < 0 || iov_cnt > IOV_MAX)
+        return -1;
+    if (!copy_from_user(iov, uiov, iov_cnt * sizeof *iov))
+        kill_process();
+
+    for (i = 0; i < iov_cnt; i++) {
+        if (!user_range_ok(iov[i].iov_base, iov[i].iov_len, writable))
+            kill_process();
+        total += iov[i].iov_len;
+        if (total > INT_MAX)
+            return -1;
+    }
+    return total;
+}
+
+static int sys_readv(int fd, const struct iovec *uiov, int iov_cnt) {
+    struct iovec iov[IOV_MAX];
+    struct file *file;
+    int bytes_read = 0;
+    int i;
+
+    if (copy_in_iovecs(iov, uiov, iov_cnt, true) < 0)
+        return -1;
+
+    if (fd == 0) {
+        for (i = 0; i < iov_cnt; i++) {
+            int n = read_console(iov[i].iov_base, iov[i].iov_len);
+            if (n < 0)
+                return bytes_read > 0 ? bytes_read : -1;
+            bytes_read += n;
+            if ((size_t) n < iov[i].iov_len)
+                break;
+        }
+        return bytes_read;
+    }
+
+    lock_acquire(&filesys_lock);
+    file = lookup_fd(fd);
+    if (file == NULL)
+        bytes_read = -1;
+    else
+        for (i = 0; i < iov_cnt; i++) {
+            int n = syscall_read_file(file, iov[i].iov_base,
+                                      iov[i].iov_len, -1);
+            if (n == SYSCALL_BAD_BUFFER) {
+                bytes_read = n;
+                break;
             }
-            break;
+            bytes_read += n;
+            if ((size_t) n < iov[i].iov_len)
+                break;
+        }
+    lock_release(&filesys_lock);
+    if (bytes_read == SYSCALL_BAD_BUFFER)
+        kill_process();
+    return bytes_read;
+}
 
-        case SYS_READ:
-            {
-                // check_valid_ptr((void *)args[1]);
-                // check_valid_ptr((void *)args[2]);
-                // check_valid_ptr((void *)args[3]);
-
-                int fd = args[1];
-                check_valid_ptr(args + 2); // Ensure args[2] is valid
-                void *buffer = (void *)args[2];
-                check_valid_ptr(args + 3); // Ensure args[3] is valid
-                unsigned size = args[3];
-                struct thread *cur = thread_current();
-
-                check_valid_ptr(buffer);
-                check_valid_buffer(buffer, size);
-                
-                if (fd < 0 || fd >= MAX_FILES) {
-                    f->eax = -1; // Invalid file descriptor
-                } else if (fd == 0) {
-                    // Reading from stdin
-                    unsigned i;
-                    uint8_t *buf = (uint8_t *)buffer;
-                    for (i = 0; i < size; i++) {
-                        char c = input_getc();
-                        if (c == '\r') c = '\n';  // Convert carriage return to newline
-                        buf[i] = c;
-                        if (c == '\n') {
-                            i++;
-                            break;
-                        }
-                    }
-                    f->eax = i;
-                } else if (fd == 1) {
-                    // Can't read from stdout
-                    f->eax = -1;
-                } else if (cur->files[fd] == NULL) {
-                    f->eax = -1; // File not open
-                } else {
-                    lock_acquire(&filesys_lock);
-                    f->eax = file_read(cur->files[fd], buffer, size);
-                    lock_release(&filesys_lock);
-                }
+static int sys_writev(int fd, const struct iovec *uiov, int iov_cnt) {
+    struct iovec iov[IOV_MAX];
+    struct file *file;
+    int bytes_written = 0;
+    int i;
+
+    if (copy_in_iovecs(iov, uiov, iov_cnt, false) < 0)
+        return -1;
+
+    if (fd == 1) {
+        for (i = 0; i < iov_cnt; i++)
+            bytes_written += write_console(iov[i].iov_base, iov[i].iov_len);
+        return bytes_written;
+    }
+
+    lock_acquire(&filesys_lock);
+    file = lookup_fd(fd);
+    if (file == NULL)
+        bytes_written = -1;
+    else
+        for (i = 0; i < iov_cnt; i++) {
+            int n = syscall_write_file(file, iov[i].iov_base,
+                                       iov[i].iov_len, -1);
+            if (n == SYSCALL_BAD_BUFFER) {
+                bytes_written = n;
+                break;
             }
-            break;
+            bytes_written += n;
+            if ((size_t) n < iov[i].iov_len)
+                break;
+        }
+    lock_release(&filesys_lock);
+    if (bytes_written == SYSCALL_BAD_BUFFER)
+        kill_process();
+    return bytes_written;
+}
 
-        case SYS_CREATE:
-            {
-                // check_valid_ptr((void *)args[1]);
-                // check_valid_ptr((void *)args[2]);
+/* Copies up to SIZE bytes from IN_FD, starting at IN_POS, to
+   OUT_FD, starting at OUT_POS, without passing them through user
+   memory.  A position of -1 means the file's current position,
+   which is then advanced past the bytes copied.  Returns the
+   number of bytes copied, which is less than SIZE if the input
+   ends or the output can't grow, and 0 only at the end of the
+   input.  Returns -1 if an fd or position is bad, or if there is
+   input to copy but none of it can be written.
+
+   The data moves a page at a time through a kernel buffer.  The
+   file system lock is released between pages so that a big copy
+   doesn't hold up everyone else; the files are duplicated so
+   that they stay open meanwhile even if the fds are closed. */
+static int sys_copy_file_range(int in_fd, int in_pos, int out_fd,
+                               int out_pos, unsigned size) {
+    bool in_cur = in_pos == -1, out_cur = out_pos == -1;
+    struct file *in, *out;
+    uint8_t *buffer;
+    unsigned copied = 0;
+    bool stuck = false;
+
+    if (in_pos < -1 || out_pos < -1)
+        return -1;
+    buffer = palloc_get_page(0);
+    if (buffer == NULL)
+        return -1;
+
+    lock_acquire(&filesys_lock);
+    in = lookup_fd(in_fd);
+    out = lookup_fd(out_fd);
+    if (in == NULL || out == NULL) {
+        lock_release(&filesys_lock);
+        palloc_free_page(buffer);
+        return -1;
+    }
+    in = file_dup(in);
+    out = file_dup(out);
+    if (in_cur)
+        in_pos = file_tell(in);
+    if (out_cur)
+        out_pos = file_tell(out);
 
-                const char *file = (const char *)args[1];
-                off_t initial_size = (off_t)args[2];
-                
-                check_valid_string(file);
+    while (copied < size && copied < INT_MAX) {
+        off_t chunk = size - copied < PGSIZE ? size - copied : PGSIZE;
+        off_t n = file_read_at(in, buffer, chunk, in_pos + copied);
 
-                lock_acquire(&filesys_lock);
-                bool success = filesys_create(file, initial_size);
-                lock_release(&filesys_lock);
-                
-                f->eax = success;
-            } 
+        if (n > 0) {
+            n = file_write_at(out, buffer, n, out_pos + copied);
+            stuck = n == 0;
+        }
+        if (n > 0)
+            copied += n;
+        if (n < chunk)
             break;
 
-        case SYS_REMOVE:
-            {
-                // check_valid_ptr((void *)args[1]);
+        lock_release(&filesys_lock);
+        lock_acquire(&filesys_lock);
+    }
 
-                const char *file = (const char *)args[1];
+    if (in_cur)
+        file_seek(in, in_pos + copied);
+    if (out_cur)
+        file_seek(out, out_pos + copied);
+    file_close(in);
+    file_close(out);
+    lock_release(&filesys_lock);
+    palloc_free_page(buffer);
+    return copied == 0 && stuck ? -1 : (int) copied;
+}
 
-                check_valid_ptr(file);
-                check_valid_string(file);
+static void sys_seek(int fd, unsigned position) {
+    struct file *file;
 
-                lock_acquire(&filesys_lock);
-                bool success = filesys_remove(file);
-                lock_release(&filesys_lock);          
-                f->eax = success;
-            }
+    lock_acquire(&filesys_lock);
+    file = lookup_fd(fd);
+    if (file != NULL)
+        file_seek(file, position);
+    lock_release(&filesys_lock);
+}
+
+static int sys_tell(int fd) {
+    struct file *file;
+    int position = -1;
+
+    lock_acquire(&filesys_lock);
+    file = lookup_fd(fd);
+    if (file != NULL)
+        position = file_tell(file);
+    lock_release(&filesys_lock);
+    return position;
+}
+
+static void sys_close(int fd) {
+    lock_acquire(&filesys_lock);
+    fdtable_close(&thread_current()->process->fds, fd);
+    lock_release(&filesys_lock);
+}
+
+/* Duplicates FD onto the lowest free fd.  Both fds then refer to
+   the same open file, sharing its position, or to the same pipe
+   end. */
+static int sys_dup(int fd) {
+    int new_fd;
+
+    lock_acquire(&filesys_lock);
+    new_fd = fdtable_dup(&thread_current()->process->fds, fd);
+    lock_release(&filesys_lock);
+    return new_fd;
+}
+
+/* Duplicates OLD_FD onto NEW_FD, first closing whatever NEW_FD
+   referred to.  Only file descriptors may be duplicated or
+   replaced, not the console. */
+static int sys_dup2(int old_fd, int new_fd) {
+    lock_acquire(&filesys_lock);
+    new_fd = fdtable_dup2(&thread_current()->process->fds, old_fd, new_fd);
+    lock_release(&filesys_lock);
+    return new_fd;
+}
+
+/* Creates a pipe and stores fds for its read end and its write
+   end into UFDS[0] and UFDS[1], respectively.  Returns true if
+   successful, false if memory is exhausted or the fd table is
+   full. */
+static bool sys_pipe(int *ufds) {
+    struct fdtable *fds = &thread_current()->process->fds;
+    struct pipe *pipe = pipe_create();
+    int kfds[2];
+
+    if (pipe == NULL)
+        return false;
+
+    lock_acquire(&filesys_lock);
+    kfds[0] = fdtable_alloc_pipe(fds, pipe, false);
+    kfds[1] = kfds[0] >= 0 ? fdtable_alloc_pipe(fds, pipe, true) : -1;
+    if (kfds[1] < 0) {
+        if (kfds[0] >= 0)
+            fdtable_close(fds, kfds[0]);
+        else
+            pipe_close(pipe, false);
+        pipe_close(pipe, true);
+    }
+    lock_release(&filesys_lock);
+
+    if (kfds[1] < 0)
+        return false;
+    if (!copy_to_user(ufds, kfds, sizeof kfds))
+        kill_process();
+    return true;
+}
+
+/* Creates a shared memory segment of PAGE_CNT pages named by the
+   string at UNAME, or an anonymous one if UNAME is null, or
+   opens the existing segment named UNAME, and returns an fd for
+   it.  Returns -1 on failure. */
+static int sys_shm_create(const char *uname, unsigned page_cnt) {
+    char *name = NULL;
+    struct shm *shm;
+    int fd = -1;
+
+    if (uname != NULL && (name = copy_in_string(uname)) == NULL)
+        return -1;
+    shm = shm_create(name, page_cnt);
+    palloc_free_page(name);
+    if (shm == NULL)
+        return -1;
+
+    lock_acquire(&filesys_lock);
+    fd = fdtable_alloc_shm(&thread_current()->process->fds, shm);
+    if (fd < 0)
+        shm_close(shm);
+    lock_release(&filesys_lock);
+    return fd;
+}
+
+/* Maps the shared memory segment open as FD at UPAGE, or where
+   the kernel likes if UPAGE is null, and returns the address of
+   the mapping, or a null pointer on failure. */
+static void *sys_shm_map(int fd, void *upage) {
+    const struct fd_entry *e;
+    void *mapping = NULL;
+
+    lock_acquire(&filesys_lock);
+    e = fdtable_lookup(&thread_current()->process->fds, fd);
+    if (e != NULL && e->shm != NULL)
+        mapping = shm_map(e->shm, upage);
+    lock_release(&filesys_lock);
+    return mapping;
+}
+
+/* Sleeps on the futex at UADDR if it holds EXPECTED.  Returns 0
+   after being woken, -1 if the futex held something else. */
+static int sys_futex_wait(int *uaddr, int expected) {
+    if (!user_range_ok(uaddr, sizeof *uaddr, false))
+        kill_process();
+    return futex_wait(uaddr, expected);
+}
+
+/* Wakes up to N threads sleeping on the futex at UADDR.  Returns
+   the number woken. */
+static int sys_futex_wake(int *uaddr, int n) {
+    if (!user_range_ok(uaddr, sizeof *uaddr, false))
+        kill_process();
+    return futex_wake(uaddr, n);
+}
+
+/* Gets FD's O_* flags, if CMD is F_GETFL, or sets them to ARG,
+   if CMD is F_SETFL.  Returns the flags or 0, respectively, or
+   -1 if FD is not open or CMD or ARG is invalid. */
+static int sys_fcntl(int fd, int cmd, int arg) {
+    struct fdtable *fds = &thread_current()->process->fds;
+    int result = -1;
+
+    lock_acquire(&filesys_lock);
+    if (cmd == F_GETFL)
+        result = fdtable_get_flags(fds, fd);
+    else if (cmd == F_SETFL && (arg & ~O_NONBLOCK) == 0 &&
+             fdtable_set_flags(fds, fd, arg))
+        result = 0;
+    lock_release(&filesys_lock);
+    return result;
+}
+
+/* An fd being polled by sys_poll(). */
+struct poll_slot {
+    struct waitq_entry entry; /* Place in the fd's wait queue. */
+    struct pipe *pipe; /* Our reference to a pipe end, or null. */
+    bool writer; /* For a pipe, true for the write end. */
+};
+
+/* Returns the POLL* events ready on FD in the current process.
+   If POLLER is non-null, this is the first check of FD, so adds
+   POLLER to the wait queue of whatever FD refers to, using SLOT,
+   and takes a reference to it if it is a pipe, so that it stays
+   put until sys_poll() is done with it. */
+static unsigned poll_fd(int fd, struct poller *poller,
+                        struct poll_slot *slot) {
+    const struct fd_entry *e;
+    unsigned events = 0;
+
+    if (fd == 0)
+        return input_poll(poller, &slot->entry) ? POLLIN : 0;
+    if (fd == 1)
+        return POLLOUT;
+
+    if (poller != NULL) {
+        lock_acquire(&filesys_lock);
+        e = fdtable_lookup(&thread_current()->process->fds, fd);
+        if (e == NULL)
+            events = POLLNVAL;
+        else if (e->file != NULL)
+            events = POLLIN | POLLOUT;
+        else if (e->pipe != NULL) {
+            slot->pipe = pipe_dup(e->pipe, e->writer);
+            slot->writer = e->writer;
+        } else
+            events = POLLERR;
+        lock_release(&filesys_lock);
+    }
+    if (slot->pipe != NULL)
+        events = pipe_poll(slot->pipe, slot->writer, poller, &slot->entry);
+    return events;
+}
+
+/* Waits until at least one of the NFDS fds in UFDS has one of
+   the events it asks for ready, or until TIMEOUT_MS milliseconds
+   pass, or forever if TIMEOUT_MS is negative.  Sets each
+   entry's REVENTS and returns the number of entries with nonzero
+   REVENTS, which is 0 on a timeout, or -1 if NFDS is more than
+   POLL_MAX, memory is exhausted, or the process is told to exit
+   while waiting.
+
+   Instead of checking every fd over and over, sleeps on the
+   wait queues of the input buffer and of the pipes involved,
+   which wake us whenever one of them changes, and on the
+   process's exit waiters. */
+static int sys_poll(struct pollfd *ufds, unsigned nfds, int timeout_ms) {
+    struct pollfd *fds;
+    struct poll_slot *slots;
+    struct poller poller;
+    struct waitq_entry exit_entry;
+    int64_t deadline;
+    bool first;
+    int ready;
+    unsigned i;
+
+    if (nfds > POLL_MAX)
+        return -1;
+    fds = malloc(nfds * sizeof *fds);
+    slots = calloc(nfds, sizeof *slots);
+    if (nfds > 0 && (fds == NULL || slots == NULL)) {
+        free(fds);
+        free(slots);
+        return -1;
+    }
+    if (!copy_from_user(fds, ufds, nfds * sizeof *fds)) {
+        free(fds);
+        free(slots);
+        kill_process();
+    }
+
+    deadline = timer_ticks() + ms_to_ticks(timeout_ms);
+    poller_init(&poller);
+    for (first = true;; first = false) {
+        int64_t ticks = -1;
+
+        if (process_poll_exit(first ? &poller : NULL, &exit_entry)) {
+            ready = -1;
             break;
-    
+        }
+        ready = 0;
+        for (i = 0; i < nfds; i++) {
+            fds[i].revents = 0;
+            if (fds[i].fd < 0)
+                continue;
+            fds[i].revents = poll_fd(fds[i].fd, first ? &poller : NULL,
+                                     &slots[i]) &
+                             (fds[i].events | POLLERR | POLLHUP | POLLNVAL);
+            if (fds[i].revents != 0)
+                ready++;
+        }
+        if (ready > 0 || timeout_ms == 0)
+            break;
+        if (timeout_ms > 0) {
+            ticks = deadline - timer_ticks();
+            if (ticks <= 0)
+                break;
+        }
+        poller_wait(&poller, ticks);
+    }
+    poller_done(&poller);
+
+    for (i = 0; i < nfds; i++)
+        if (slots[i].pipe != NULL)
+            pipe_close(slots[i].pipe, slots[i].writer);
+    free(slots);
+    if (!copy_to_user(ufds, fds, nfds * sizeof *fds)) {
+        free(fds);
+        kill_process();
+    }
+    free(fds);
+    return ready;
+}
+
+static int sys_lockstat(struct lockstat *ustats, int max_cnt) {
+    struct lockstat *kstats;
+    size_t cnt;
+
+    if (max_cnt <= 0)
+        return 0;
+    if (max_cnt > LOCKSTAT_CLASS_MAX)
+        max_cnt = LOCKSTAT_CLASS_MAX;
+
+    /* Snapshot into kernel memory first, because lockstat_get()
+       runs with interrupts off. */
+    kstats = malloc(max_cnt * sizeof *kstats);
+    if (kstats == NULL)
+        return -1;
+    cnt = lockstat_get(kstats, max_cnt);
+    if (!copy_to_user(ustats, kstats, cnt * sizeof *kstats)) {
+        free(kstats);
+        kill_process();
+    }
+    free(kstats);
+    return cnt;
+}
+
+static int sys_sched_setattr(const struct sched_attr *uattr) {
+    struct sched_attr attr;
+
+    if (!copy_from_user(&attr, uattr, sizeof attr))
+        kill_process();
+    return thread_set_sched(&attr);
+}
+
+static void syscall_handler(struct intr_frame *f) {
+    uint32_t args[ARG_MAX];
+    uint32_t *usp = f->esp;
+    int nr;
+
+    /* Copy in the system call number, then its arguments. */
+    if (!copy_from_user(&nr, usp, sizeof nr))
+        kill_process();
+    if (nr < 0 || (size_t) nr >= sizeof arg_cnt / sizeof *arg_cnt) {
+        f->eax = -1;
+        return;
+    }
+    if (!copy_from_user(args, usp + 1, arg_cnt[nr] * sizeof *args))
+        kill_process();
+
+    /*
+     * The following print statement, if uncommented, will print out the syscall
+     * number whenever a process enters a system call. You might find it useful
+     * when debugging. It will cause tests to fail, however, so you should not
+     * include it in your final submission.
+     */
+
+    /* printf("System call number: %d\n", nr); */
 
+    if (nr < RUSAGE_SYSCALL_CNT)
+        CHARGE_USAGE(syscalls[nr], 1);
+
+    switch (nr) {
+        case SYS_HALT:
+            shutdown_power_off();
+            break;
+        case SYS_EXIT:
+            process_terminate(args[0]);
+            break;
+        case SYS_EXEC:
+            f->eax = sys_exec((const char *) args[0], 0);
+            break;
+        case SYS_WAIT:
+            f->eax = process_wait(args[0]);
+            break;
+        case SYS_CREATE:
+            f->eax = sys_create((const char *) args[0], args[1]);
+            break;
+        case SYS_REMOVE:
+            f->eax = sys_remove((const char *) args[0]);
+            break;
         case SYS_OPEN:
-            {           
-                // check_valid_ptr(args);
-
-                const char *file = (const char *)args[1];
-                
-                check_valid_ptr(file);
-                check_valid_string(file);
-
-                lock_acquire(&filesys_lock);
-                struct file *opened_file = filesys_open(file);
-                lock_release(&filesys_lock);       
-                
-                if (opened_file == NULL) {
-                    f->eax = -1;
-                } else {
-                    struct thread* current_thread = thread_current();
-                    int fd = current_thread->next_fd++;
-                    if (fd >= MAX_FILES) {
-                        file_close(opened_file); // Close the file if fd limit is reached
-                        f->eax = -1; // Return error
-                    } else {
-                        // Store ptr to the opened file in the thread's file descriptor table
-                        current_thread->files[fd] = opened_file; 
-                        f->eax = fd; // Return the file descriptor
-                    }
-                } 
-            }
+            f->eax = sys_open((const char *) args[0]);
             break;
-
         case SYS_FILESIZE:
-            {
-                int fd = args[1];
-                struct thread *cur = thread_current();
-                
-                if (fd < 2 || fd >= MAX_FILES || cur->files[fd] == NULL) {
-                    f->eax = -1; // Invalid file descriptor
-                } else {
-                    lock_acquire(&filesys_lock);
-                    f->eax = file_length(cur->files[fd]);
-                    lock_release(&filesys_lock);
-                }
-            }
+            f->eax = sys_filesize(args[0]);
+            break;
+        case SYS_READ:
+            f->eax = sys_read(args[0], (void *) args[1], args[2]);
+            break;
+        case SYS_WRITE:
+            f->eax = sys_write(args[0], (const void *) args[1], args[2]);
             break;
-
         case SYS_SEEK:
-            lock_acquire(&filesys_lock);
-            file_seek(thread_current()->files[args[1]], args[2]);
-            lock_release(&filesys_lock);
+            sys_seek(args[0], args[1]);
             break;
-
         case SYS_TELL:
-            lock_acquire(&filesys_lock);
-            off_t pos = file_tell(thread_current()->files[args[1]]);
-            lock_release(&filesys_lock);
-            f->eax = pos;
+            f->eax = sys_tell(args[0]);
             break;
-
         case SYS_CLOSE:
-            {
-                // check for fd number args[1]
-                int fd = args[1];
-                struct thread *cur = thread_current();
-                if (fd < 2 || fd >= MAX_FILES || cur->files[fd] == NULL) {
-                    break;
-                }
-                lock_acquire(&filesys_lock);
-                file_close(cur->files[args[1]]);
-                cur->files[args[1]] = NULL;
-                lock_release(&filesys_lock);
-            }
+            sys_close(args[0]);
             break;
-
-        case SYS_EXEC:
-            // check_valid_ptr((void *)args[1]);
-            check_valid_buffer(&args[1], sizeof(uint32_t)); // cmd_line pointer
-            const char *cmd_line = (const char *)args[1];
-            check_valid_string(cmd_line);
-            f->eax = process_execute(args[1]);
+        case SYS_INCREMENT:
+            f->eax = args[0] + 1;
+            printf("%s: exit(%d)\n", thread_current()->name, args[0] + 1);
+            thread_exit();
             break;
-
-        case SYS_WAIT:
-            f->eax = process_wait(args[1]);
+        case SYS_LOCKSTAT:
+            f->eax = sys_lockstat((struct lockstat *) args[0], args[1]);
             break;
-            
-        case SYS_HALT:
-            shutdown_power_off();
+        case SYS_SCHED_SETATTR:
+            f->eax = sys_sched_setattr((const struct sched_attr *) args[0]);
+            break;
+        case SYS_SCHED_WAIT_PERIOD:
+            if (thread_current()->policy != SCHED_NORMAL)
+                thread_wait_period();
+            break;
+        case SYS_DUP:
+            f->eax = sys_dup(args[0]);
+            break;
+        case SYS_DUP2:
+            f->eax = sys_dup2(args[0], args[1]);
+            break;
+        case SYS_PREAD:
+            f->eax = sys_pread(args[0], (void *) args[1], args[2], args[3]);
+            break;
+        case SYS_PWRITE:
+            f->eax =
+                sys_pwrite(args[0], (const void *) args[1], args[2], args[3]);
+            break;
+        case SYS_READV:
+            f->eax = sys_readv(args[0], (const struct iovec *) args[1], args[2]);
+            break;
+        case SYS_WRITEV:
+            f->eax =
+                sys_writev(args[0], (const struct iovec *) args[1], args[2]);
+            break;
+        case SYS_COPY_FILE_RANGE:
+            f->eax = sys_copy_file_range(args[0], args[1], args[2], args[3],
+                                         args[4]);
+            break;
+        case SYS_PIPE:
+            f->eax = sys_pipe((int *) args[0]);
+            break;
+        case SYS_EXEC_FLAGS:
+            f->eax = sys_exec((const char *) args[0], args[1]);
+            break;
+        case SYS_SHM_CREATE:
+            f->eax = sys_shm_create((const char *) args[0], args[1]);
+            break;
+        case SYS_SHM_MAP:
+            f->eax = (uint32_t) sys_shm_map(args[0], (void *) args[1]);
+            break;
+        case SYS_SHM_UNMAP:
+            f->eax = shm_unmap((void *) args[0]);
+            break;
+        case SYS_FUTEX_WAIT:
+            f->eax = sys_futex_wait((int *) args[0], args[1]);
+            break;
+        case SYS_FUTEX_WAKE:
+            f->eax = sys_futex_wake((int *) args[0], args[1]);
+            break;
+        case SYS_THREAD_CREATE:
+            f->eax = process_thread_create((void *) args[0], (void *) args[1],
+                                           (void *) args[2]);
+            break;
+        case SYS_THREAD_JOIN:
+            f->eax = process_thread_join(args[0]);
+            break;
+        case SYS_THREAD_EXIT:
+            process_thread_exit(args[0]);
+            break;
+        case SYS_FORK:
+            f->eax = process_fork(f);
+            break;
+        case SYS_FCNTL:
+            f->eax = sys_fcntl(args[0], args[1], args[2]);
+            break;
+        case SYS_POLL:
+            f->eax = sys_poll((struct pollfd *) args[0], args[1], args[2]);
+            break;
+        case SYS_EXEC_STATUS:
+            f->eax = process_load_status(args[0]);
+            break;
+        case SYS_WAIT_ANY:
+            f->eax = sys_wait_any((int *) args[0], args[1]);
+            break;
+        case SYS_GETRUSAGE:
+            f->eax = sys_getrusage(args[0], (struct rusage *) args[1]);
+            break;
+        case SYS_SPAWN_MANY:
+            f->eax = sys_spawn_many((const char **) args[0], args[1], args[2],
+                                    (tid_t *) args[3]);
+            break;
+        case SYS_URING_SETUP:
+            f->eax = (uint32_t) uring_setup(args[0]);
+            break;
+        case SYS_URING_ENTER:
+            f->eax = uring_enter(args[0], args[1]);
             break;
-
         default:
-            // Handle unknown system calls
+            f->eax = -1;
             break;
     }
-
+    charge_bytes(nr, f->eax);
 }
 
-
-    // if (args[0] == SYS_EXIT) {
-    //     f->eax = args[1];
-    //     printf("%s: exit(%d)\n", thread_current()->name, args[1]);
-    //     thread_exit();
-    // // Part 3
-    // } else if (args[0] == SYS_INCREMENT) {
-    //     int i = args[1];
-    //     f->eax = i + 1;
-    // // Part 4
-    // } else if (args[0] == SYS_WRITE) {
-    //     int fd = args[1];
-    //     const void *buf = (const void *) args[2];
-    //     unsigned size = args[3];
-
-    //     if (fd == 1) {    
-    //         putbuf (buf, size);             
-    //         f->eax = size;                  
-    //     } else {
-    //         f->eax = -1;                    
-    //     }
-    // }
\ No newline at end of file
+/* Counts the bytes that system call NR, which returned RESULT,
+   read or wrote, if it is one of the read or write calls. */
+static void charge_bytes(int nr, int result) {
+    if (result <= 0)
+        return;
+    if (nr == SYS_READ || nr == SYS_PREAD || nr == SYS_READV)
+        CHARGE_USAGE(bytes_read, result);
+    else if (nr == SYS_WRITE || nr == SYS_PWRITE || nr == SYS_WRITEV)
+        CHARGE_USAGE(bytes_written, result);
+}
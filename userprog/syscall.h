@@ -1,6 +1,23 @@
 #ifndef USERPROG_SYSCALL_H
 #define USERPROG_SYSCALL_H
 
+#include <stddef.h>
+
+#include "filesys/off_t.h"
+#include "threads/synch.h"
+
+struct file;
+
+extern struct lock filesys_lock;
+
+/* Returned by the functions below if a user buffer turns out to
+   be bad partway through a transfer. */
+#define SYSCALL_BAD_BUFFER (-2)
+
 void syscall_init(void);
+int syscall_read_file(struct file *, void *ubuffer, size_t size, off_t pos);
+int syscall_write_file(struct file *, const void *ubuffer, size_t size,
+                       off_t pos);
+int syscall_write_console(const void *ubuffer, size_t size);
 
 #endif /* userprog/syscall.h */
@@ -3,6 +3,7 @@
 #include <debug.h>
 #include <stddef.h>
 
+#include "threads/cpu.h"
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
@@ -76,6 +77,11 @@ struct tss {
 /* Kernel TSS. */
 static struct tss *tss;
 
+/* Fast system call entry point, in sysenter.S. */
+void sysenter_entry(void);
+
+static void sysenter_init(void);
+
 /* Initializes the kernel TSS. */
 void tss_init(void) {
     /* Our TSS is never used in a call gate or task gate, so only a
@@ -85,6 +91,34 @@ void tss_init(void) {
     tss->ss0 = SEL_KDSEG;
     tss->bitmap = 0xdfff;
     tss_update();
+    sysenter_init();
+}
+
+/* Sets up SYSENTER, if the CPU supports it, as a faster way for
+   user programs to make system calls than "int $0x30".
+
+   SYSENTER loads the kernel stack pointer from an MSR, but the
+   stack to use changes on every thread switch.  Rather than
+   rewrite the MSR on each switch, we point it at the TSS's esp0
+   member, which tss_update() already keeps current, and
+   sysenter_entry loads the real stack pointer from there.
+
+   SYSENTER and SYSEXIT derive the kernel stack segment and the
+   user segments from the kernel code selector, which only works
+   because the GDT puts SEL_KDSEG, SEL_UCSEG, and SEL_UDSEG at
+   fixed offsets from SEL_KCSEG.  See [IA32-v2b] "SYSENTER" and
+   "SYSEXIT". */
+static void sysenter_init(void) {
+    ASSERT(SEL_KDSEG == SEL_KCSEG + 8);
+    ASSERT(SEL_UCSEG == ((SEL_KCSEG + 16) | 3));
+    ASSERT(SEL_UDSEG == ((SEL_KCSEG + 24) | 3));
+
+    if (!cpu_has_sysenter())
+        return;
+
+    wrmsr(MSR_SYSENTER_CS, SEL_KCSEG);
+    wrmsr(MSR_SYSENTER_ESP, (uint32_t) &tss->esp0);
+    wrmsr(MSR_SYSENTER_EIP, (uint32_t) sysenter_entry);
 }
 
 /* Returns the kernel TSS. */
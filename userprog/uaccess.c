@@ -0,0 +1,116 @@
+#include "userprog/uaccess.h"
+
+#include <debug.h>
+#include <stdint.h>
+
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+
+/* Accessing user memory.
+
+   The copy routines don't check that user pages are mapped
+   before touching them.  They just check that the addresses are
+   below PHYS_BASE and then do the copy, in usercopy.S.  If a user
+   page turns out to be bad, the access page faults, and
+   page_fault() calls uaccess_fixup(), which makes the routine
+   return an error.  The cost of a good copy is thus the cost of
+   the copy itself, with no page table walks at all.
+
+   user_range_ok() checks a whole buffer, such as one passed to
+   read or write, with one page table walk per page, so that a
+   call given a plainly bad buffer fails before it does anything.
+   It is only a check: another thread of the process may unmap
+   the range right afterward, so the data itself must still move
+   with the copy routines. */
+
+/* In usercopy.S. */
+extern char uaccess_begin[], uaccess_end[], uaccess_fault[];
+int user_copy(void *dst, const void *src, size_t size);
+int user_strncpy(char *dst, const char *src, size_t size);
+
+/* Returns true if the SIZE bytes starting at UADDR lie entirely
+   in user address space, false otherwise. */
+static bool is_user_range(const void *uaddr, size_t size) {
+    uintptr_t start = (uintptr_t) uaddr;
+    uintptr_t end = start + size;
+
+    return end >= start && end <= (uintptr_t) PHYS_BASE;
+}
+
+/* Copies SIZE bytes from user address USRC to kernel address
+   DST.  Returns true if successful, false if any part of USRC
+   is not mapped user memory, in which case DST may have been
+   partly written. */
+bool copy_from_user(void *dst, const void *usrc, size_t size) {
+    return is_user_range(usrc, size) && user_copy(dst, usrc, size) == 0;
+}
+
+/* Copies SIZE bytes from kernel address SRC to user address
+   UDST.  Returns true if successful, false if any part of UDST
+   is not mapped, writable user memory, in which case UDST may
+   have been partly written. */
+bool copy_to_user(void *udst, const void *src, size_t size) {
+    return is_user_range(udst, size) && user_copy(udst, src, size) == 0;
+}
+
+/* Copies the null-terminated string at user address USRC to
+   kernel buffer DST, which has room for SIZE bytes.  Returns
+   the length of the string, not counting the null terminator.
+   Returns SIZE if the string, with its null terminator, does not
+   fit in SIZE bytes; then DST is not null-terminated.  Returns
+   -1 if any part of the string is not mapped user memory. */
+int strncpy_from_user(char *dst, const char *usrc, size_t size) {
+    size_t max_len = size;
+    int len;
+
+    if (!is_user_vaddr(usrc))
+        return -1;
+    if (max_len > (size_t) ((uint8_t *) PHYS_BASE - (uint8_t *) usrc))
+        max_len = (uint8_t *) PHYS_BASE - (uint8_t *) usrc;
+
+    len = user_strncpy(dst, usrc, max_len);
+    if (len < 0 || ((size_t) len == max_len && max_len < size))
+        return -1;
+    return len;
+}
+
+/* Returns true if the SIZE bytes starting at UADDR are mapped in
+   the current process's user address space, and writable if
+   WRITE is true, false otherwise.  Checks each page once.  If
+   WRITE is true, pages shared copy-on-write are copied first. */
+bool user_range_ok(const void *uaddr, size_t size, bool write) {
+    uint32_t *pd = thread_current()->pagedir;
+    const uint8_t *page;
+
+    if (!is_user_range(uaddr, size))
+        return false;
+    if (size == 0)
+        return true;
+
+    for (page = pg_round_down(uaddr); page < (const uint8_t *) uaddr + size;
+         page += PGSIZE) {
+        if (pagedir_get_page(pd, page) == NULL)
+            return false;
+        if (write && !pagedir_is_writable(pd, page) &&
+            !pagedir_copy_on_write(pd, page))
+            return false;
+    }
+    return true;
+}
+
+/* Called by the page fault handler for a fault in kernel mode
+   at FAULT_ADDR.  If the fault came from a user access in one
+   of the copy routines, arranges for the routine to return an
+   error and returns true.  Otherwise, returns false. */
+bool uaccess_fixup(struct intr_frame *f, const void *fault_addr) {
+    uint8_t *eip = (uint8_t *) f->eip;
+
+    if (eip < (uint8_t *) uaccess_begin || eip >= (uint8_t *) uaccess_end ||
+        !is_user_vaddr(fault_addr))
+        return false;
+
+    f->eip = (void (*)(void)) uaccess_fault;
+    return true;
+}
@@ -0,0 +1,315 @@
+#include "userprog/uring.h"
+
+#include <debug.h>
+#include <stdio.h>
+#include <uring.h>
+
+#include "filesys/file.h"
+#include "filesys/filesys.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/process.h"
+#include "userprog/syscall.h"
+#include "userprog/uaccess.h"
+
+/* Number of times the polling thread finds the submission queue
+   empty, yielding the CPU in between, before it goes to sleep. */
+#define POLL_IDLE_MAX 64
+
+/* A process's ring, with the kernel's bookkeeping for it. */
+struct uring_ctx {
+    struct uring *ring; /* Shared page, at its kernel address. */
+    struct uring *uring; /* Shared page, at its user address. */
+    struct process *owner; /* Process the ring belongs to. */
+
+    /* Completion waits.  Only used with a polling thread. */
+    struct lock lock;
+    struct condition completed; /* Signaled after each batch. */
+
+    /* Polling thread, if any. */
+    bool polling; /* Is there a polling thread? */
+    bool stop; /* Set to tell the poller to exit. */
+    struct semaphore wake; /* Upped to wake a sleeping poller. */
+    struct semaphore done; /* Upped by the poller as it exits. */
+};
+
+static unsigned drain(struct uring_ctx *, unsigned max);
+static int execute(struct process *owner, const struct uring_sqe *);
+static thread_func poller;
+
+/* Memory barrier for the compiler.  x86 doesn't reorder stores
+   with other stores or loads with other loads, so that is all
+   the shared ring needs. */
+#define barrier() asm volatile("" : : : "memory")
+
+/* Sets up a ring for the current process, with a polling thread
+   if FLAGS includes URING_SETUP_POLL.  Returns the ring's user
+   address, or a null pointer if the process already has a ring
+   or resources are exhausted. */
+struct uring *uring_setup(unsigned flags) {
+    struct thread *cur = thread_current();
+    struct process *p = cur->process;
+    struct uring_ctx *ctx;
+
+    ctx = calloc(1, sizeof *ctx);
+    if (ctx == NULL)
+        return NULL;
+    ctx->ring = palloc_get_page(PAL_USER | PAL_ZERO);
+    if (ctx->ring == NULL) {
+        free(ctx);
+        return NULL;
+    }
+    lock_init(&ctx->lock);
+    cond_init(&ctx->completed);
+    sema_init(&ctx->wake, 0);
+    sema_init(&ctx->done, 0);
+    ctx->owner = p;
+
+    lock_acquire(&p->lock);
+    if (p->uring == NULL)
+        ctx->uring = process_map_page(ctx->ring, true);
+    if (ctx->uring == NULL) {
+        lock_release(&p->lock);
+        palloc_free_page(ctx->ring);
+        free(ctx);
+        return NULL;
+    }
+    /* From here on the page belongs to the page directory. */
+    p->uring = ctx;
+    lock_release(&p->lock);
+
+    if (flags & URING_SETUP_POLL) {
+        char name[16];
+
+        snprintf(name, sizeof name, "uring%d", cur->tid);
+        ctx->polling =
+            thread_create(name, PRI_DEFAULT, poller, ctx) != TID_ERROR;
+        if (ctx->polling)
+            ctx->ring->setup_flags = URING_SETUP_POLL;
+    }
+    return ctx->uring;
+}
+
+/* Carries out up to TO_SUBMIT entries from the current process's
+   submission queue, or, if the process has a polling thread,
+   wakes the thread up if it is asleep.  Then waits until at least
+   MIN_COMPLETE completions are waiting to be reaped.  Returns
+   the number of entries carried out, or -1 if the process has no
+   ring. */
+int uring_enter(unsigned to_submit, unsigned min_complete) {
+    struct uring_ctx *ctx = thread_current()->process->uring;
+    struct uring *ring;
+    unsigned done = 0;
+
+    if (ctx == NULL)
+        return -1;
+    ring = ctx->ring;
+    if (min_complete > URING_CQ_ENTRIES)
+        min_complete = URING_CQ_ENTRIES;
+
+    if (!ctx->polling) {
+        done = drain(ctx, to_submit);
+        /* Every entry completes before drain() returns, so there
+           is nothing to wait for. */
+        return done;
+    }
+
+    if (ring->flags & URING_NEED_WAKEUP)
+        sema_up(&ctx->wake);
+    /* Stop waiting early if the submission queue is empty, since
+       then every entry has completed and no more completions can
+       come. */
+    if (min_complete > 0) {
+        lock_acquire(&ctx->lock);
+        while (ring->cq_tail - ring->cq_head < min_complete &&
+               ring->sq_head != ring->sq_tail)
+            cond_wait(&ctx->completed, &ctx->lock);
+        lock_release(&ctx->lock);
+    }
+    return 0;
+}
+
+/* Tears down the current process's ring, if it has one.  The
+   shared page itself is freed along with the page directory.
+   Must be called before the process's fd table and page
+   directory are destroyed, because the polling thread uses
+   both. */
+void uring_exit(void) {
+    struct process *p = thread_current()->process;
+    struct uring_ctx *ctx = p->uring;
+
+    if (ctx == NULL)
+        return;
+    if (ctx->polling) {
+        ctx->stop = true;
+        sema_up(&ctx->wake);
+        sema_down(&ctx->done);
+    }
+    p->uring = NULL;
+    free(ctx);
+}
+
+/* Carries out up to MAX entries from CTX's submission queue,
+   stopping early if the queue empties or the completion queue
+   fills up.  Returns the number carried out. */
+static unsigned drain(struct uring_ctx *ctx, unsigned max) {
+    struct uring *ring = ctx->ring;
+    uint32_t head = ring->sq_head;
+    unsigned done;
+
+    for (done = 0; done < max; done++) {
+        struct uring_sqe sqe;
+        struct uring_cqe *cqe;
+        uint32_t cq_tail = ring->cq_tail;
+
+        if (head == ring->sq_tail ||
+            cq_tail - ring->cq_head >= URING_CQ_ENTRIES)
+            break;
+        barrier();
+
+        /* Copy the entry, so that the process can't change it
+           while we are working on it. */
+        sqe = ring->sq[head % URING_SQ_ENTRIES];
+
+        cqe = &ring->cq[cq_tail % URING_CQ_ENTRIES];
+        cqe->user_data = sqe.user_data;
+        cqe->res = execute(ctx->owner, &sqe);
+        barrier();
+        ring->cq_tail = cq_tail + 1;
+
+        /* Retire the entry only once its completion is posted, so
+           that an empty submission queue means that every entry
+           submitted so far has completed. */
+        barrier();
+        ring->sq_head = ++head;
+    }
+    return done;
+}
+
+/* Carries out SQE on behalf of OWNER and returns its result.  A
+   bad pointer makes the operation fail with -1, rather than
+   killing the process as a system call would, because we might
+   be running in the polling thread. */
+static int execute(struct process *owner, const struct uring_sqe *sqe) {
+    struct file *file;
+    char *name;
+    int len;
+    int result = -1;
+
+    switch (sqe->opcode) {
+        case URING_OP_NOP:
+            return 0;
+
+        case URING_OP_READ:
+        case URING_OP_WRITE: {
+            bool reading = sqe->opcode == URING_OP_READ;
+
+            if (!user_range_ok(sqe->addr, sqe->len, reading) ||
+                (int) sqe->len < 0)
+                return -1;
+            if (!reading && sqe->fd == 1)
+                result = syscall_write_console(sqe->addr, sqe->len);
+            else {
+                lock_acquire(&filesys_lock);
+                file = fdtable_get(&owner->fds, sqe->fd);
+                if (file == NULL)
+                    result = -1;
+                else if (reading)
+                    result = syscall_read_file(file, sqe->addr, sqe->len,
+                                               sqe->off);
+                else
+                    result = syscall_write_file(file, sqe->addr, sqe->len,
+                                                sqe->off);
+                lock_release(&filesys_lock);
+            }
+            return result != SYSCALL_BAD_BUFFER ? result : -1;
+        }
+
+        case URING_OP_OPEN:
+            name = palloc_get_page(0);
+            if (name == NULL)
+                return -1;
+            len = strncpy_from_user(name, sqe->addr, PGSIZE);
+            if (len >= 0 && len < PGSIZE) {
+                lock_acquire(&filesys_lock);
+                file = filesys_open(name);
+                if (file != NULL) {
+                    result = fdtable_alloc(&owner->fds, file);
+                    if (result < 0)
+                        file_close(file);
+                }
+                lock_release(&filesys_lock);
+            }
+            palloc_free_page(name);
+            return result;
+
+        case URING_OP_CLOSE:
+            lock_acquire(&filesys_lock);
+            if (fdtable_close(&owner->fds, sqe->fd))
+                result = 0;
+            lock_release(&filesys_lock);
+            return result;
+
+        case URING_OP_SEEK:
+            lock_acquire(&filesys_lock);
+            file = fdtable_get(&owner->fds, sqe->fd);
+            if (file != NULL && sqe->off >= 0) {
+                file_seek(file, sqe->off);
+                result = 0;
+            }
+            lock_release(&filesys_lock);
+            return result;
+
+        default:
+            return -1;
+    }
+}
+
+/* Polling thread for the ring in CTX_.  Runs in the owning
+   process's address space, by borrowing its page directory, so
+   that it can reach the process's buffers with the user copy
+   routines.  Those fail, instead of faulting, if one of the
+   process's threads unmaps a buffer while we are using it. */
+static void poller(void *ctx_) {
+    struct uring_ctx *ctx = ctx_;
+    struct uring *ring = ctx->ring;
+    struct thread *cur = thread_current();
+    int idle = 0;
+
+    cur->pagedir = ctx->owner->pagedir;
+    process_activate();
+
+    while (!ctx->stop) {
+        if (drain(ctx, URING_SQ_ENTRIES) > 0) {
+            idle = 0;
+            lock_acquire(&ctx->lock);
+            cond_broadcast(&ctx->completed, &ctx->lock);
+            lock_release(&ctx->lock);
+        } else if (++idle < POLL_IDLE_MAX)
+            thread_yield();
+        else {
+            /* Announce that we are going to sleep, then check
+               once more for work, so that a submission racing
+               with us either is seen here or sees the flag. */
+            ring->flags |= URING_NEED_WAKEUP;
+            barrier();
+            if (ring->sq_head == ring->sq_tail && !ctx->stop) {
+                lock_acquire(&ctx->lock);
+                cond_broadcast(&ctx->completed, &ctx->lock);
+                lock_release(&ctx->lock);
+                sema_down(&ctx->wake);
+            }
+            ring->flags &= ~URING_NEED_WAKEUP;
+            idle = 0;
+        }
+    }
+
+    /* Give back the borrowed page directory before exiting, so
+       that process_exit() doesn't destroy it. */
+    cur->pagedir = NULL;
+    sema_up(&ctx->done);
+    thread_exit();
+}
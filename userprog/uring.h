@@ -0,0 +1,10 @@
+#ifndef USERPROG_URING_H
+#define USERPROG_URING_H
+
+#include <stdint.h>
+
+struct uring *uring_setup(unsigned flags);
+int uring_enter(unsigned to_submit, unsigned min_complete);
+void uring_exit(void);
+
+#endif /* userprog/uring.h */